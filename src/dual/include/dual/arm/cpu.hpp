@@ -4,6 +4,7 @@
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
 #include <dual/arm/coprocessor.hpp>
+#include <dual/common/state.hpp>
 
 namespace dual::arm {
 
@@ -15,6 +16,12 @@ namespace dual::arm {
         ARM11
       };
 
+      enum class Backend {
+        Interpreter,
+        CachedInterpreter,
+        JIT
+      };
+
       enum class GPR {
         R0 = 0,
         R1 = 1,
@@ -69,6 +76,9 @@ namespace dual::arm {
 
       virtual void Reset() = 0;
 
+      virtual void SaveState(StateWriter& state) const = 0;
+      virtual void LoadState(StateReader& state) = 0;
+
       virtual u32  GetExceptionBase() const = 0;
       virtual void SetExceptionBase(u32 address) = 0;
 
@@ -76,6 +86,12 @@ namespace dual::arm {
 
       virtual void SetUnalignedDataAccessEnable(bool enable) = 0;
 
+      virtual void SetIdleLoopDetectionEnable(bool enable) = 0;
+      virtual u64  GetIdleLoopSkippedCycles() const = 0;
+
+      // Returns the number of instructions executed since the last reset (excluding halted and idle loop cycles).
+      virtual u64  GetExecutedInstructionCount() const = 0;
+
       virtual bool GetWaitingForIRQ() const = 0;
       virtual void SetWaitingForIRQ(bool value) = 0;
 
@@ -93,6 +109,10 @@ namespace dual::arm {
       virtual void SetSPSR(Mode mode, PSR value) = 0;
 
       virtual void Run(int cycles) = 0;
+
+      // Like Run(), but stops at a fixed system timestamp instead of the next scheduler event.
+      // This allows running the CPU on a thread other than the one which owns the scheduler.
+      virtual void RunUntil(int cycles, u64 timestamp_target) = 0;
   };
 
 } // namespace dual::arm
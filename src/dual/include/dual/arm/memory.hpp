@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <array>
 #include <atom/integer.hpp>
+#include <dual/arm/page_table.hpp>
 
 namespace dual::arm {
 
@@ -13,6 +15,9 @@ namespace dual::arm {
         System
       };
 
+      // Granularity at which cached guest code is tracked and invalidated.
+      static constexpr int k_code_page_shift = PageTable::k_code_page_shift;
+
       virtual ~Memory() = default;
 
       virtual u8  ReadByte(u32 vaddr, Bus bus) = 0;
@@ -22,6 +27,28 @@ namespace dual::arm {
       virtual void WriteByte(u32 vaddr, u8  value, Bus bus) = 0;
       virtual void WriteHalf(u32 vaddr, u16 value, Bus bus) = 0;
       virtual void WriteWord(u32 vaddr, u32 value, Bus bus) = 0;
+
+      // Returns a counter which changes whenever the code page containing the address is written or remapped,
+      // or nullptr if code from that page must not be cached.
+      virtual const u32* GetCodePageVersion([[maybe_unused]] u32 vaddr) {
+        return nullptr;
+      }
+
+      // Returns whether reading from the address may return a different value or cause side effects,
+      // even when neither a CPU nor a scheduler event has written to it in the meantime (e.g. free-running timers).
+      // Polling loops reading from such addresses are never skipped by the idle loop detection.
+      virtual bool IsVolatile([[maybe_unused]] u32 vaddr) {
+        return true;
+      }
+
+      // Returns the table of host memory pages which the CPU cores may access directly (without calling the
+      // virtual functions above) for a bus, or nullptr if the implementation does not provide one.
+      const PageTable* GetPageTable(Bus bus) const {
+        return m_page_tables[(int)bus];
+      }
+
+    protected:
+      std::array<const PageTable*, 3> m_page_tables{};
   };
 
 } // namespace dual::arm
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atom/integer.hpp>
+#include <atom/punning.hpp>
+#include <atomic>
+
+namespace dual::arm {
+
+  /**
+   * Software TLB which maps 4 KiB pages in the lower 256 MiB of the address space directly to host memory.
+   * Pages without an entry (MMIO, memory with access side effects or partially mapped pages)
+   * must be handled by the slow path of the memory bus.
+   */
+  class PageTable {
+    public:
+      static constexpr int k_page_shift = 12;
+      static constexpr u32 k_page_size = 1u << k_page_shift;
+      static constexpr u32 k_page_mask = k_page_size - 1u;
+      static constexpr u32 k_address_limit = 0x10000000u;
+      static constexpr size_t k_page_count = k_address_limit >> k_page_shift;
+
+      // Granularity of the code page write counters (see Memory::GetCodePageVersion())
+      static constexpr int k_code_page_shift = 8;
+
+      // The counters of shared memory are updated by both CPUs concurrently while the ARM7 runs on its own thread.
+      static void IncrementCodePageVersion(u32& version) {
+        std::atomic_ref<u32>{version}.fetch_add(1u, std::memory_order_relaxed);
+      }
+
+      static u32 LoadCodePageVersion(const u32* version) {
+        return std::atomic_ref<u32>{*const_cast<u32*>(version)}.load(std::memory_order_relaxed);
+      }
+
+      struct WritePage {
+        u8* data{};
+
+        // Code page write counters covering the page (if code may be executed from it)
+        u32* code_pages{};
+      };
+
+      const u8* GetReadPage(u32 address) const {
+        const u32 page = address >> k_page_shift;
+
+        if(page < k_page_count) {
+          return m_read[page];
+        }
+        return nullptr;
+      }
+
+      const WritePage* GetWritePage(u32 address) const {
+        const u32 page = address >> k_page_shift;
+
+        if(page < k_page_count && m_write[page].data != nullptr) {
+          return &m_write[page];
+        }
+        return nullptr;
+      }
+
+      void SetReadPage(u32 address, const u8* data) {
+        m_read[address >> k_page_shift] = data;
+      }
+
+      void SetWritePage(u32 address, const WritePage& page) {
+        m_write[address >> k_page_shift] = page;
+      }
+
+      // Reads from an aligned address, returns false if the page must be accessed through the slow path.
+      template<typename T>
+      bool TryRead(u32 address, T& value) const {
+        if(const u8* page = GetReadPage(address); page) [[likely]] {
+          value = atom::read<T>(page, address & k_page_mask);
+          return true;
+        }
+        return false;
+      }
+
+      // Writes to an aligned address, returns false if the page must be accessed through the slow path.
+      template<typename T>
+      bool TryWrite(u32 address, T value) const {
+        if(const WritePage* page = GetWritePage(address); page) [[likely]] {
+          const u32 offset = address & k_page_mask;
+
+          atom::write<T>(page->data, offset, value);
+
+          if(page->code_pages) {
+            IncrementCodePageVersion(page->code_pages[offset >> k_code_page_shift]);
+          }
+          return true;
+        }
+        return false;
+      }
+
+    private:
+      std::array<const u8*, k_page_count> m_read{};
+      std::array<WritePage, k_page_count> m_write{};
+  };
+
+} // namespace dual::arm
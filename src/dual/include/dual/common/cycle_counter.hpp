@@ -2,6 +2,8 @@
 #pragma once
 
 #include <atom/integer.hpp>
+#include <dual/common/state.hpp>
+#include <limits>
 
 namespace dual {
 
@@ -19,11 +21,37 @@ namespace dual {
         return m_timestamp_sys;
       }
 
+      u64 GetDeviceTimestampNow() const {
+        return m_timestamp_dev;
+      }
+
+      // Returns the number of device cycles left until the system timestamp reaches the given timestamp.
+      u64 GetDeviceCyclesUntil(u64 timestamp) const {
+        if(timestamp <= m_timestamp_sys) {
+          return 0u;
+        }
+
+        if(timestamp > (std::numeric_limits<u64>::max() >> m_device_clock_rate_shift)) {
+          return std::numeric_limits<u64>::max();
+        }
+
+        return (timestamp << m_device_clock_rate_shift) - m_timestamp_dev;
+      }
+
       void AddDeviceCycles(uint cycles) {
         m_timestamp_dev += cycles;
         m_timestamp_sys = m_timestamp_dev >> m_device_clock_rate_shift;
       }
 
+      void SaveState(StateWriter& state) const {
+        state.Write(m_timestamp_dev);
+      }
+
+      void LoadState(StateReader& state) {
+        state.Read(m_timestamp_dev);
+        m_timestamp_sys = m_timestamp_dev >> m_device_clock_rate_shift;
+      }
+
     private:
       u64 m_timestamp_dev{};
       u64 m_timestamp_sys{};
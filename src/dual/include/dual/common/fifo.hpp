@@ -2,6 +2,7 @@
 #pragma once
 
 #include <atom/integer.hpp>
+#include <dual/common/state.hpp>
 
 namespace dual {
 
@@ -57,6 +58,20 @@ namespace dual {
         m_count++;
       }
 
+      void SaveState(StateWriter& state) const {
+        state.Write(m_rd_ptr);
+        state.Write(m_wr_ptr);
+        state.Write(m_count);
+        state.Write(m_data);
+      }
+
+      void LoadState(StateReader& state) {
+        state.Read(m_rd_ptr);
+        state.Read(m_wr_ptr);
+        state.Read(m_count);
+        state.Read(m_data);
+      }
+
     private:
       size_t m_rd_ptr{};
       size_t m_wr_ptr{};
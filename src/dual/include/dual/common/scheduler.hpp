@@ -2,24 +2,39 @@
 #pragma once
 
 #include <atom/integer.hpp>
-#include <functional>
+#include <dual/common/state.hpp>
+#include <deque>
 #include <limits>
+#include <type_traits>
+#include <vector>
 
 namespace dual {
 
+  /**
+   * Event queue implemented as a 4-ary min-heap of (timestamp, event) nodes.
+   * The heap grows on demand, but capacity for k_initial_capacity events is reserved upfront,
+   * so that scheduling does not allocate in the common case.
+   */
   class Scheduler {
     public:
       Scheduler();
 
-      template<class T>
-      using EventMethod = void (T::*)(int);
+      /**
+       * Identifies an event type which has been registered with the scheduler.
+       * Event types bind a callback and its context once (usually at construction),
+       * so that scheduling an event never needs to allocate or copy a callable.
+       */
+      using EventClass = int;
+
+      using EventCallback = void (*)(void* context, int arg, int cycles_late);
 
       struct Event {
-        std::function<void(int)> callback;
+        EventClass event_class{};
+        int arg{};
       private:
         friend class Scheduler;
         int handle{};
-        u64 timestamp{};
+        Event* next_free{};
       };
 
       u64 GetTimestampNow() const {
@@ -27,53 +42,98 @@ namespace dual {
       }
 
       u64 GetTimestampTarget() const {
-        return m_heap[0]->timestamp;
+        return m_heap[0].timestamp;
       }
 
       int GetRemainingCycleCount() const {
         return int(GetTimestampTarget() - GetTimestampNow());
       }
 
+      // Returns the number of events fired since the last reset.
+      u64 GetEventCount() const {
+        return m_event_count;
+      }
+
       void AddCycles(int cycles) {
         m_timestamp_now += cycles;
         Step();
       }
 
       void Reset();
-      auto Add(u64 delay, std::function<void(int)> callback) -> Event*;
-      void Cancel(Event* event) { Remove(event->handle); }
-
-      template<class T>
-      auto Add(std::uint64_t delay, T* object, EventMethod<T> method) -> Event* {
-        return Add(delay, [object, method](int cycles_late) {
-          (object->*method)(cycles_late);
-        });
+      auto Register(EventCallback callback, void* context) -> EventClass;
+      auto Add(u64 delay, EventClass event_class, int arg = 0) -> Event*;
+      void Cancel(Event* event);
+
+      /**
+       * Moves a pending event to a new point in time. Called from within the event's own callback, this queues the
+       * event again, which makes it the cheapest way to schedule periodic events: the event is sifted from its
+       * position in the heap and no event has to be released or allocated.
+       */
+      void Reschedule(Event* event, u64 delay);
+
+      // Returns the first pending event of the given class and argument, or nullptr if there is none.
+      auto FindEvent(EventClass event_class, int arg = 0) -> Event*;
+
+      /**
+       * Events are saved by their event class, which relies on all event classes being
+       * registered in the same order, i.e. on the emulated system being constructed identically.
+       */
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
+
+      /**
+       * Registers a member function as an event type. The method takes either no arguments,
+       * the number of cycles the event fired late by, or the event argument followed by that number.
+       */
+      template<auto method, class T>
+      auto Register(T* object) -> EventClass {
+        return Register([](void* context, int arg, int cycles_late) {
+          if constexpr(std::is_invocable_v<decltype(method), T*, int, int>) {
+            (((T*)context)->*method)(arg, cycles_late);
+          } else if constexpr(std::is_invocable_v<decltype(method), T*, int>) {
+            (((T*)context)->*method)(cycles_late);
+          } else {
+            (((T*)context)->*method)();
+          }
+        }, object);
       }
 
     private:
-      static constexpr int k_event_limit = 64;
+      static constexpr int k_initial_capacity = 128;
 
-      static int Parent(int n) {
-        return (n - 1) >> 1;
-      }
+      struct EventType {
+        EventCallback callback;
+        void* context;
+      };
+
+      struct Node {
+        u64 timestamp;
+        Event* event;
+      };
 
-      static int LeftChild(int n) {
-        return n * 2 + 1;
+      static int Parent(int n) {
+        return (n - 1) >> 2;
       }
 
-      static int RightChild(int n) {
-        return n * 2 + 2;
+      static int FirstChild(int n) {
+        return n * 4 + 1;
       }
 
       void Step();
       void Remove(int n);
-      void Swap(int i, int j);
-      void Heapify(int n);
+      void SiftUp(int n);
+      void SiftDown(int n);
+      auto AllocateEvent() -> Event*;
+      void FreeEvent(Event* event);
 
       u64 m_timestamp_now = 0u;
-      int m_heap_size = 0;
-      Event* m_heap[k_event_limit]{};
-      Event  m_pool[k_event_limit]{};
+      u64 m_event_count = 0u;
+      std::vector<Node> m_heap{};
+      Event* m_free_events{};
+      Event* m_fired_event{};
+      std::deque<Event> m_pool{};
+      std::vector<EventType> m_event_types{};
+      EventClass m_event_class_end_of_queue{};
   };
 
 } // namespace dual
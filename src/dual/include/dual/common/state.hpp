@@ -0,0 +1,107 @@
+
+#pragma once
+
+#include <atom/integer.hpp>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace dual {
+
+  // Appends the binary save state of a component to a byte buffer.
+  class StateWriter {
+    public:
+      // The buffer is overwritten from the start. Its previous allocation is reused, so that repeated snapshots do not allocate.
+      explicit StateWriter(std::vector<u8>& buffer) : m_buffer{buffer} {
+        m_buffer.clear();
+      }
+
+      size_t GetOffset() const {
+        return m_buffer.size();
+      }
+
+      // Reserves space for the given number of bytes in total, so that writing a large state does not repeatedly reallocate the buffer.
+      void Reserve(size_t size) {
+        m_buffer.reserve(size);
+      }
+
+      template<typename T>
+      void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+        WriteBytes(&value, sizeof(T));
+      }
+
+      void WriteBytes(const void* data, size_t size) {
+        const size_t offset = m_buffer.size();
+
+        m_buffer.resize(offset + size);
+        std::memcpy(m_buffer.data() + offset, data, size);
+      }
+
+      // Overwrites a value which has been written before (e.g. a size field in a header).
+      template<typename T>
+      void Patch(size_t offset, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+        std::memcpy(&m_buffer[offset], &value, sizeof(T));
+      }
+
+    private:
+      std::vector<u8>& m_buffer;
+  };
+
+  // Reads back a save state which has been written by StateWriter.
+  class StateReader {
+    public:
+      explicit StateReader(std::span<const u8> data) : m_data{data} {}
+
+      size_t GetRemainingSize() const {
+        return m_data.size() - m_offset;
+      }
+
+      // Returns false once a read went past the end of the data or a component has rejected the data.
+      bool Good() const {
+        return !m_failed;
+      }
+
+      // Called by components which find the data to be inconsistent. All further reads yield zeroes.
+      void Fail() {
+        m_offset = m_data.size();
+        m_failed = true;
+      }
+
+      template<typename T>
+      void Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+
+        ReadBytes(&value, sizeof(T));
+      }
+
+      template<typename T>
+      T Read() {
+        T value;
+        Read(value);
+        return value;
+      }
+
+      // Reads past the end of the data yield zeroes, so that components load a consistent (if wrong) state.
+      void ReadBytes(void* data, size_t size) {
+        if(size > GetRemainingSize()) [[unlikely]] {
+          std::memset(data, 0, size);
+          Fail();
+          return;
+        }
+
+        std::memcpy(data, &m_data[m_offset], size);
+        m_offset += size;
+      }
+
+    private:
+      std::span<const u8> m_data;
+      size_t m_offset = 0u;
+      bool m_failed = false;
+  };
+
+} // namespace dual
@@ -10,7 +10,6 @@
 #include <dual/arm/memory.hpp>
 #include <dual/common/scheduler.hpp>
 #include <dual/audio_driver.hpp>
-#include <functional>
 #include <memory>
 
 namespace dual::nds::arm7 {
@@ -20,6 +19,8 @@ namespace dual::nds::arm7 {
       APU(Scheduler& scheduler, arm::Memory& bus);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       AudioDriverBase* GetAudioDriver();
       void SetAudioDriver(std::shared_ptr<AudioDriverBase> audio_driver);
@@ -67,7 +68,7 @@ namespace dual::nds::arm7 {
       void SampleChannelPSG(int id);
       template<SampleFormat sample_format> void SampleChannelPCM(int id);
       void StartChannel(int id);
-      void ScheduleSampleChannel(int id, int cycles_lates = 0);
+      void ScheduleSampleChannel(int id);
       void CancelSampleChannel(int id);
       void RecomputeChannelSamplingInterval(int id);
 
@@ -106,7 +107,6 @@ namespace dual::nds::arm7 {
       struct Channel {
         int sampling_interval{};
         Scheduler::Event* sampling_event{};
-        std::function<void(int)> sampling_event_fn{};
         f32 current_sample{0.f};
         u32 current_address{};
         SampleFormat sample_format{};
@@ -127,6 +127,9 @@ namespace dual::nds::arm7 {
       std::array<Channel, 16> m_channels;
 
       Scheduler& m_scheduler;
+      Scheduler::EventClass m_event_class_sample_mixers;
+      Scheduler::EventClass m_event_class_sample_channel;
+      Scheduler::Event* m_mixer_event{};
       arm::Memory& m_bus;
 
       std::shared_ptr<AudioDriverBase> m_audio_driver;
@@ -20,6 +20,8 @@ namespace dual::nds::arm7 {
       DMA(arm::Memory& bus, IRQ& irq) : m_bus{bus}, m_irq{irq} {}
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
       void Request(StartTime timing);
 
       u32   Read_DMASAD(int id);
@@ -7,6 +7,7 @@
 #include <atom/panic.hpp>
 #include <atom/punning.hpp>
 #include <dual/arm/memory.hpp>
+#include <dual/arm/page_table.hpp>
 #include <dual/nds/arm7/apu.hpp>
 #include <dual/nds/arm7/dma.hpp>
 #include <dual/nds/arm7/rtc.hpp>
@@ -14,6 +15,8 @@
 #include <dual/nds/video_unit/video_unit.hpp>
 #include <dual/nds/vram/vram.hpp>
 #include <dual/nds/cartridge.hpp>
+#include <dual/nds/cpu_sync.hpp>
+#include <dual/nds/input.hpp>
 #include <dual/nds/irq.hpp>
 #include <dual/nds/ipc.hpp>
 #include <dual/nds/swram.hpp>
@@ -36,11 +39,15 @@ namespace dual::nds::arm7 {
         Cartridge& cartridge;
         RTC& rtc;
         APU& apu;
+        CPUSync& cpu_sync;
+        Input& input;
       };
 
       MemoryBus(SystemMemory& memory, const HW& hw);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       u8  ReadByte(u32 address, Bus bus) override;
       u16 ReadHalf(u32 address, Bus bus) override;
@@ -50,10 +57,17 @@ namespace dual::nds::arm7 {
       void WriteHalf(u32 address, u16 value, Bus bus) override;
       void WriteWord(u32 address, u32 value, Bus bus) override;
 
+      const u32* GetCodePageVersion(u32 address) override;
+      bool IsVolatile(u32 address) override;
+
     private:
       template<typename T> T    Read (u32 address, Bus bus);
       template<typename T> void Write(u32 address, T value, Bus bus);
 
+      void UpdatePageTable(u32 address_lo, u32 address_hi);
+      const u8* LookupReadPage(u32 address);
+      arm::PageTable::WritePage LookupWritePage(u32 address);
+
       struct IO {
         u8  ReadByte(u32 address);
         u16 ReadHalf(u32 address);
@@ -77,6 +91,8 @@ namespace dual::nds::arm7 {
       u8* m_iwram;
       SWRAM& m_swram;
       VRAM& m_vram;
+      CodePages& m_code_pages;
+      arm::PageTable m_page_table{};
   };
 
 } // namespace dual::nds::arm7
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <atom/integer.hpp>
+#include <dual/common/state.hpp>
 
 namespace dual::nds::arm7 {
 
@@ -29,6 +30,8 @@ namespace dual::nds::arm7 {
       }
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       auto  Read_RTC() -> u8;
       void Write_RTC(u8 value);
@@ -3,6 +3,8 @@
 
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
+#include <dual/common/state.hpp>
+#include <dual/nds/input.hpp>
 #include <dual/nds/irq.hpp>
 #include <memory>
 
@@ -18,11 +20,17 @@ namespace dual::nds::arm7 {
         virtual void Deselect() = 0;
 
         virtual u8 Transfer(u8 data) = 0;
+
+        // Saves the transfer state only. Persistent memory (e.g. firmware or backup memory) is left to its backing file.
+        virtual void SaveState(StateWriter& state) const = 0;
+        virtual void LoadState(StateReader& state) = 0;
       };
 
-      explicit SPI(IRQ& irq);
+      SPI(IRQ& irq, const Input& input);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       auto  Read_SPICNT() -> u16;
       void Write_SPICNT(u16 value, u16 mask);
@@ -3,6 +3,7 @@
 
 #include <atom/integer.hpp>
 #include <dual/nds/arm7/spi.hpp>
+#include <dual/nds/input.hpp>
 
 namespace dual::nds::arm7 {
 
@@ -20,12 +21,17 @@ namespace dual::nds::arm7 {
         int screen_y2;
       };
 
+      explicit TouchScreen(const Input& input) : m_input{input} {}
+
       void Reset() override;
       void Select() override;
       void Deselect() override;
 
       u8 Transfer(u8 data) override;
 
+      void SaveState(StateWriter& state) const override;
+      void LoadState(StateReader& state) override;
+
       void SetCalibrationData(const CalibrationData& data);
 
     private:
@@ -34,6 +40,8 @@ namespace dual::nds::arm7 {
         TouchScreen_X = 5
       };
 
+      const Input& m_input;
+
       u16 m_data_out{};
 
       int m_adc_x_top_left{};
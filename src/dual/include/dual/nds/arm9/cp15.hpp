@@ -3,6 +3,7 @@
 
 #include <atom/bit.hpp>
 #include <dual/arm/cpu.hpp>
+#include <dual/common/state.hpp>
 #include <dual/nds/arm9/memory.hpp>
 
 namespace dual::nds::arm9 {
@@ -13,6 +14,8 @@ namespace dual::nds::arm9 {
 
       void Reset() override;
       void DirectBoot();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
       u32  MRC(int opc1, int cn, int cm, int opc2) override;
       void MCR(int opc1, int cn, int cm, int opc2, u32 value) override;
 
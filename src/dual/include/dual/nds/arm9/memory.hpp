@@ -1,17 +1,21 @@
 
 #pragma once
 
+#include <array>
 #include <atom/logger/logger.hpp>
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
 #include <atom/panic.hpp>
 #include <atom/punning.hpp>
 #include <dual/arm/memory.hpp>
+#include <dual/arm/page_table.hpp>
 #include <dual/nds/video_unit/video_unit.hpp>
 #include <dual/nds/vram/vram.hpp>
 #include <dual/nds/arm9/math.hpp>
 #include <dual/nds/arm9/dma.hpp>
 #include <dual/nds/cartridge.hpp>
+#include <dual/nds/cpu_sync.hpp>
+#include <dual/nds/input.hpp>
 #include <dual/nds/irq.hpp>
 #include <dual/nds/ipc.hpp>
 #include <dual/nds/swram.hpp>
@@ -32,6 +36,8 @@ namespace dual::nds::arm9 {
         Math& math;
         VideoUnit& video_unit;
         Cartridge& cartridge;
+        CPUSync& cpu_sync;
+        Input& input;
       };
 
       struct TCM {
@@ -42,12 +48,16 @@ namespace dual::nds::arm9 {
           bool writable = false;
           u32 base_address = 0u;
           u32 high_address = 0u;
+
+          bool operator==(const Config& other) const = default;
         } config{};
       };
 
       MemoryBus(SystemMemory& memory, const HW& hw);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       void SetupDTCM(const TCM::Config& config);
       void SetupITCM(const TCM::Config& config);
@@ -60,10 +70,18 @@ namespace dual::nds::arm9 {
       void WriteHalf(u32 address, u16 value, Bus bus) override;
       void WriteWord(u32 address, u32 value, Bus bus) override;
 
+      const u32* GetCodePageVersion(u32 address) override;
+      bool IsVolatile(u32 address) override;
+
     private:
       template<typename T> T    Read (u32 address, Bus bus);
       template<typename T> void Write(u32 address, T value, Bus bus);
 
+      void UpdatePageTable(u32 address_lo, u32 address_hi);
+      void UpdatePageTable(const TCM::Config& config);
+      const u8* LookupReadPage(u32 address, Bus bus);
+      arm::PageTable::WritePage LookupWritePage(u32 address, Bus bus);
+
       template<typename T>
       T ReadVRAM_PPU_BG(u32 address, int ppu_id) {
         return m_vram.region_ppu_bg[ppu_id].Read<T>(address & 0x1FFFFFu);
@@ -157,6 +175,10 @@ namespace dual::nds::arm9 {
       u8* m_oam;
       SWRAM& m_swram;
       VRAM& m_vram;
+      CodePages& m_code_pages;
+
+      // One page table per bus (code, data and system), because the TCMs are only visible to some buses.
+      std::array<arm::PageTable, 3> m_page_table{};
   };
 
 } // namespace dual::nds::arm9
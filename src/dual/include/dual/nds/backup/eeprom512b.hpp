@@ -17,6 +17,9 @@ namespace dual::nds {
 
       u8 Transfer(u8 data) override;
 
+      void SaveState(StateWriter& state) const override;
+      void LoadState(StateReader& state) override;
+
     private:
       enum class Command : u8 {
         WriteEnable  = 0x06, // WREM
@@ -27,6 +27,8 @@ namespace dual::nds {
 
       void Reset();
       void DirectBoot();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       void SetROM(
         std::shared_ptr<ROM> rom,
@@ -52,6 +54,7 @@ namespace dual::nds {
       static constexpr u32 k_chip_id = 0x1FC2u;
 
       void HandleCommand();
+      void SignalDataReady();
 
       void Encrypt64(u32* key_buffer, u32* ptr);
       void Decrypt64(u32* key_buffer, u32* ptr);
@@ -101,6 +104,8 @@ namespace dual::nds {
       u32 m_key1_buffer_lvl3[0x412]{};
 
       Scheduler& m_scheduler;
+      Scheduler::EventClass m_event_class_command;
+      Scheduler::EventClass m_event_class_data_ready;
       IRQ* m_irq[2]{};
       arm9::DMA& m_dma9;
       arm7::DMA& m_dma7;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <atom/integer.hpp>
+#include <dual/arm/memory.hpp>
+
+namespace dual::nds {
+
+  // Per-page write counters for all memory that the CPUs can execute code from.
+  // CPU backends which cache decoded code compare these to detect stale code.
+  struct CodePages {
+    static constexpr int k_page_shift = arm::Memory::k_code_page_shift;
+
+    // EWRAM and SWRAM are shared by both CPUs, their counters must be incremented through this.
+    static void Increment(u32& version) {
+      arm::PageTable::IncrementCodePageVersion(version);
+    }
+
+    // Must be called whenever the memory map changes (e.g. TCM or WRAMCNT reconfiguration).
+    void Invalidate() {
+      for(u32& version : ewram) Increment(version);
+      for(u32& version : swram) Increment(version);
+      for(u32& version : itcm)  version++;
+      for(u32& version : iwram) version++;
+    }
+
+    std::array<u32, (0x400000 >> k_page_shift)> ewram{};
+    std::array<u32, (0x8000   >> k_page_shift)> swram{};
+    std::array<u32, (0x8000   >> k_page_shift)> itcm{};
+    std::array<u32, (0x10000  >> k_page_shift)> iwram{};
+
+    // Read-only memory (BIOS), never changes.
+    u32 rom{};
+  };
+
+} // namespace dual::nds
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <atom/integer.hpp>
+#include <dual/arm/cpu.hpp>
+#include <dual/common/cycle_counter.hpp>
+#include <dual/nds/enums.hpp>
+#include <thread>
+
+namespace dual::nds {
+
+  /**
+   * Runs the ARM7 on a separate host thread, in parallel with the ARM9 (experimental).
+   * Both CPUs execute the same window of time concurrently. MMIO accesses are the points at which the CPUs may interact
+   * (through IPC, interrupts, DMA and the shared scheduler): before each one a CPU waits until the other CPU has either
+   * completed the window or is itself waiting at a later point in time. This way device state is only ever accessed
+   * by one CPU at a time and in timestamp order. Accesses to memory shared by both CPUs (EWRAM and SWRAM) are not
+   * synchronized and happen in host order, so the result depends on the timing of the host threads.
+   */
+  class CPUSync {
+    public:
+      CPUSync(CycleCounter& cycle_counter_arm9, CycleCounter& cycle_counter_arm7);
+     ~CPUSync();
+
+      bool IsRunning() const {
+        return m_thread.joinable();
+      }
+
+      void Start(arm::CPU& arm7);
+      void Stop();
+
+      // Runs the ARM9 on the calling thread and the ARM7 on the worker thread for a number of system cycles.
+      // The ARM7 stops at timestamp_target at the latest, it must not read the scheduler while the ARM9 may modify it.
+      void Run(arm::CPU& arm9, int cycles, u64 timestamp_target);
+
+      // Must be called by the memory buses before accessing MMIO.
+      void Synchronize(CPU cpu) {
+        if(m_window_active) [[unlikely]] {
+          WaitForTurn(cpu);
+        }
+      }
+
+    private:
+      // Values of m_wait_timestamp other than the timestamp a CPU is waiting at.
+      static constexpr u64 k_running = ~0ull - 1u;
+      static constexpr u64 k_done = ~0ull;
+
+      void WaitForTurn(CPU cpu);
+      void ThreadMain(u64 window);
+
+      std::array<CycleCounter*, 2> m_cycle_counter;
+      arm::CPU* m_arm7{};
+
+      std::thread m_thread{};
+      std::atomic_bool m_quit{};
+      std::atomic<u64> m_window{};
+      int m_window_cycles{};
+      u64 m_window_timestamp_target{};
+      bool m_window_active{};
+      std::array<std::atomic<u64>, 2> m_wait_timestamp{};
+  };
+
+} // namespace dual::nds
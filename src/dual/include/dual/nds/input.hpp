@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <atomic>
+#include <utility>
+
+namespace dual::nds {
+
+  /**
+   * Key and touch screen state, which is fed by the frontend (typically once per host frame).
+   * The state may be updated from any thread. It is latched into atomics, so that reading the
+   * input registers is a plain load and does not call into the frontend.
+   */
+  class Input {
+    public:
+      enum Key : u16 {
+        A = 1u << 0,
+        B = 1u << 1,
+        Select = 1u << 2,
+        Start = 1u << 3,
+        Right = 1u << 4,
+        Left = 1u << 5,
+        Up = 1u << 6,
+        Down = 1u << 7,
+        R = 1u << 8,
+        L = 1u << 9,
+        X = 1u << 10,
+        Y = 1u << 11
+      };
+
+      // Sets the keys which are currently held down (bitmask of Key values).
+      void SetKeyState(u16 pressed_keys) {
+        m_pressed_keys.store(pressed_keys, std::memory_order_relaxed);
+      }
+
+      // Sets whether the touch screen is pressed and at which (screen) coordinates.
+      void SetTouchState(bool pen_down, u8 x, u8 y) {
+        m_touch_state.store((pen_down ? 0x10000u : 0u) | (u32)y << 8 | x, std::memory_order_relaxed);
+      }
+
+      bool GetPenDown() const {
+        return m_touch_state.load(std::memory_order_relaxed) & 0x10000u;
+      }
+
+      // Returns the touch screen coordinates as a pair of (x, y).
+      auto GetTouchPosition() const -> std::pair<int, int> {
+        const u32 touch_state = m_touch_state.load(std::memory_order_relaxed);
+
+        return {(int)(touch_state & 0xFFu), (int)((touch_state >> 8) & 0xFFu)};
+      }
+
+      u16 Read_KEYINPUT() const {
+        return ~m_pressed_keys.load(std::memory_order_relaxed) & 0x03FFu;
+      }
+
+      u16 Read_EXTKEYIN() const {
+        const u16 pressed_keys = m_pressed_keys.load(std::memory_order_relaxed);
+
+        u16 extkeyin = 0x007Fu;
+
+        if(pressed_keys & Key::X) extkeyin &= ~1u;
+        if(pressed_keys & Key::Y) extkeyin &= ~2u;
+        if(GetPenDown()) extkeyin &= ~64u;
+
+        return extkeyin;
+      }
+
+    private:
+      std::atomic<u16> m_pressed_keys{};
+      std::atomic<u32> m_touch_state{};
+  };
+
+} // namespace dual::nds
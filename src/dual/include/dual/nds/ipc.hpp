@@ -14,6 +14,8 @@ namespace dual::nds {
       IPC(IRQ& irq9, IRQ& irq7);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       u32   Read_SYNC(CPU cpu);
       void Write_SYNC(CPU cpu, u32 value, u32 mask);
@@ -0,0 +1,114 @@
+
+#pragma once
+
+#include <atom/integer.hpp>
+#include <atomic>
+#include <dual/nds/nds.hpp>
+#include <span>
+#include <vector>
+
+namespace dual::nds {
+
+  /**
+   * Recording of the input fed to the emulated system, which allows replaying a session bit-exactly.
+   * A movie begins with a save state and stores every change of the key and touch screen state together with the
+   * scheduler timestamp at which it has been applied. Input is only applied in between frames and frames are always
+   * emulated in one piece, so that playback reproduces the exact sequence of NDS::Step() calls of the recording.
+   * A hash of every presented frame is recorded as well, so that playback can verify that the emulation did not diverge.
+   */
+  class Movie {
+    public:
+      enum class Mode {
+        Idle,
+        Record,
+        Playback
+      };
+
+      struct Stats {
+        // Number of frames recorded or played back so far
+        int frame;
+
+        // Number of frames in the movie which is being played back
+        int frame_count;
+
+        // Number of played back frames whose hash did not match the recording
+        int hash_mismatches;
+
+        // First frame whose hash did not match the recording or -1 if all frames matched
+        int first_mismatch_frame;
+      };
+
+      explicit Movie(NDS& nds);
+     ~Movie();
+
+      // Starts recording from the current state of the system. The current input state is recorded as well.
+      void StartRecording();
+
+      /**
+       * Loads the movie's save state and starts playing it back. If verification is enabled, the hash of every presented
+       * frame is compared to the recorded hash. Returns false if the movie is invalid or has been recorded for a different ROM.
+       */
+      bool StartPlayback(std::span<const u8> data, bool verify);
+
+      void Stop();
+
+      // Serializes the recorded movie into the buffer (which is overwritten).
+      void Save(std::vector<u8>& buffer) const;
+
+      /**
+       * Emulates one frame with the recorded input or with the input latched by SetKeyState() and SetTouchState().
+       * Returns false (without emulating) once playback has reached the end of the movie.
+       */
+      bool RunFrame();
+
+      // May be called from any thread. The input is applied at the start of the next frame and ignored during playback.
+      void SetKeyState(u16 pressed_keys);
+      void SetTouchState(bool pen_down, u8 x, u8 y);
+
+      Mode GetMode() const {
+        return m_mode;
+      }
+
+      Stats GetStats() const {
+        return m_stats;
+      }
+
+    private:
+      static constexpr u32 k_movie_magic = 0x564D5344u; // "DSMV"
+      static constexpr u32 k_movie_version = 1u;
+      static constexpr int k_cycles_per_frame = 560190;
+
+      struct MovieHeader {
+        u32 magic;
+        u32 version;
+        u32 state_size;
+        u32 event_count;
+        u32 frame_count;
+      };
+
+      struct InputEvent {
+        u64 timestamp;
+        u32 touch_state;
+        u16 pressed_keys;
+        u16 padding;
+      };
+
+      void ApplyInput(const InputEvent& event);
+      u64 HashPresentedFrame();
+
+      NDS& m_nds;
+      Mode m_mode{Mode::Idle};
+      bool m_verify{};
+      Stats m_stats{};
+
+      std::vector<u8> m_state{};
+      std::vector<InputEvent> m_events{};
+      std::vector<u64> m_frame_hashes{};
+      size_t m_next_event{};
+
+      InputEvent m_current_input{};
+      std::atomic<u16> m_pending_keys{};
+      std::atomic<u32> m_pending_touch_state{};
+  };
+
+} // namespace dual::nds
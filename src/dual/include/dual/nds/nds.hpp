@@ -15,19 +15,50 @@
 #include <dual/nds/video_unit/video_unit.hpp>
 #include <dual/nds/arm9/dma.hpp>
 #include <dual/nds/cartridge.hpp>
+#include <dual/nds/cpu_sync.hpp>
+#include <dual/nds/input.hpp>
 #include <dual/nds/ipc.hpp>
 #include <dual/nds/irq.hpp>
 #include <dual/nds/rom.hpp>
+#include <dual/nds/snapshot.hpp>
 #include <dual/nds/system_memory.hpp>
 #include <dual/nds/timer.hpp>
 #include <memory>
 #include <span>
+#include <vector>
 
 namespace dual::nds {
 
   class NDS {
     public:
-      NDS();
+      struct Stats {
+        // Instructions executed by each CPU since the last reset
+        u64 arm9_instructions;
+        u64 arm7_instructions;
+
+        // CPU cycles which were skipped because the CPU was spinning in an idle loop
+        u64 arm9_idle_loop_cycles;
+        u64 arm7_idle_loop_cycles;
+
+        // Maximum number of system cycles either CPU may run ahead of the other while both are running
+        int cpu_sync_quantum;
+
+        // Number of times the two CPUs have been synchronized since the last reset
+        u64 cpu_sync_count;
+
+        // Number of scheduler events fired since the last reset
+        u64 scheduler_events;
+
+        // Render worker handoffs and waits of both PPUs since the last reset (see PPU::Stats)
+        u64 ppu_scanlines_submitted;
+        u64 ppu_worker_wakeups;
+        u64 ppu_wait_count;
+        u64 ppu_wait_time_ns;
+      };
+
+      static constexpr int k_default_cpu_sync_quantum = 32;
+
+      explicit NDS(arm::CPU::Backend cpu_backend = arm::CPU::Backend::Interpreter);
 
       void Reset();
       void Step(int cycles_to_run);
@@ -36,6 +67,50 @@ namespace dual::nds {
       void LoadROM(std::shared_ptr<ROM> rom);
       void DirectBoot();
 
+      /**
+       * Serializes the complete emulated system into the buffer (which is overwritten). The buffer's capacity is reused,
+       * so that taking snapshots repeatedly does not allocate. Must not be called while Step() is running.
+       * ROM, BIOS and firmware, backup memory and the input state are not part of the save state.
+       */
+      void SaveState(std::vector<u8>& buffer);
+
+      /**
+       * Returns false if the save state has an incompatible version, has been created for a different ROM
+       * or is truncated or corrupt. In the latter case the emulated system is left in an unspecified state.
+       */
+      bool LoadState(std::span<const u8> data);
+
+      /**
+       * Takes or restores an in-memory snapshot, which is much cheaper than a save state,
+       * because only memory pages that have been written since are copied. Must not be called while Step() is running.
+       */
+      void SaveSnapshot(Snapshot& snapshot);
+      void LoadSnapshot(Snapshot& snapshot);
+
+      // May be called from any thread, e.g. once per host frame.
+      void SetKeyState(u16 pressed_keys);
+      void SetTouchState(bool pen_down, u8 x, u8 y);
+
+      void SetCPUSyncQuantum(int cycles);
+
+      /**
+       * Runs the ARM7 on its own host thread (experimental). The CPUs access shared memory (EWRAM and SWRAM) in whatever
+       * order the host threads happen to run, so emulation is not deterministic in this mode. Returns false and leaves
+       * the mode disabled while a Movie, Rewind or RunAhead is attached, since those rely on deterministic emulation.
+       */
+      bool SetARM7ThreadEnable(bool enable);
+
+      // Called by Movie, Rewind and RunAhead for as long as they are attached (see SetARM7ThreadEnable()).
+      void AcquireDeterminism();
+      void ReleaseDeterminism();
+
+      Stats GetStats() const;
+
+      // Returns the number of system cycles emulated since the last reset.
+      u64 GetTimestampNow() const {
+        return m_scheduler.GetTimestampNow();
+      }
+
       VideoUnit& GetVideoUnit() {
         return m_video_unit;
       }
@@ -45,6 +120,28 @@ namespace dual::nds {
       }
 
     private:
+      static constexpr u32 k_save_state_magic = 0x54535344u; // "DSST"
+      static constexpr u32 k_save_state_version = 3u;
+
+      struct SaveStateHeader {
+        u32 magic;
+        u32 version;
+        u32 game_code;
+        u32 payload_size;
+      };
+
+      u32 GetGameCode() const;
+
+      void SaveSystemState(StateWriter& state, bool snapshot);
+      void LoadSystemState(StateReader& state, bool snapshot);
+
+      template<arm::CPU::Model model, typename MemoryBus>
+      auto CreateCPU(
+        arm::CPU::Backend backend,
+        MemoryBus& memory,
+        CycleCounter& cycle_counter
+      ) -> std::unique_ptr<arm::CPU>;
+
       Scheduler m_scheduler{};
 
       SystemMemory m_memory{};
@@ -53,6 +150,8 @@ namespace dual::nds {
 
       Cartridge m_cartridge{m_scheduler, m_arm9.irq, m_arm7.irq, m_arm9.dma, m_arm7.dma, m_memory};
 
+      Input m_input{};
+
       struct ARM9 {
         CycleCounter cycle_counter{1};
         std::unique_ptr<arm::CPU> cpu{};
@@ -63,7 +162,7 @@ namespace dual::nds {
         arm9::DMA dma{bus, irq};
         arm9::Math math{};
 
-        ARM9(Scheduler& scheduler, SystemMemory& memory, IPC& ipc, VideoUnit& video_unit, Cartridge& cartridge)
+        ARM9(Scheduler& scheduler, SystemMemory& memory, IPC& ipc, VideoUnit& video_unit, Cartridge& cartridge, CPUSync& cpu_sync, Input& input)
             : bus{memory, {
                 irq,
                 timer,
@@ -73,10 +172,12 @@ namespace dual::nds {
                 memory.vram,
                 math,
                 video_unit,
-                cartridge
+                cartridge,
+                cpu_sync,
+                input
               }}
             , timer{scheduler, cycle_counter, irq} {}
-      } m_arm9{m_scheduler, m_memory, m_ipc, m_video_unit, m_cartridge};
+      } m_arm9{m_scheduler, m_memory, m_ipc, m_video_unit, m_cartridge, m_cpu_sync, m_input};
 
       struct ARM7 {
         CycleCounter cycle_counter{0};
@@ -85,11 +186,11 @@ namespace dual::nds {
         IRQ irq{false};
         Timer timer;
         arm7::DMA dma{bus, irq};
-        arm7::SPI spi{irq};
+        arm7::SPI spi;
         arm7::RTC rtc{};
         arm7::APU apu;
 
-        ARM7(Scheduler& scheduler, SystemMemory& memory, IPC& ipc, VideoUnit& video_unit, Cartridge& cartridge)
+        ARM7(Scheduler& scheduler, SystemMemory& memory, IPC& ipc, VideoUnit& video_unit, Cartridge& cartridge, CPUSync& cpu_sync, Input& input)
             : bus{memory, {
                 irq,
                 timer,
@@ -101,17 +202,26 @@ namespace dual::nds {
                 video_unit,
                 cartridge,
                 rtc,
-                apu
+                apu,
+                cpu_sync,
+                input
               }}
             , timer{scheduler, cycle_counter, irq}
+            , spi{irq, input}
             , apu{scheduler, bus} {}
-      } m_arm7{m_scheduler, m_memory, m_ipc, m_video_unit, m_cartridge};
+      } m_arm7{m_scheduler, m_memory, m_ipc, m_video_unit, m_cartridge, m_cpu_sync, m_input};
 
       IPC m_ipc{m_arm9.irq, m_arm7.irq};
 
+      CPUSync m_cpu_sync{m_arm9.cycle_counter, m_arm7.cycle_counter};
+
       std::shared_ptr<ROM> m_rom;
 
       u64 m_step_target{};
+
+      int m_cpu_sync_quantum{k_default_cpu_sync_quantum};
+      u64 m_cpu_sync_count{};
+      int m_determinism_users{};
   };
 
 } // namespace dual::nds
@@ -0,0 +1,92 @@
+
+#pragma once
+
+#include <atom/integer.hpp>
+#include <condition_variable>
+#include <deque>
+#include <dual/nds/nds.hpp>
+#include <dual/nds/snapshot.hpp>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dual::nds {
+
+  /**
+   * History of save states which allows stepping back in time.
+   * The emulation thread only takes an in-memory snapshot, which copies the memory pages written since the previous one.
+   * A worker thread then flattens the snapshot and stores the XOR difference of consecutive snapshots
+   * with the runs of unchanged bytes removed. Only a small part of the system state changes
+   * within a few frames, so that a snapshot typically costs tens of KiB instead of the full save state size.
+   */
+  class Rewind {
+    public:
+      struct Config {
+        // Number of video frames between two snapshots
+        int frames_per_snapshot = 6;
+
+        // Memory budget for the snapshot history, excluding the in-memory snapshot and the uncompressed working buffers.
+        size_t memory_limit = 64u * 1024u * 1024u;
+      };
+
+      struct Stats {
+        // Number of snapshots which can be restored
+        int snapshot_count;
+
+        // Memory used by the compressed snapshot history
+        size_t memory_used;
+
+        // Time spent by the emulation thread taking the last snapshot (in milliseconds)
+        double last_capture_time;
+      };
+
+      Rewind(NDS& nds, const Config& config);
+     ~Rewind();
+
+      // Takes a snapshot if one is due and returns whether it did so. Must be called in between calls to NDS::Step().
+      bool Update();
+
+      /**
+       * Restores the most recent snapshot and removes it from the history. Returns false if the history is empty.
+       * Like all snapshots it does not contain the frame buffers, these are refreshed by the next emulated frame.
+       */
+      bool StepBack();
+
+      void Clear();
+
+      Stats GetStats() const;
+
+    private:
+      static constexpr u64 k_cycles_per_frame = 560190u;
+
+      void ThreadMain();
+      void WaitForWorker(std::unique_lock<std::mutex>& lock);
+      void EvictSnapshots();
+
+      static void EncodeDelta(const std::vector<u8>& state_new, const std::vector<u8>& state_old, std::vector<u8>& delta);
+      static void ApplyDelta(std::vector<u8>& state, const std::vector<u8>& delta);
+
+      NDS& m_nds;
+      Config m_config;
+      u64 m_timestamp_next_snapshot{};
+      double m_last_capture_time{};
+
+      std::unique_ptr<Snapshot> m_snapshot; //< Taken by the emulation thread, flattened by the worker
+      std::vector<u8> m_pending_buffer{};   //< Flattened snapshot which is being compressed by the worker
+      std::vector<u8> m_latest_buffer{};    //< Most recent snapshot (flattened)
+      std::vector<u8> m_delta_buffer{};
+      bool m_have_latest{};
+
+      // Each delta turns a snapshot into the snapshot before it, the last one applies to the latest snapshot.
+      std::deque<std::vector<u8>> m_deltas{};
+      size_t m_memory_used{};
+
+      std::thread m_thread{};
+      mutable std::mutex m_mutex{};
+      std::condition_variable m_cv{};
+      bool m_job_pending{};
+      bool m_quit{};
+  };
+
+} // namespace dual::nds
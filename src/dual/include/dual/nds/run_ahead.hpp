@@ -0,0 +1,52 @@
+
+#pragma once
+
+#include <atom/integer.hpp>
+#include <dual/nds/nds.hpp>
+#include <dual/nds/snapshot.hpp>
+#include <memory>
+
+namespace dual::nds {
+
+  /**
+   * Hides the input latency of games by emulating a few frames ahead with the current input and presenting the last
+   * of them, after which the system is restored to the frame that has really been emulated.
+   * Only the real frame produces audio and only the frame which is presented is rendered.
+   */
+  class RunAhead {
+    public:
+      struct Stats {
+        // Time spent taking and restoring the snapshot during the last frame (in milliseconds)
+        double last_save_time;
+        double last_load_time;
+      };
+
+      RunAhead(NDS& nds, int frame_count);
+     ~RunAhead();
+
+      // Emulates the next frame and presents the frame which follows frame_count frames later.
+      void RunFrame();
+
+      int GetFrameCount() const {
+        return m_frame_count;
+      }
+
+      Stats GetStats() const {
+        return m_stats;
+      }
+
+    private:
+      static constexpr int k_cycles_per_line = 2130;
+      static constexpr int k_cycles_per_frame = 263 * k_cycles_per_line;
+
+      // Frames are emulated from the middle of one vertical blanking period to the next,
+      // so that each frame is rendered and presented in one piece.
+      static constexpr int k_frame_boundary = 228 * k_cycles_per_line;
+
+      NDS& m_nds;
+      int m_frame_count;
+      std::unique_ptr<Snapshot> m_snapshot;
+      Stats m_stats{};
+  };
+
+} // namespace dual::nds
@@ -0,0 +1,52 @@
+
+#pragma once
+
+#include <array>
+#include <atom/integer.hpp>
+#include <dual/nds/code_pages.hpp>
+#include <dual/nds/system_memory.hpp>
+#include <span>
+#include <vector>
+
+namespace dual::nds {
+
+  /**
+   * Save state which is kept in host memory, so that it can be taken and restored cheaply (e.g. for run-ahead).
+   * Memory that the CPUs can execute code from is tracked at code page granularity: taking or restoring
+   * the snapshot only copies the pages whose write counters changed since the snapshot was last taken or restored.
+   * A snapshot must only be restored into the system that it has been taken from.
+   */
+  class Snapshot {
+    public:
+      // Flattens the snapshot into a buffer (e.g. for compressing it) and restores it from such a buffer.
+      void Serialize(std::vector<u8>& buffer) const;
+      bool Deserialize(std::span<const u8> data);
+
+    private:
+      friend class NDS;
+
+      template<size_t size>
+      struct TrackedMemory {
+        static constexpr size_t k_page_size = 1u << CodePages::k_page_shift;
+        static constexpr size_t k_page_count = size >> CodePages::k_page_shift;
+
+        void Save(const std::array<u8, size>& memory, const std::array<u32, k_page_count>& memory_versions, bool copy_all);
+        void Load(std::array<u8, size>& memory, std::array<u32, k_page_count>& memory_versions);
+
+        std::array<u8, size> data;
+        std::array<u32, k_page_count> versions;
+      };
+
+      void SaveMemory(SystemMemory& memory);
+      void LoadMemory(SystemMemory& memory);
+
+      std::vector<u8> m_state{};
+      bool m_valid{};
+
+      TrackedMemory<0x400000> m_ewram;
+      TrackedMemory<0x8000> m_swram;
+      TrackedMemory<0x8000> m_itcm;
+      TrackedMemory<0x10000> m_iwram;
+  };
+
+} // namespace dual::nds
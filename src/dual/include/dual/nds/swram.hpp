@@ -3,24 +3,44 @@
 
 #include <array>
 #include <atom/integer.hpp>
+#include <dual/common/state.hpp>
+#include <dual/nds/code_pages.hpp>
+#include <functional>
+#include <vector>
 
 namespace dual::nds {
 
   struct SWRAM {
+    using Callback = std::function<void()>;
+
+    explicit SWRAM(CodePages& code_pages) : m_code_pages{code_pages} {}
+
     void Reset();
+    void SaveState(StateWriter& state) const;
+    void LoadState(StateReader& state);
 
     u32   Read_WRAMCNT();
     void Write_WRAMCNT(u8 value);
 
+    // Registers a callback which is invoked whenever the SWRAM allocation changes.
+    void AddCallback(const Callback& callback) {
+      m_callbacks.push_back(callback);
+    }
+
     struct Allocation {
       u8* data{};
       u32 mask{};
+      u32* code_pages{};
     } arm9{}, arm7{};
 
   //private:
     std::array<u8, 0x8000> m_swram;
 
     u8 m_wramcnt = 0u;
+
+    CodePages& m_code_pages;
+
+    std::vector<Callback> m_callbacks{};
   };
 
 } // namespace dual::nds
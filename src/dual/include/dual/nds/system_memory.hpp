@@ -3,15 +3,18 @@
 
 #include <array>
 #include <atom/integer.hpp>
+#include <dual/nds/code_pages.hpp>
 #include <dual/nds/vram/vram.hpp>
 #include <dual/nds/swram.hpp>
 
 namespace dual::nds {
 
   struct SystemMemory {
+    CodePages code_pages{};
+
     std::array<u8, 0x400000> ewram{};
 
-    SWRAM swram{};
+    SWRAM swram{code_pages};
 
     VRAM vram{};
     std::array<u8, 0x800> pram;
@@ -14,6 +14,8 @@ namespace dual::nds {
       Timer(Scheduler& scheduler, CycleCounter& cpu_cycle_counter, IRQ& irq);
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       auto  Read_TMCNT(int id) -> u32;
       void Write_TMCNT(int id, u32 value, u32 mask);
@@ -21,12 +23,14 @@ namespace dual::nds {
     private:
 
       void ScheduleTimerOverflow(int id, int cycle_offset);
+      void OnOverflowEvent(int id, int cycles_late);
       void DoOverflow(int id);
       u16  GetTicksSinceLastReload(int id);
 
       Scheduler& m_scheduler;
       CycleCounter& m_cpu_cycle_counter;
       IRQ& m_irq;
+      Scheduler::EventClass m_event_class_overflow;
 
       struct Channel {
         union TMCNT {
@@ -23,6 +23,8 @@ namespace dual::nds::gpu {
       );
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       void Write_GXFIFO(u32 word) {
         if(m_unpack.params_left > 0) {
@@ -117,6 +119,7 @@ namespace dual::nds::gpu {
       void ApplyMatrixToCurrent(const Matrix4<Fixed20x12>& rhs_matrix);
 
       Scheduler& m_scheduler;
+      Scheduler::EventClass m_event_class_process_commands;
       IRQ& m_arm9_irq;
       GXSTAT& m_gxstat;
       GeometryEngine& m_geometry_engine;
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <atom/vector_n.hpp>
+#include <dual/common/state.hpp>
 #include <dual/nds/video_unit/gpu/math.hpp>
 #include <span>
 
@@ -20,6 +21,8 @@ namespace dual::nds::gpu {
   class GeometryEngine {
     public:
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
       void SubmitVertex(Vector3<Fixed20x12> position);
 
     private:
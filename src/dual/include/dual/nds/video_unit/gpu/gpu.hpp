@@ -22,6 +22,8 @@ namespace dual::nds {
       );
 
       void Reset();
+      void SaveState(StateWriter& state) const;
+      void LoadState(StateReader& state);
 
       void Write_GXFIFO(u32 word) {
         m_cmd_processor.Write_GXFIFO(word);
@@ -1,19 +1,21 @@
 
 #pragma once
 
+#include <array>
 #include <atom/integer.hpp>
 #include <atom/punning.hpp>
 #include <atomic>
-#include <condition_variable>
+#include <cstring>
+#include <dual/common/state.hpp>
 #include <dual/nds/video_unit/ppu/registers.hpp>
 #include <dual/nds/vram/vram.hpp>
 #include <dual/nds/system_memory.hpp>
-#include <functional>
-#include <mutex>
 #include <thread>
 
 namespace dual::nds {
 
+  class RenderPool;
+
   /* 2D picture processing unit (PPU).
    * The Nintendo DS has two PPUs (PPU A and PPU B), one for each screen.
    */
@@ -23,6 +25,18 @@ namespace dual::nds {
 
      ~PPU();
 
+      struct Stats {
+        // Number of scanlines handed to the render worker since the last reset
+        u64 scanlines_submitted;
+
+        // Number of times the render worker had to be woken up, because it was out of work
+        u64 worker_wakeups;
+
+        // Number of times and total time (in nanoseconds) the emulation thread had to wait for the render worker
+        u64 wait_count;
+        u64 wait_time_ns;
+      };
+
       struct MMIO {
         DisplayControl dispcnt;
 
@@ -50,48 +64,89 @@ namespace dual::nds {
         MasterBrightness master_bright;
 
         bool capture_bg_and_3d;
+        bool window_scanline_enable[2];
       } m_mmio;
 
       void Reset();
+      void SaveState(StateWriter& state);
+      void LoadState(StateReader& state);
+
+      /**
+       * Snapshots (see NDS::SaveSnapshot()) do not contain the frame buffers and only refresh
+       * the parts of the rendering copies of memory, which have been written since the snapshot has been taken.
+       */
+      void SaveSnapshot(StateWriter& state);
+      void LoadSnapshot(StateReader& state);
+
+      // Must only be called at the start of a frame. The rendering copies of memory are refreshed once rendering is re-enabled.
+      void SetEnableRendering(bool enable) {
+        m_enable_rendering = enable;
+      }
 
       [[nodiscard]] const u32* GetFrameBuffer() const {
         return &m_frame_buffer[m_frame][0];
       }
 
+      // Returns the frame which has been presented last, it is not touched until the next frame is presented.
+      [[nodiscard]] const u32* GetPresentedFrameBuffer() const {
+        return &m_frame_buffer[m_frame ^ 1][0];
+      }
+
+      [[nodiscard]] const Stats& GetStats() const {
+        return m_stats;
+      }
+
+      /**
+       * Composes and converts each scanline with both the vectorized and the scalar code and counts the scanlines
+       * where the two differ. The scalar result is kept. Must not be changed while scanlines are being rendered.
+       */
+      void SetSIMDVerifyEnable(bool enable) {
+        m_verify_simd = enable;
+      }
+
+      [[nodiscard]] u64 GetSIMDMismatchCount() const {
+        return m_simd_mismatches.load(std::memory_order_relaxed);
+      }
+
       void SwapBuffers() {
         m_frame ^= 1;
       }
 
-      void WaitForRenderWorker() {
-        while(m_render_worker.vcount <= m_render_worker.vcount_max) {}
-      }
+      /**
+       * Renders the visible scanlines in bands on a render pool, which may be shared with the other PPU,
+       * instead of one by one on the PPU's own render worker (if nullptr, which is the default).
+       */
+      void SetRenderPool(RenderPool* render_pool);
+
+      // Blocks until the render worker or the render pool has rendered all submitted scanlines.
+      void WaitForRenderWorker();
 
       void OnWriteVRAM_BG(size_t address_lo, size_t address_hi) {
-        OnRegionWrite(m_vram_bg, m_render_vram_bg, m_vram_bg_dirty, {address_lo, address_hi});
+        OnRegionWrite(m_vram_bg, m_render_vram_bg, m_vram_bg_dirty, m_vram_bg_written, true, {address_lo, address_hi});
       }
 
       void OnWriteVRAM_OBJ(size_t address_lo, size_t address_hi) {
-        OnRegionWrite(m_vram_obj, m_render_vram_obj, m_vram_obj_dirty, {address_lo, address_hi});
+        OnRegionWrite(m_vram_obj, m_render_vram_obj, m_vram_obj_dirty, m_vram_obj_written, true, {address_lo, address_hi});
       }
 
       void OnWriteExtPal_BG(size_t address_lo, size_t address_hi) {
-        OnRegionWrite(m_extpal_bg, m_render_extpal_bg, m_extpal_bg_dirty, {address_lo, address_hi});
+        OnRegionWrite(m_extpal_bg, m_render_extpal_bg, m_extpal_bg_dirty, m_extpal_bg_written, m_sample_extpal_bg, {address_lo, address_hi});
       }
 
       void OnWriteExtPal_OBJ(size_t address_lo, size_t address_hi) {
-        OnRegionWrite(m_extpal_obj, m_render_extpal_obj, m_extpal_obj_dirty, {address_lo, address_hi});
+        OnRegionWrite(m_extpal_obj, m_render_extpal_obj, m_extpal_obj_dirty, m_extpal_obj_written, m_sample_extpal_obj, {address_lo, address_hi});
       }
 
       void OnWriteVRAM_LCDC(size_t address_lo, size_t address_hi) {
-        OnRegionWrite(m_vram_lcdc, m_render_vram_lcdc, m_vram_lcdc_dirty, {address_lo, address_hi});
+        OnRegionWrite(m_vram_lcdc, m_render_vram_lcdc, m_vram_lcdc_dirty, m_vram_lcdc_written, m_sample_vram_lcdc, {address_lo, address_hi});
       }
 
       void OnWritePRAM(size_t address_lo, size_t address_hi) {
-        OnRegionWrite(m_pram, m_render_pram, m_pram_dirty, {address_lo, address_hi});
+        OnRegionWrite(m_pram, m_render_pram, m_pram_dirty, m_pram_written, true, {address_lo, address_hi});
       }
 
       void OnWriteOAM(size_t address_lo, size_t address_hi) {
-        OnRegionWrite(m_oam, m_render_oam, m_oam_dirty, {address_lo, address_hi});
+        OnRegionWrite(m_oam, m_render_oam, m_oam_dirty, m_oam_written, true, {address_lo, address_hi});
       }
 
       void OnDrawScanlineBegin(u16 vcount, bool capture_bg_and_3d);
@@ -99,6 +154,11 @@ namespace dual::nds {
       void OnBlankScanlineBegin(u16 vcount);
 
     private:
+      friend class RenderPool;
+
+      // Number of scanlines which are handed to the render pool at once
+      static constexpr int k_band_lines = 16;
+
       enum ObjectMode {
         OBJ_NORMAL = 0,
         OBJ_SEMI   = 1,
@@ -130,39 +190,175 @@ namespace dual::nds {
       struct AddressRange {
         size_t lo = std::numeric_limits<size_t>::max();
         size_t hi = 0;
+      };
+
+      // Set of 1 KiB pages of a memory region (e.g. the pages which have been written since they have been copied)
+      template<size_t size>
+      struct PageSet {
+        static constexpr int k_page_shift = 10;
+        static constexpr size_t k_page_count = size >> k_page_shift;
+
+        std::array<u64, (k_page_count + 63u) / 64u> bits{};
+
+        bool Contains(size_t page) const {
+          return bits[page >> 6] & (1ull << (page & 63u));
+        }
+
+        void Add(const AddressRange& range) {
+          if(range.lo >= range.hi) {
+            return;
+          }
+
+          for(size_t page = range.lo >> k_page_shift; page <= (range.hi - 1u) >> k_page_shift; page++) {
+            bits[page >> 6] |= 1ull << (page & 63u);
+          }
+        }
 
-        void Expand(const AddressRange& other) {
-          lo = std::min(lo, other.lo);
-          hi = std::max(hi, other.hi);
+        void Add(const PageSet& other) {
+          for(size_t i = 0; i < bits.size(); i++) bits[i] |= other.bits[i];
         }
+
+        void AddAll() {
+          Add(AddressRange{0u, size});
+        }
+
+        void Clear() {
+          bits = {};
+        }
+
+        // Calls the function with the address range of each run of consecutive pages in the set.
+        template<typename Function>
+        void ForEachRange(Function&& function) const {
+          size_t page = 0u;
+
+          while(page < k_page_count) {
+            if(bits[page >> 6] == 0u) {
+              page = (page | 63u) + 1u;
+              continue;
+            }
+
+            if(!Contains(page)) {
+              page++;
+              continue;
+            }
+
+            size_t page_end = page + 1u;
+
+            while(page_end < k_page_count && Contains(page_end)) page_end++;
+
+            function(AddressRange{page << k_page_shift, page_end << k_page_shift});
+            page = page_end;
+          }
+        }
+      };
+
+      enum ObjectPixelFlag : u8 {
+        OBJ_PIXEL_ALPHA  = 1,
+        OBJ_PIXEL_WINDOW = 2
+      };
+
+      // Laid out explicitly, so that the vectorized compositor can load eight pixels at once.
+      struct ObjectPixel {
+        u16 color;
+        u8  priority;
+        u8  flags; //< ObjectPixelFlag
+      };
+
+      static_assert(sizeof(ObjectPixel) == sizeof(u32));
+
+      // Row of a background tile decoded to colors, see FetchTileLine().
+      struct DecodedTileLine {
+        static constexpr u32 k_invalid_key = ~0u;
+
+        u32 key = k_invalid_key;
+        u32 vram_version;
+        u32 palette_version;
+        u16 pixels[8];
+      };
+
+      static constexpr int k_tile_cache_bits = 11;
+
+      enum SpriteFlag : u8 {
+        SPRITE_AFFINE = 1,
+        SPRITE_FLIP_H = 2,
+        SPRITE_FLIP_V = 4,
+        SPRITE_256    = 8,
+        SPRITE_MOSAIC = 16
+      };
+
+      /**
+       * Enabled sprites of the OAM copy (in OAM order), decoded once whenever OAM has changed (see m_oam_version).
+       * Each scanline has a bucket of the sprites whose view rectangle intersects it.
+       */
+      struct SpriteList {
+        u32 oam_version = ~0u;
+
+        s16 x[128]; //< Center of the view rectangle
+        s16 y[128];
+        u8  width[128];
+        u8  height[128];
+        u8  half_width[128];  //< Half the size of the view rectangle (which is doubled for double-size affine sprites)
+        u8  half_height[128];
+        u8  mode[128]; //< ObjectMode
+        u8  priority[128];
+        u8  palette[128];
+        u8  flags[128]; //< SpriteFlag
+        u16 number[128];
+        s16 transform[128][4];
+
+        u8 line_count[192];
+        u8 line_sprites[192][128];
       };
 
+      // Scratch buffers for rendering a scanline. The render worker and each thread of a render pool have their own.
+      struct RenderContext {
+        u16 buffer_compose[256];
+        u16 buffer_bg[4][256];
+        bool buffer_win[2][256];
+        int buffer_3d_alpha[256]{};
+        ObjectPixel buffer_obj[256];
+        bool line_contains_alpha_obj = false;
+
+        // Direct-mapped cache of decoded tile rows for each PPU (a render pool's threads render both PPUs)
+        DecodedTileLine tile_cache[2][1 << k_tile_cache_bits];
+
+        SpriteList sprite_list[2]; //< For each PPU
+      };
+
+      template<typename RenderFunc>
       void AffineRenderLoop(
+        RenderContext& context,
         u16 vcount,
         uint id,
         int  width,
         int  height,
-        const std::function<void(int, int, int)>& render_func
+        const RenderFunc& render_func
       );
 
-      void RenderScanline(u16 vcount, bool capture_bg_and_3d);
+      void RenderScanline(RenderContext& context, u16 vcount, bool capture_bg_and_3d);
       void RenderDisplayOff(u16 vcount);
-      void RenderNormal(u16 vcount);
+      void RenderNormal(RenderContext& context, u16 vcount);
       void RenderVideoMemoryDisplay(u16 vcount);
       void RenderMainMemoryDisplay(u16 vcount);
-      void RenderBackgroundsAndComposite(u16 vcount);
-      void RenderMasterBrightness(int vcount);
+      void RenderBackgroundsAndComposite(RenderContext& context, u16 vcount);
 
-      void RenderLayerText(uint id, u16 vcount);
-      void RenderLayerAffine(uint id, u16 vcount);
-      void RenderLayerExtended(uint id, u16 vcount);
-      void RenderLayerLarge(u16 vcount);
-      void RenderLayerOAM(u16 vcount);
-      void RenderWindow(uint id, u8 vcount);
+      void RenderLayerText(RenderContext& context, uint id, u16 vcount);
+      void RenderLayerAffine(RenderContext& context, uint id, u16 vcount);
+      void RenderLayerExtended(RenderContext& context, uint id, u16 vcount);
+      void RenderLayerLarge(RenderContext& context, u16 vcount);
+      void RenderLayerOAM(RenderContext& context, u16 vcount);
+      const SpriteList& UpdateSpriteList(RenderContext& context);
+      u16  FetchSpritePixel(const MMIO& mmio, const SpriteList& sprites, int i, int tex_x, int tex_y);
+      void RenderWindow(RenderContext& context, uint id, u8 vcount);
 
       template<bool window, bool blending, bool opengl>
-      void ComposeScanlineTmpl(u16 vcount, int bg_min, int bg_max);
-      void ComposeScanline(u16 vcount, int bg_min, int bg_max);
+      void ComposeScanlineTmpl(RenderContext& context, u16 vcount, int bg_min, int bg_max);
+      template<bool window, bool blending>
+      void ComposeScanlineSSE2(RenderContext& context, u16 vcount, int bg_min, int bg_max);
+      void ComposeScanline(RenderContext& context, u16 vcount, int bg_min, int bg_max);
+      void ConvertScanline(const u16* src, u32* dst, const MasterBrightness& master_bright);
+      static void ConvertScanlineSSE2(const u16* src, u32* dst, const MasterBrightness& master_bright);
+      static void ConvertScanlineScalar(const u16* src, u32* dst, const MasterBrightness& master_bright);
       u16  AlphaBlend(u16 color_a, u16 color_b, int eva, int evb);
       u16  Brighten(u16 color, int evy);
       u16  Darken(u16 color, int evy);
@@ -170,15 +366,25 @@ namespace dual::nds {
       void SetupRenderWorker();
       void StopRenderWorker();
       void SubmitScanline(u16 vcount, bool capture_bg_and_3d);
+      void PushRenderJob(int vcount);
+      void WaitForRenderJobs(u32 tail);
+      void SubmitRenderBand();
+      void RenderBand(RenderContext& context, int vcount_lo, int vcount_hi);
+      void WaitForRenderBands();
+      void ApplyWriteJournal(int vcount);
+      void OnRenderCopyWrite(const u8* dst, size_t size);
+      void CopyDirtyMemory();
+      void CopySampledMemory();
+      void MarkAllMemoryDirty();
       void RegisterMapUnmapCallbacks();
 
       u16 ReadPalette(uint palette, uint index) {
         return atom::read<u16>(m_render_pram, palette << 5 | index << 1) & 0x7FFFu;
       }
 
-      void DecodeTileLine4BPP(u16* buffer, u32 base, uint palette, uint number, uint y, bool flip) {
+      void DecodeTileLine4BPP(u16* buffer, u32 address, uint palette, bool flip) {
         int xor_x = flip ? 7 : 0;
-        u32 data  = atom::read<u32>(m_render_vram_bg, base + (number << 5 | y << 2));
+        u32 data  = atom::read<u32>(m_render_vram_bg, address);
 
         for(int x = 0; x < 8; x++) {
           uint index = data & 15;
@@ -188,16 +394,16 @@ namespace dual::nds {
         }
       }
 
-      void DecodeTileLine8BPP(u16* buffer, u32 base, uint palette, uint extpal_slot, uint number, uint y, bool flip) {
+      void DecodeTileLine8BPP(u16* buffer, u32 address, bool enable_extpal, uint palette, uint extpal_slot, bool flip) {
         int xor_x = flip ? 7 : 0;
-        u64 data  = atom::read<u64>(m_render_vram_bg, base + (number << 6 | y << 3));
+        u64 data  = atom::read<u64>(m_render_vram_bg, address);
 
         for(uint x = 0; x < 8; x++) {
           uint index = data & 0xFF;
 
           if(index == 0) {
             buffer[x ^ xor_x] = k_color_transparent;
-          } else if(m_mmio.dispcnt.enable_extpal_bg) {
+          } else if(enable_extpal) {
             buffer[x ^ xor_x] = atom::read<u16>(m_render_extpal_bg, extpal_slot << 13 | palette << 9 | index << 1);
           } else {
             buffer[x ^ xor_x] = ReadPalette(0, index);
@@ -207,6 +413,54 @@ namespace dual::nds {
         }
       }
 
+      /**
+       * Returns a row of a text background tile, which is only decoded if the render context has no cached copy of it
+       * or if the cached copy has been decoded from an older version of the VRAM page or the palette (see m_tile_versions).
+       */
+      const u16* FetchTileLine(RenderContext& context, u32 base, bool full_palette, bool enable_extpal, uint palette, uint extpal_slot, uint number, uint y, bool flip) {
+        u32 address;
+        u32 key;
+        u32 palette_version;
+
+        if(!full_palette) {
+          address = (base + (number << 5 | y << 2)) & (sizeof(m_render_vram_bg) - 1u);
+          key = address >> 2 | palette << 19;
+          palette_version = m_tile_versions.pram_bg[palette];
+        } else {
+          address = (base + (number << 6 | y << 3)) & (sizeof(m_render_vram_bg) - 1u);
+
+          if(enable_extpal) {
+            key = address >> 2 | 1u << 17 | palette << 19 | 1u << 23 | extpal_slot << 24;
+            palette_version = m_tile_versions.extpal_bg[extpal_slot << 4 | palette];
+          } else {
+            key = address >> 2 | 1u << 17;
+            palette_version = m_tile_versions.pram_bg_all;
+          }
+        }
+
+        if(flip) {
+          key |= 1u << 18;
+        }
+
+        const u32 vram_version = m_tile_versions.vram_bg[address >> 10];
+
+        auto& entry = context.tile_cache[m_id][(key * 0x9E3779B1u) >> (32 - k_tile_cache_bits)];
+
+        if(entry.key != key || entry.vram_version != vram_version || entry.palette_version != palette_version) {
+          if(!full_palette) {
+            DecodeTileLine4BPP(entry.pixels, address, palette, flip);
+          } else {
+            DecodeTileLine8BPP(entry.pixels, address, enable_extpal, palette, extpal_slot, flip);
+          }
+
+          entry.key = key;
+          entry.vram_version = vram_version;
+          entry.palette_version = palette_version;
+        }
+
+        return entry.pixels;
+      }
+
       u16 DecodeTilePixel4BPP_OBJ(u32 address, uint palette, int x, int y) {
         u8 tuple = atom::read<u8>(m_render_vram_obj, address + (y << 2 | x >> 1));
         u8 index = (x & 1) ? (tuple >> 4) : (tuple & 0xF);
@@ -223,20 +477,20 @@ namespace dual::nds {
 
         if(index == 0) {
           return k_color_transparent;
-        } else if(enable_extpal && m_mmio.dispcnt.enable_extpal_bg) {
+        } else if(enable_extpal) {
           return atom::read<u16>(m_render_extpal_bg, extpal_slot << 13 | palette << 9 | index << 1);
         } else {
           return ReadPalette(0, index);
         }
       }
 
-      u16 DecodeTilePixel8BPP_OBJ(u32 address, uint palette, int x, int y) {
+      u16 DecodeTilePixel8BPP_OBJ(u32 address, bool enable_extpal, uint palette, int x, int y) {
         u8 index = atom::read<u8>(m_render_vram_obj, address + (y << 3) + x);
 
         if(index == 0) {
           return k_color_transparent;
         } else {
-          if(m_mmio.dispcnt.enable_extpal_obj) {
+          if(enable_extpal) {
             return atom::read<u16>(m_render_extpal_obj, (palette << 9 | index << 1) & 0x1FFF);
           } else {
             return ReadPalette(16, index);
@@ -252,56 +506,145 @@ namespace dual::nds {
         return r << 19 | g << 11 | b << 3 | 0xFF000000;
       }
 
+      template<typename T>
+      static u8 ReadVRAM(const T& src, size_t address) {
+        return src.template Read<u8>(address);
+      }
+
+      static u8 ReadVRAM(const u8* src, size_t address) {
+        return src[address];
+      }
+
       template<typename T>
       static void CopyVRAM(const T& src, u8* dst, const AddressRange& range) {
-        for(size_t address = range.lo; address < range.hi; address++) {
-          dst[address] = src.template Read<u8>(address);
+        if(range.lo < range.hi) {
+          src.Copy((u32)range.lo, range.hi - range.lo, &dst[range.lo]);
         }
       }
 
       static void CopyVRAM(const u8* src, u8* dst, const AddressRange& range) {
-        for(size_t address = range.lo; address < range.hi; address++) {
-          dst[address] = src[address];
+        if(range.lo < range.hi) {
+          std::memcpy(&dst[range.lo], &src[range.lo], range.hi - range.lo);
         }
       }
 
-      template<typename T>
-      void OnRegionWrite(const T& region, u8* copy_dst, AddressRange& dirty_range, const AddressRange& write_range) {
-        if(m_vcount < 192) {
-          WaitForRenderWorker();
-          CopyVRAM(region, copy_dst, write_range);
+      template<typename T, size_t size>
+      void CopyDirtyPages(const T& src, u8 (&dst)[size], PageSet<size>& dirty_pages) {
+        dirty_pages.ForEachRange([&](const AddressRange& range) {
+          CopyVRAM(src, dst, range);
+          OnRenderCopyWrite(&dst[range.lo], range.hi - range.lo);
+        });
+        dirty_pages.Clear();
+      }
+
+      template<typename T, size_t size>
+      void OnRegionWrite(const T& region, u8 (&copy_dst)[size], PageSet<size>& dirty_pages, PageSet<size>& written_pages, bool sampled, AddressRange write_range) {
+        // Writes to mirrors of the region land in the first mirror of the copy.
+        write_range.hi = (write_range.lo & (size - 1u)) + (write_range.hi - write_range.lo);
+        write_range.lo &= size - 1u;
+
+        written_pages.Add(write_range);
+
+        if(m_vcount < 192 && m_enable_rendering && sampled) {
+          // The scanlines which have been submitted must not see the write.
+          if(m_render_pool) {
+            SubmitRenderBand();
+          }
+
+          auto& journal = m_write_journal;
+
+          const size_t write_size = write_range.hi - write_range.lo;
+          const size_t write_index = journal.write_index.load(std::memory_order_relaxed);
+
+          if(write_size <= sizeof(u32) && write_index - journal.read_index.load(std::memory_order_acquire) < WriteJournal::k_capacity) {
+            auto& entry = journal.entries[write_index % WriteJournal::k_capacity];
+
+            entry.dst = copy_dst + write_range.lo;
+            entry.value = 0u;
+
+            for(size_t i = 0; i < write_size; i++) {
+              entry.value |= (u32)ReadVRAM(region, write_range.lo + i) << (i * 8);
+            }
+
+            entry.vcount = (u16)m_vcount;
+            entry.size = (u8)write_size;
+
+            journal.write_index.store(write_index + 1u, std::memory_order_release);
+          } else {
+            // Large writes (i.e. VRAM being (un)mapped) and writes which do not fit into the journal anymore are rare.
+            WaitForRenderWorker();
+            ApplyWriteJournal(k_total_lines);
+            CopyVRAM(region, copy_dst, write_range);
+            OnRenderCopyWrite(&copy_dst[write_range.lo], write_range.hi - write_range.lo);
+          }
         } else {
-          dirty_range.Expand(write_range);
+          dirty_pages.Add(write_range);
         }
       }
 
       u32 m_frame_buffer[2][256 * 192];
-      u16 m_buffer_compose[256];
-      u16 m_buffer_bg[4][256];
-      bool m_buffer_win[2][256];
       bool m_window_scanline_enable[2];
-      int m_buffer_3d_alpha[256];
-
-      struct ObjectPixel {
-        u16 color;
-        u8  priority;
-        unsigned alpha  : 1;
-        unsigned window : 1;
-      } m_buffer_obj[256];
 
-      bool m_line_contains_alpha_obj = false;
+      RenderContext m_render_context; //< Used by the render worker
 
+      /**
+       * Single-producer/single-consumer ring of scanlines which the emulation thread submits to the render worker.
+       * Either thread only blocks (via std::atomic::wait) when the ring is empty respectively when it waits for
+       * the ring to drain, and the other thread only issues a wake-up when it has announced that it is about to block.
+       */
       struct RenderWorker {
-        std::atomic_int vcount;
-        std::atomic_int vcount_max;
-        std::atomic_bool running = false;
-        std::condition_variable cv;
-        std::mutex mutex;
-        bool ready;
+        static constexpr u32 k_capacity = 512u;
+        static constexpr int k_stop = -1; //< Asks the render worker to quit
+
+        int jobs[k_capacity];
+
+        alignas(64) std::atomic<u32> head{}; //< Written by the emulation thread
+        alignas(64) std::atomic<u32> tail{}; //< Written by the render worker
+
+        std::atomic_bool worker_sleeping = false;
+        std::atomic_bool emulator_waiting = false;
+
+        bool running = false;
         std::thread thread;
       } m_render_worker;
 
-      MMIO m_mmio_copy[263];
+      /**
+       * With a render pool, the scanlines are collected into bands, which are rendered in parallel.
+       * Journaled memory writes may only be applied once no band is being rendered, so a write during the visible lines
+       * ends the current band and the next band is only submitted once the previous bands have been rendered.
+       */
+      RenderPool* m_render_pool = nullptr;
+      int m_band_vcount_lo = 0; //< First scanline which has not been submitted to the render pool yet
+      int m_band_vcount_hi = -1; //< Last scanline which has been submitted by the emulation thread
+      std::atomic_int m_bands_pending{};
+
+      Stats m_stats{};
+
+      bool m_verify_simd = false;
+      std::atomic<u64> m_simd_mismatches{}; //< Incremented by whichever thread renders the scanline
+
+      /**
+       * Writes to VRAM, PRAM and OAM during the visible lines, which the render worker applies to the rendering copies
+       * right before it renders the first scanline after the write. This way the emulation thread does not have to wait
+       * for the render worker to catch up. The journal is emptied at the end of each frame.
+       */
+      struct WriteJournal {
+        static constexpr size_t k_capacity = 16384u;
+
+        struct Entry {
+          u8* dst;
+          u32 value;
+          u16 vcount;
+          u8  size;
+        } entries[k_capacity];
+
+        std::atomic<size_t> write_index{};
+        std::atomic<size_t> read_index{};
+      } m_write_journal;
+
+      MMIO m_mmio_copy[192];
+
+      int m_id;
 
       const Region<32>& m_vram_bg;  //< Background tile, map and bitmap data
       const Region<16>& m_vram_obj; //< OBJ tile and bitmap data
@@ -320,19 +663,49 @@ namespace dual::nds {
       u8 m_render_pram[0x400];
       u8 m_render_oam[0x400];
 
-      // Lowest and highest dirty VRAM addresses
-      AddressRange m_vram_bg_dirty;
-      AddressRange m_vram_obj_dirty;
-      AddressRange m_extpal_bg_dirty;
-      AddressRange m_extpal_obj_dirty;
-      AddressRange m_vram_lcdc_dirty;
-      AddressRange m_pram_dirty;
-      AddressRange m_oam_dirty;
+      /**
+       * Incremented whenever the rendering copies of background VRAM, the background palettes or the extended background palettes change.
+       * The render contexts' decoded tile rows are out-of-date when they have been decoded from an older version.
+       * Only written while no scanline which may read the changed memory is being rendered.
+       */
+      struct TileVersions {
+        u32 vram_bg[sizeof(m_render_vram_bg) >> 10]{}; //< Per 1 KiB page
+        u32 pram_bg[16]{}; //< Per 16-color palette
+        u32 pram_bg_all{}; //< Any background palette
+        u32 extpal_bg[64]{}; //< Per 256-color extended palette
+      } m_tile_versions;
+
+      u32 m_oam_version = 0; //< Incremented whenever the rendering copy of OAM changes, see SpriteList
+
+      // Pages whose copies are out-of-date
+      PageSet<sizeof(m_render_vram_bg)> m_vram_bg_dirty;
+      PageSet<sizeof(m_render_vram_obj)> m_vram_obj_dirty;
+      PageSet<sizeof(m_render_extpal_bg)> m_extpal_bg_dirty;
+      PageSet<sizeof(m_render_extpal_obj)> m_extpal_obj_dirty;
+      PageSet<sizeof(m_render_vram_lcdc)> m_vram_lcdc_dirty;
+      PageSet<sizeof(m_render_pram)> m_pram_dirty;
+      PageSet<sizeof(m_render_oam)> m_oam_dirty;
+
+      // Pages written since the last snapshot
+      PageSet<sizeof(m_render_vram_bg)> m_vram_bg_written;
+      PageSet<sizeof(m_render_vram_obj)> m_vram_obj_written;
+      PageSet<sizeof(m_render_extpal_bg)> m_extpal_bg_written;
+      PageSet<sizeof(m_render_extpal_obj)> m_extpal_obj_written;
+      PageSet<sizeof(m_render_vram_lcdc)> m_vram_lcdc_written;
+      PageSet<sizeof(m_render_pram)> m_pram_written;
+      PageSet<sizeof(m_render_oam)> m_oam_written;
+
+      // Whether the current frame samples the copies of LCDC VRAM and the extended palettes, which are otherwise not refreshed.
+      bool m_sample_vram_lcdc = false;
+      bool m_sample_extpal_bg = false;
+      bool m_sample_extpal_obj = false;
 
       int m_vcount;
       int m_frame = 0;
+      bool m_enable_rendering = true;
 
       static constexpr u16 k_color_transparent = 0x8000u;
+      static constexpr int k_total_lines = 263;
   };
 
 } // namespace dual::nds
@@ -120,12 +120,8 @@ namespace dual::nds {
       u16 half = 0u;
     };
 
-    bool changed = true;
-
     void WriteHalf(u16 value, u16 mask) {
       half = (value & mask) | (half & ~mask);
-
-      changed = true;
     }
   };
 
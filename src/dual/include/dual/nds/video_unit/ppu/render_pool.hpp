@@ -0,0 +1,52 @@
+
+#pragma once
+
+#include <atom/integer.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dual::nds {
+
+  class PPU;
+
+  /**
+   * Pool of threads which render bands of consecutive scanlines of both PPUs in parallel (see PPU::SetRenderPool()).
+   * The emulation thread queues a band once all of its scanlines have been submitted and whichever thread is idle renders it.
+   */
+  class RenderPool {
+    public:
+      explicit RenderPool(int thread_count);
+     ~RenderPool();
+
+      [[nodiscard]] int GetThreadCount() const {
+        return (int)m_threads.size();
+      }
+
+      // Queues the scanlines vcount_lo to vcount_hi (inclusive) of the PPU for rendering.
+      void Submit(PPU& ppu, int vcount_lo, int vcount_hi);
+
+    private:
+      // Each PPU has at most one band per scanline outstanding, since the end of a frame waits for all of them.
+      static constexpr u32 k_capacity = 512u;
+
+      struct Band {
+        PPU* ppu;
+        int vcount_lo;
+        int vcount_hi;
+      };
+
+      void ThreadMain();
+
+      Band m_bands[k_capacity];
+      u32 m_head = 0u;
+      u32 m_tail = 0u;
+      bool m_quit = false;
+
+      std::mutex m_mutex;
+      std::condition_variable m_cv;
+      std::vector<std::thread> m_threads;
+  };
+
+} // namespace dual::nds
@@ -8,10 +8,12 @@
 #include <dual/nds/arm9/dma.hpp>
 #include <dual/nds/video_unit/gpu/gpu.hpp>
 #include <dual/nds/video_unit/ppu/ppu.hpp>
+#include <dual/nds/video_unit/ppu/render_pool.hpp>
 #include <dual/nds/enums.hpp>
 #include <dual/nds/irq.hpp>
 #include <dual/nds/system_memory.hpp>
 #include <functional>
+#include <memory>
 
 namespace dual::nds {
 
@@ -27,11 +29,26 @@ namespace dual::nds {
       );
 
       void Reset();
+      void SaveState(StateWriter& state);
+      void LoadState(StateReader& state);
+      void SaveSnapshot(StateWriter& state);
+      void LoadSnapshot(StateReader& state);
 
       void SetPresentationCallback(std::function<void(const u32*, const u32*)> present_callback) {
         m_present_callback = std::move(present_callback);
       }
 
+      // Takes effect at the start of the next frame. Frames which are not rendered are not presented either.
+      void SetEnableRendering(bool enable) {
+        m_enable_rendering = enable;
+      }
+
+      /**
+       * Renders the scanlines of both PPUs on a shared pool of threads (see PPU::SetRenderPool())
+       * or on one render worker per PPU if the thread count is zero (default).
+       */
+      void SetRenderThreadCount(int thread_count);
+
       GPU& GetGPU() {
         return m_gpu;
       }
@@ -40,6 +57,10 @@ namespace dual::nds {
         return m_ppu[id];
       }
 
+      const PPU& GetPPU(int id) const {
+        return m_ppu[id];
+      }
+
       u16   Read_DISPSTAT(CPU cpu);
       void Write_DISPSTAT(CPU cpu, u16 value, u16 mask);
 
@@ -56,6 +77,8 @@ namespace dual::nds {
       void BeginHBlank(int late);
 
       Scheduler& m_scheduler;
+      Scheduler::EventClass m_event_class_hdraw;
+      Scheduler::EventClass m_event_class_hblank;
 
       GPU m_gpu;
       PPU m_ppu[2];
@@ -74,11 +97,16 @@ namespace dual::nds {
       } m_dispstat[2];
 
       u16 m_vcount{};
+      bool m_enable_rendering = true;
+      bool m_rendering_frame = true;
 
       IRQ* m_irq[2]{};
       arm9::DMA& m_dma9;
       arm7::DMA& m_dma7;
       std::function<void(const u32*, const u32*)> m_present_callback;
+
+      // Destroyed before the PPUs, after the bands which have been queued have been rendered.
+      std::unique_ptr<RenderPool> m_render_pool;
   };
 
 } // namespace dual::nds
@@ -5,7 +5,9 @@
 #include <atom/meta.hpp>
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <functional>
+#include <span>
 #include <vector>
 
 namespace dual::nds {
@@ -84,6 +86,41 @@ namespace dual::nds {
         return nullptr;
       }
 
+      // Returns the page which backs the offset, if it is backed by exactly one bank. Otherwise the span is empty.
+      std::span<const u8> GetPageSpan(u32 offset) const {
+        const auto& desc = m_pages[(offset >> k_page_shift) & m_mask];
+
+        if(desc.page != nullptr) [[likely]] {
+          return {desc.page, page_size};
+        }
+        return {};
+      }
+
+      /**
+       * Copies size bytes at offset to dst, as if each byte was read with Read<u8>(), but page by page:
+       * pages backed by a single bank are copied with memcpy and pages backed by multiple banks are ORed together.
+       */
+      void Copy(u32 offset, size_t size, u8* dst) const {
+        while(size > 0u) {
+          const auto& desc = m_pages[(offset >> k_page_shift) & m_mask];
+          const auto page = GetPageSpan(offset);
+          const u32 page_offset = offset & k_page_mask;
+          const size_t chunk_size = std::min(size, (size_t)(page_size - page_offset));
+
+          if(!page.empty()) [[likely]] {
+            std::memcpy(dst, &page[page_offset], chunk_size);
+          } else if(desc.pages != nullptr) {
+            CopyOR(*desc.pages, page_offset, chunk_size, dst);
+          } else {
+            std::memset(dst, 0, chunk_size);
+          }
+
+          offset += chunk_size;
+          size -= chunk_size;
+          dst += chunk_size;
+        }
+      }
+
       template<size_t bank_size>
       void Map(u32 offset, std::array<u8, bank_size>& bank, size_t size = bank_size) {
         auto id = static_cast<size_t>(offset >> k_page_shift);
@@ -157,6 +194,29 @@ namespace dual::nds {
         std::vector<u8*>* pages = nullptr;
       };
 
+      static void CopyOR(const std::vector<u8*>& pages, u32 page_offset, size_t size, u8* dst) {
+        std::memcpy(dst, &pages[0][page_offset], size);
+
+        for(size_t i = 1; i < pages.size(); i++) {
+          const u8* src = &pages[i][page_offset];
+          size_t j = 0;
+
+          // Whole words first, which the compiler turns into a vector loop.
+          for(; j + sizeof(u64) <= size; j += sizeof(u64)) {
+            u64 a;
+            u64 b;
+            std::memcpy(&a, &dst[j], sizeof(u64));
+            std::memcpy(&b, &src[j], sizeof(u64));
+            a |= b;
+            std::memcpy(&dst[j], &a, sizeof(u64));
+          }
+
+          for(; j < size; j++) {
+            dst[j] |= src[j];
+          }
+        }
+      }
+
       size_t m_mask{};
       std::array<PageDescriptor, page_count> m_pages{};
       mutable std::vector<Callback> m_callbacks{};
@@ -4,6 +4,7 @@
 #include <array>
 #include <atom/bit.hpp>
 #include <atom/integer.hpp>
+#include <dual/common/state.hpp>
 #include <dual/nds/vram/region.hpp>
 
 namespace dual::nds {
@@ -22,6 +23,8 @@ namespace dual::nds {
     };
 
     void Reset();
+    void SaveState(StateWriter& state) const;
+    void LoadState(StateReader& state);
 
     u8    Read_VRAMSTAT();
     u8    Read_VRAMCNT(Bank bank);
@@ -1,17 +1,21 @@
 
+#include <dual/nds/arm7/memory.hpp>
+#include <dual/nds/arm9/memory.hpp>
+
 #include "arm.hpp"
 
 namespace dual::arm {
 
-  ARM::ARM(
-    Memory& memory,
+  template<CPU::Model model, typename MemoryBus>
+  ARM<model, MemoryBus>::ARM(
+    MemoryBus& memory,
     Scheduler& scheduler,
-    CycleCounter& cycle_counter,
-    Model model
+    CycleCounter& cycle_counter
   )   : m_memory{memory}
+      , m_code_page_table{memory.GetPageTable(Memory::Bus::Code)}
+      , m_data_page_table{memory.GetPageTable(Memory::Bus::Data)}
       , m_scheduler{scheduler}
-      , m_cycle_counter{cycle_counter}
-      , m_model{model} {
+      , m_cycle_counter{cycle_counter} {
     m_unaligned_data_access_enable = false;
 
     BuildConditionTable();
@@ -20,7 +24,8 @@ namespace dual::arm {
     m_coprocessors.fill(nullptr);
   }
 
-  void ARM::Reset() {
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::Reset() {
     constexpr u32 nop = 0xE320F000;
 
     m_state = {};
@@ -30,15 +35,71 @@ namespace dual::arm {
     m_state.r15 = m_exception_base;
     m_wait_for_irq = false;
     SetIRQFlag(false);
+
+    m_reset_timestamp = m_cycle_counter.GetDeviceTimestampNow();
+    m_halted_cycles = 0u;
+
+    m_idle_loop = nullptr;
+    m_idle_loop_skipped_cycles = 0u;
+    m_idle_loops.fill({});
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::SaveState(StateWriter& state) const {
+    state.Write(m_state.reg);
+    state.Write(m_state.bank);
+    state.Write(m_state.cpsr.word);
+
+    for(const PSR& spsr : m_state.spsr) {
+      state.Write(spsr.word);
+    }
+
+    state.Write(m_irq_line);
+    state.Write(m_wait_for_irq);
+    state.Write(m_exception_base);
+    state.Write(m_unaligned_data_access_enable);
+    state.Write(m_reset_timestamp);
+    state.Write(m_halted_cycles);
+    state.Write(m_idle_loop_skipped_cycles);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::LoadState(StateReader& state) {
+    state.Read(m_state.reg);
+    state.Read(m_state.bank);
+    state.Read(m_state.cpsr.word);
+
+    for(PSR& spsr : m_state.spsr) {
+      state.Read(spsr.word);
+    }
+
+    state.Read(m_irq_line);
+    state.Read(m_wait_for_irq);
+    state.Read(m_exception_base);
+    state.Read(m_unaligned_data_access_enable);
+    state.Read(m_reset_timestamp);
+    state.Read(m_halted_cycles);
+    state.Read(m_idle_loop_skipped_cycles);
+
+    // Idle loops are detected again, cached code is revalidated through the code page versions.
+    m_idle_loop = nullptr;
+    m_idle_loops.fill({});
+
+    // A truncated save state leaves the CPSR zeroed, which does not encode a valid mode.
+    if(state.Good()) {
+      m_spsr = &m_state.spsr[(int)GetRegisterBankByMode((Mode)m_state.cpsr.mode)];
+    }
   }
 
-  void ARM::Run(int cycles) {
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::Run(int cycles) {
     if(GetWaitingForIRQ()) {
       m_cycle_counter.AddDeviceCycles((uint)cycles);
+      m_halted_cycles += (uint)cycles;
       return;
     }
 
-    while(cycles-- > 0 && m_cycle_counter.GetTimestampNow() < m_scheduler.GetTimestampTarget()) {
+    while(cycles-- > 0 && m_cycle_counter.GetTimestampNow() < GetTimestampTarget()) {
       if(GetIRQFlag()) {
         SignalIRQ();
       }
@@ -51,7 +112,7 @@ namespace dual::arm {
         m_opcode[0] = m_opcode[1];
         m_opcode[1] = ReadHalfCode(m_state.r15);
 
-        (this->*k_opcode_lut_16[instruction >> 5])(instruction);
+        Dispatch16(k_opcode_lut_16[instruction >> 5], instruction);
       } else {
         m_state.r15 &= ~3;
 
@@ -67,7 +128,7 @@ namespace dual::arm {
             hash |= 4096;
           }
 
-          (this->*k_opcode_lut_32[hash])(instruction);
+          Dispatch32(k_opcode_lut_32[hash], instruction);
         } else {
           m_state.r15 += 4;
         }
@@ -77,12 +138,19 @@ namespace dual::arm {
 
       if(GetWaitingForIRQ()) {
         m_cycle_counter.AddDeviceCycles(cycles);
+        m_halted_cycles += (uint)cycles;
+        return;
+      }
+
+      if(m_idle_loop) [[unlikely]] {
+        SkipIdleLoop(cycles);
         return;
       }
     }
   }
 
-  void ARM::SignalIRQ() {
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::SignalIRQ() {
     if(m_state.cpsr.mask_irq) {
       return;
     }
@@ -107,19 +175,22 @@ namespace dual::arm {
     ReloadPipeline32();
   }
 
-  void ARM::ReloadPipeline32() {
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::ReloadPipeline32() {
     m_opcode[0] = ReadWordCode(m_state.r15);
     m_opcode[1] = ReadWordCode(m_state.r15 + 4);
     m_state.r15 += 8;
   }
 
-  void ARM::ReloadPipeline16() {
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::ReloadPipeline16() {
     m_opcode[0] = ReadHalfCode(m_state.r15);
     m_opcode[1] = ReadHalfCode(m_state.r15 + 2);
     m_state.r15 += 4;
   }
 
-  void ARM::BuildConditionTable() {
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::BuildConditionTable() {
     for(int flags = 0; flags < 16; flags++) {
       bool n = flags & 8;
       bool z = flags & 4;
@@ -145,7 +216,8 @@ namespace dual::arm {
     }
   }
 
-  auto ARM::GetRegisterBankByMode(Mode mode) -> Bank {
+  template<CPU::Model model, typename MemoryBus>
+  auto ARM<model, MemoryBus>::GetRegisterBankByMode(Mode mode) -> Bank {
     switch(mode) {
       case Mode::User:       return Bank::None;
       case Mode::System:     return Bank::None;
@@ -159,7 +231,8 @@ namespace dual::arm {
     ATOM_PANIC("invalid ARM CPU mode: 0x{:02X}", (uint)mode);
   }
 
-  void ARM::SwitchMode(Mode new_mode) {
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::SwitchMode(Mode new_mode) {
     auto old_bank = GetRegisterBankByMode((Mode)m_state.cpsr.mode);
     auto new_bank = GetRegisterBankByMode(new_mode);
 
@@ -195,4 +268,7 @@ namespace dual::arm {
     m_state.r14 = m_state.bank[(int)new_bank][6];
   }
 
+  template class ARM<CPU::Model::ARM9, nds::arm9::MemoryBus>;
+  template class ARM<CPU::Model::ARM7, nds::arm7::MemoryBus>;
+
 } // namespace dual::arm
@@ -11,16 +11,22 @@
 
 namespace dual::arm {
 
-  class ARM final : public CPU {
+  /**
+   * Interpreter for a specific CPU model and memory bus.
+   * Both are known at compile time, so that model checks are folded and memory accesses do not go through the vtable.
+   */
+  template<CPU::Model model, typename MemoryBus>
+  class ARM : public CPU {
     public:
       ARM(
-        Memory& memory,
+        MemoryBus& memory,
         Scheduler& scheduler,
-        CycleCounter& cycle_counter,
-        Model model
+        CycleCounter& cycle_counter
       );
 
       void Reset() override;
+      void SaveState(StateWriter& state) const override;
+      void LoadState(StateReader& state) override;
 
       u32 GetExceptionBase() const override {
         return m_exception_base;
@@ -38,6 +44,25 @@ namespace dual::arm {
         m_unaligned_data_access_enable = enable;
       }
 
+      void SetIdleLoopDetectionEnable(bool enable) override {
+        m_idle_loop_detection_enable = enable;
+      }
+
+      u64 GetIdleLoopSkippedCycles() const override {
+        return m_idle_loop_skipped_cycles;
+      }
+
+      void RunUntil(int cycles, u64 timestamp_target) override {
+        m_fixed_timestamp_target = timestamp_target;
+        m_use_fixed_timestamp_target = true;
+        Run(cycles);
+        m_use_fixed_timestamp_target = false;
+      }
+
+      u64 GetExecutedInstructionCount() const override {
+        return m_cycle_counter.GetDeviceTimestampNow() - m_reset_timestamp - m_halted_cycles - m_idle_loop_skipped_cycles;
+      }
+
       bool GetWaitingForIRQ() const override {
         return m_wait_for_irq;
       }
@@ -111,10 +136,16 @@ namespace dual::arm {
 
       void Run(int cycles) override;
 
+#ifdef DUAL_ARM_STATIC_DISPATCH
+      // Handlers are called through thunks, which are plain function pointers (half the size of a member pointer).
+      typedef void (*Handler16)(ARM&, u16);
+      typedef void (*Handler32)(ARM&, u32);
+#else
       typedef void (ARM::*Handler16)(u16);
       typedef void (ARM::*Handler32)(u32);
+#endif
 
-    private:
+    protected:
       enum class Condition {
         EQ = 0,
         NE = 1,
@@ -143,7 +174,46 @@ namespace dual::arm {
         Undefined  = 5
       };
 
-      friend struct TableGen;
+      // Maximum length (in instructions, including the branch) of loops considered by the idle loop detection
+      static constexpr int k_idle_loop_max_length = 8;
+      static constexpr int k_idle_loop_cache_size = 64;
+
+      /**
+       * A short loop closed by a backward branch, which has been checked for side effects.
+       * The loop is idle if it is side-effect free and an iteration leaves the register state unchanged.
+       * From then on it will spin until another CPU, DMA or a scheduler event modifies the memory it polls.
+       */
+      struct IdleLoop {
+        // Memory read inside the loop, at the address base + index + offset (negative registers are ignored).
+        struct Load {
+          int base;
+          int index;
+          u32 offset;
+        };
+
+        bool AddLoad(int base, int index, u32 offset) {
+          if(load_count == k_idle_loop_max_length) {
+            return false;
+          }
+          loads[load_count++] = {base, index, offset};
+          return true;
+        }
+
+        u32 key = 0xFFFFFFFFu;
+        const u32* version{};
+        u32 version_snapshot{};
+        bool side_effect_free{};
+        int length{};
+        int load_count{};
+        std::array<Load, k_idle_loop_max_length> loads{};
+
+        // CPU state at the last time the loop branch was taken
+        u64 timestamp = ~0ull;
+        std::array<u32, 15> reg{};
+        u32 cpsr{};
+      };
+
+      template<CPU::Model, typename> friend struct TableGen;
 
       static auto GetRegisterBankByMode(Mode mode) -> Bank;
 
@@ -153,6 +223,50 @@ namespace dual::arm {
       void BuildConditionTable();
       void SwitchMode(Mode new_mode);
 
+      static bool AnalyzeIdleLoopInstruction16(IdleLoop& loop, u32 address, u16 instruction, u16& written);
+      static bool AnalyzeIdleLoopInstruction32(IdleLoop& loop, u32 address, u32 instruction, u16& written);
+
+      IdleLoop* GetIdleLoop(u32 branch_address, u32 target, bool thumb);
+      bool AnalyzeIdleLoop(IdleLoop& loop, u32 branch_address, u32 target, bool thumb);
+      void DetectIdleLoop(u32 branch_address, u32 target, bool thumb);
+      void SkipIdleLoop(int cycles);
+
+      u64 GetTimestampTarget() const {
+        if(m_use_fixed_timestamp_target) {
+          return m_fixed_timestamp_target;
+        }
+        return m_scheduler.GetTimestampTarget();
+      }
+
+      static bool IsIdleLoopBranch(u32 branch_address, u32 target, bool thumb) {
+        const u32 max_distance = (k_idle_loop_max_length - 1) * (thumb ? 2u : 4u);
+
+        return target <= branch_address && branch_address - target <= max_distance;
+      }
+
+      // Called by the (non-linking) branch handlers once the branch has been taken.
+      inline void CheckIdleLoop(u32 branch_address, u32 target, bool thumb) {
+        if(m_idle_loop_detection_enable && IsIdleLoopBranch(branch_address, target, thumb)) {
+          DetectIdleLoop(branch_address, target, thumb);
+        }
+      }
+
+      inline void Dispatch16(Handler16 handler, u16 instruction) {
+#ifdef DUAL_ARM_STATIC_DISPATCH
+        handler(*this, instruction);
+#else
+        (this->*handler)(instruction);
+#endif
+      }
+
+      inline void Dispatch32(Handler32 handler, u32 instruction) {
+#ifdef DUAL_ARM_STATIC_DISPATCH
+        handler(*this, instruction);
+#else
+        (this->*handler)(instruction);
+#endif
+      }
+
       inline bool EvaluateCondition(Condition condition) {
         if(condition == Condition::AL) [[likely]] {
           return true;
@@ -165,12 +279,16 @@ namespace dual::arm {
       #include "handlers/handler32.inl"
       #include "handlers/memory.inl"
 
-      Memory& m_memory;
+      MemoryBus& m_memory;
+      const PageTable* m_code_page_table;
+      const PageTable* m_data_page_table;
       Scheduler& m_scheduler;
       CycleCounter& m_cycle_counter;
-      Model m_model;
       std::array<Coprocessor*, 16> m_coprocessors;
 
+      bool m_use_fixed_timestamp_target = false;
+      u64 m_fixed_timestamp_target = 0u;
+
       bool m_irq_line;
       bool m_wait_for_irq = false;
       u32 m_exception_base = 0;
@@ -236,6 +354,14 @@ namespace dual::arm {
       static std::array<Handler32, 8192> k_opcode_lut_32;
 
       bool m_unaligned_data_access_enable;
+
+      u64 m_reset_timestamp = 0u;
+      u64 m_halted_cycles = 0u;
+
+      bool m_idle_loop_detection_enable = true;
+      u64 m_idle_loop_skipped_cycles = 0u;
+      IdleLoop* m_idle_loop = nullptr;
+      std::array<IdleLoop, k_idle_loop_cache_size> m_idle_loops{};
   };
 
 } // namespace dual::arm
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atom/integer.hpp>
+#include <dual/arm/page_table.hpp>
+#include <memory>
+#include <unordered_map>
+
+namespace dual::arm {
+
+  // Returns whether a Thumb instruction may change control flow and thus must end a block.
+  inline bool EndsBlock16(u16 instruction) {
+    // Conditional branch and SWI
+    if((instruction & 0xF000u) == 0xD000u) return true;
+
+    // Unconditional branch
+    if((instruction & 0xF800u) == 0xE000u) return true;
+
+    // Second half of BL and BLX
+    if((instruction & 0xE800u) == 0xE800u) return true;
+
+    // BX and BLX
+    if((instruction & 0xFF00u) == 0x4700u) return true;
+
+    // High register operation with R15 as the destination
+    if((instruction & 0xFC00u) == 0x4400u && (instruction & 0x87u) == 0x87u) return true;
+
+    // POP with R15 in the register list
+    if((instruction & 0xFF00u) == 0xBD00u) return true;
+
+    return false;
+  }
+
+  // Returns whether an ARM instruction may change control flow (or the instruction set) and thus must end a block.
+  inline bool EndsBlock32(u32 instruction) {
+    const bool writes_r15 = ((instruction >> 12) & 0xFu) == 15u;
+
+    // B, BL and BLX (immediate)
+    if((instruction & 0x0E000000u) == 0x0A000000u) return true;
+
+    // BX and BLX (register)
+    if((instruction & 0x0FFFFFD0u) == 0x012FFF10u) return true;
+
+    // SWI
+    if((instruction & 0x0F000000u) == 0x0F000000u) return true;
+
+    // MSR may switch the processor mode or (in theory) the instruction set
+    if((instruction & 0x0FB000F0u) == 0x01200000u || (instruction & 0x0FB00000u) == 0x03200000u) return true;
+
+    // Data processing (and other encodings in the same space) with R15 as the destination
+    if((instruction & 0x0C000000u) == 0x00000000u && writes_r15) return true;
+
+    // LDR with R15 as the destination
+    if((instruction & 0x0C100000u) == 0x04100000u && writes_r15) return true;
+
+    // LDM with R15 in the register list
+    if((instruction & 0x0E108000u) == 0x08108000u) return true;
+
+    return false;
+  }
+
+  // State shared by all kinds of cached guest code blocks.
+  struct BlockBase {
+    u32 key{};
+    const u32* version{};
+    u32 version_snapshot{};
+
+    bool IsValid() const {
+      return PageTable::LoadCodePageVersion(version) == version_snapshot;
+    }
+  };
+
+  /**
+   * Cache of decoded or compiled guest code blocks, keyed by address and Thumb state.
+   * Blocks are validated against the code page version of their start address on every lookup.
+   */
+  template<typename Block>
+  class BlockCache {
+    public:
+      static u32 GetKey(u32 address, bool thumb) {
+        return address | (thumb ? 1u : 0u);
+      }
+
+      Block* Get(u32 key) {
+        Block*& cached_block = m_lut[(key >> 1) & (k_lut_size - 1)];
+
+        if(cached_block && cached_block->key == key && cached_block->IsValid()) [[likely]] {
+          return cached_block;
+        }
+
+        const auto match = m_blocks.find(key);
+
+        if(match == m_blocks.end() || !match->second->IsValid()) {
+          return nullptr;
+        }
+
+        cached_block = match->second.get();
+        return cached_block;
+      }
+
+      // Returns an existing (but stale) block for reuse or creates a new one. The caller must (re-)build it.
+      Block& Insert(u32 key, const u32* version) {
+        auto& block = m_blocks[key];
+
+        if(!block) {
+          block = std::make_unique<Block>();
+          block->key = key;
+        }
+
+        block->version = version;
+        block->version_snapshot = PageTable::LoadCodePageVersion(version);
+        m_lut[(key >> 1) & (k_lut_size - 1)] = block.get();
+        return *block;
+      }
+
+      void Flush() {
+        m_blocks.clear();
+        m_lut.fill(nullptr);
+      }
+
+    private:
+      static constexpr int k_lut_size = 4096;
+
+      std::unordered_map<u32, std::unique_ptr<Block>> m_blocks{};
+      std::array<Block*, k_lut_size> m_lut{};
+  };
+
+} // namespace dual::arm
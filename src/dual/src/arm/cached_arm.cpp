@@ -0,0 +1,163 @@
+#include <dual/nds/arm7/memory.hpp>
+#include <dual/nds/arm9/memory.hpp>
+
+#include "cached_arm.hpp"
+
+namespace dual::arm {
+
+  template<CPU::Model model, typename MemoryBus>
+  CachedARM<model, MemoryBus>::CachedARM(
+    MemoryBus& memory,
+    Scheduler& scheduler,
+    CycleCounter& cycle_counter
+  )   : Base{memory, scheduler, cycle_counter} {
+    // Instructions outside of cacheable memory are decoded again on every execution, so the block never becomes stale.
+    m_uncached_block.version = &m_uncached_block.version_snapshot;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void CachedARM<model, MemoryBus>::Reset() {
+    Base::Reset();
+    m_block_cache.Flush();
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void CachedARM<model, MemoryBus>::Run(int cycles) {
+    if(GetWaitingForIRQ()) {
+      m_cycle_counter.AddDeviceCycles((uint)cycles);
+      m_halted_cycles += (uint)cycles;
+      return;
+    }
+
+    while(cycles > 0 && m_cycle_counter.GetTimestampNow() < GetTimestampTarget()) {
+      if(GetIRQFlag()) {
+        SignalIRQ();
+      }
+
+      if(m_state.cpsr.thumb) {
+        m_state.r15 &= ~1;
+        cycles -= RunBlock<true>(*GetBlock(m_state.r15 - 4, true), cycles);
+      } else {
+        m_state.r15 &= ~3;
+        cycles -= RunBlock<false>(*GetBlock(m_state.r15 - 8, false), cycles);
+      }
+
+      if(GetWaitingForIRQ()) {
+        m_cycle_counter.AddDeviceCycles(cycles);
+        m_halted_cycles += (uint)cycles;
+        return;
+      }
+
+      if(m_idle_loop) [[unlikely]] {
+        SkipIdleLoop(cycles);
+        return;
+      }
+    }
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  template<bool thumb> int CachedARM<model, MemoryBus>::RunBlock(const Block& block, int cycles) {
+    int executed = 0;
+
+    for(const auto& instruction : block.instructions) {
+      const u32 next_r15 = m_state.r15 + (thumb ? 2 : 4);
+
+      if constexpr(thumb) {
+        Dispatch16(instruction.handler16, (u16)instruction.opcode);
+      } else if(EvaluateCondition(instruction.condition)) {
+        Dispatch32(instruction.handler32, instruction.opcode);
+      } else {
+        m_state.r15 += 4;
+      }
+
+      m_cycle_counter.AddDeviceCycles(1u);
+
+      // Leave the block on anything that the interpreter would observe before the next instruction.
+      // This includes stores into the block's own code page, which must not execute stale instructions.
+      if(
+        ++executed == cycles ||
+        !block.IsValid() ||
+        m_state.r15 != next_r15 ||
+        m_wait_for_irq ||
+        (m_irq_line && !m_state.cpsr.mask_irq) ||
+        m_cycle_counter.GetTimestampNow() >= GetTimestampTarget()
+      ) {
+        break;
+      }
+    }
+
+    return executed;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  auto CachedARM<model, MemoryBus>::GetBlock(u32 address, bool thumb) -> Block* {
+    const u32 key = BlockCache<Block>::GetKey(address, thumb);
+
+    if(Block* block = m_block_cache.Get(key); block) [[likely]] {
+      return block;
+    }
+
+    const u32* version = m_memory.GetCodePageVersion(address);
+
+    // Code outside of cacheable memory (i.e. MMIO or VRAM) is decoded one instruction at a time.
+    if(version == nullptr) {
+      Decode(m_uncached_block, address, thumb, 1);
+      return &m_uncached_block;
+    }
+
+    Block& block = m_block_cache.Insert(key, version);
+    Decode(block, address, thumb, k_max_block_length);
+    return &block;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void CachedARM<model, MemoryBus>::Decode(Block& block, u32 address, bool thumb, int max_length) {
+    constexpr u32 page_mask = (1u << Memory::k_code_page_shift) - 1u;
+
+    const u32 page_end = (address | page_mask) + 1u;
+
+    block.instructions.clear();
+
+    // Blocks end on the first instruction which may change control flow or the end of the code page.
+    while(max_length-- > 0 && address != page_end) {
+      typename Block::Instruction instruction{};
+
+      if(thumb) {
+        const u16 opcode = ReadHalfCode(address);
+
+        instruction.handler16 = k_opcode_lut_16[opcode >> 5];
+        instruction.opcode = opcode;
+        instruction.condition = Condition::AL;
+        block.instructions.push_back(instruction);
+        address += 2u;
+
+        if(EndsBlock16(opcode)) {
+          break;
+        }
+      } else {
+        const u32 opcode = ReadWordCode(address);
+        const auto condition = static_cast<Condition>(opcode >> 28);
+
+        int hash = static_cast<int>(((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0x00F));
+
+        if(condition == Condition::NV) {
+          hash |= 4096;
+        }
+
+        instruction.handler32 = k_opcode_lut_32[hash];
+        instruction.opcode = opcode;
+        instruction.condition = condition;
+        block.instructions.push_back(instruction);
+        address += 4u;
+
+        if(EndsBlock32(opcode)) {
+          break;
+        }
+      }
+    }
+  }
+
+  template class CachedARM<CPU::Model::ARM9, nds::arm9::MemoryBus>;
+  template class CachedARM<CPU::Model::ARM7, nds::arm7::MemoryBus>;
+
+} // namespace dual::arm
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+
+#include "arm.hpp"
+#include "block_cache.hpp"
+
+namespace dual::arm {
+
+  /**
+   * Interpreter which decodes guest code once into basic blocks of pre-resolved handlers
+   * and afterwards executes these blocks without fetching and decoding each instruction again.
+   * Blocks are keyed by their address and Thumb state and are validated against the
+   * code page version reported by the memory bus before they are executed.
+   */
+  template<CPU::Model model, typename MemoryBus>
+  class CachedARM final : public ARM<model, MemoryBus> {
+    public:
+      CachedARM(
+        MemoryBus& memory,
+        Scheduler& scheduler,
+        CycleCounter& cycle_counter
+      );
+
+      void Reset() override;
+      void Run(int cycles) override;
+
+    private:
+      using Base = ARM<model, MemoryBus>;
+      using typename Base::Condition;
+      using typename Base::Handler16;
+      using typename Base::Handler32;
+      using Base::m_memory;
+      using Base::GetTimestampTarget;
+      using Base::m_cycle_counter;
+      using Base::m_irq_line;
+      using Base::m_wait_for_irq;
+      using Base::m_state;
+      using Base::m_halted_cycles;
+      using Base::m_idle_loop;
+      using Base::k_opcode_lut_16;
+      using Base::k_opcode_lut_32;
+      using Base::GetWaitingForIRQ;
+      using Base::GetIRQFlag;
+      using Base::SignalIRQ;
+      using Base::SkipIdleLoop;
+      using Base::EvaluateCondition;
+      using Base::Dispatch16;
+      using Base::Dispatch32;
+      using Base::ReadHalfCode;
+      using Base::ReadWordCode;
+
+      static constexpr int k_max_block_length = 32;
+
+      struct Block : BlockBase {
+        struct Instruction {
+          union {
+            Handler16 handler16;
+            Handler32 handler32;
+          };
+          u32 opcode;
+          Condition condition;
+        };
+
+        std::vector<Instruction> instructions{};
+      };
+
+      Block* GetBlock(u32 address, bool thumb);
+      void Decode(Block& block, u32 address, bool thumb, int max_length);
+
+      template<bool thumb> int RunBlock(const Block& block, int cycles);
+
+      BlockCache<Block> m_block_cache{};
+      Block m_uncached_block{};
+  };
+
+} // namespace dual::arm
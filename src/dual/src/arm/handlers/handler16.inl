@@ -221,7 +221,7 @@ void Thumb_HighRegisterOps_BX(u16 instruction) {
     }
     case ThumbHighRegOp::BLX: {
       // NOTE: "high1" is reused as link bit for branch exchange instructions.
-      if(high1 && m_model != Model::ARM7) {
+      if(high1 && model != Model::ARM7) {
         m_state.r14 = (m_state.r15 - 2) | 1;
       }
 
@@ -478,8 +478,11 @@ void Thumb_ConditionalBranch(u16 instruction) {
       imm |= 0xFFFFFF00;
     }
 
+    const u32 address = m_state.r15 - 4;
+
     m_state.r15 += imm * 2;
     ReloadPipeline16();
+    CheckIdleLoop(address, m_state.r15 - 4, true);
   } else {
     m_state.r15 += 2;
   }
@@ -506,8 +509,11 @@ void Thumb_UnconditionalBranch(u16 instruction) {
     imm |= 0xFFFFF800;
   }
 
+  const u32 address = m_state.r15 - 4;
+
   m_state.r15 += imm;
   ReloadPipeline16();
+  CheckIdleLoop(address, m_state.r15 - 4, true);
 }
 
 void Thumb_LongBranchLinkPrefix(u16 instruction) {
@@ -526,7 +532,7 @@ void Thumb_LongBranchLinkSuffix(u16 instruction) {
   u32 temp = m_state.r15 - 2;
 
   // BLX does not exist in ARMv4T
-  if(exchange && m_model == Model::ARM7) {
+  if(exchange && model == Model::ARM7) {
     Thumb_Undefined(instruction);
     return;
   }
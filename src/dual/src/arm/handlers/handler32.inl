@@ -285,7 +285,7 @@ void ARM_MultiplyLong(u32 instruction) {
 
 template <bool accumulate, bool x, bool y>
 void ARM_SignedHalfwordMultiply(u32 instruction) {
-  if(m_model == Model::ARM7) {
+  if constexpr(model == Model::ARM7) {
     ARM_Undefined(instruction);
     return;
   }
@@ -325,7 +325,7 @@ void ARM_SignedHalfwordMultiply(u32 instruction) {
 
 template <bool accumulate, bool y>
 void ARM_SignedWordHalfwordMultiply(u32 instruction) {
-  if(m_model == Model::ARM7) {
+  if constexpr(model == Model::ARM7) {
     // @todo: unclear how this instruction behaves on the ARM7.
     ARM_Undefined(instruction);
     return;
@@ -360,7 +360,7 @@ void ARM_SignedWordHalfwordMultiply(u32 instruction) {
 
 template <bool x, bool y>
 void ARM_SignedHalfwordMultiplyLongAccumulate(u32 instruction) {
-  if(m_model == Model::ARM7) {
+  if constexpr(model == Model::ARM7) {
     // @todo: unclear how this instruction behaves on the ARM7.
     ARM_Undefined(instruction);
     return;
@@ -422,7 +422,7 @@ void ARM_BranchAndExchangeMaybeLink(u32 instruction) {
   u32 address = m_state.reg[instruction & 0xF];
 
   if constexpr(link) {
-    if(m_model == Model::ARM7) {
+    if constexpr(model == Model::ARM7) {
       ARM_Undefined(instruction);
       return;
     }
@@ -472,7 +472,7 @@ void ARM_HalfDoubleAndSignedTransfer(u32 instruction) {
     case 2: {
       if constexpr(load) {
         m_state.reg[dst] = ReadByteSigned(address);
-      } else if(m_model != Model::ARM7) {
+      } else if(model != Model::ARM7) {
         // LDRD: using an odd numbered destination register is undefined.
         if((dst & 1) == 1) {
           m_state.r15 -= 4;
@@ -498,7 +498,7 @@ void ARM_HalfDoubleAndSignedTransfer(u32 instruction) {
     case 3: {
       if constexpr(load) {
         m_state.reg[dst] = ReadHalfSigned(address);
-      } else if(m_model != Model::ARM7) {
+      } else if(model != Model::ARM7) {
         // STRD: using an odd numbered destination register is undefined.
         if((dst & 1) == 1) {
           m_state.r15 -= 4;
@@ -541,8 +541,14 @@ void ARM_BranchAndLink(u32 instruction) {
     m_state.r14 = m_state.r15 - 4;
   }
 
+  const u32 address = m_state.r15 - 8;
+
   m_state.r15 += offset * 4;
   ReloadPipeline32();
+
+  if constexpr(!link) {
+    CheckIdleLoop(address, m_state.r15 - 8, false);
+  }
 }
 
 void ARM_BranchLinkExchangeImm(u32 instruction) {
@@ -619,7 +625,7 @@ void ARM_SingleDataTransfer(u32 instruction) {
 
   if constexpr(load) {
     if(dst == 15) {
-      if((m_state.r15 & 1) && m_model != Model::ARM7) {
+      if((m_state.r15 & 1) && model != Model::ARM7) {
         if(byte || translation) {
           ATOM_PANIC("unpredictable LDRB or LDRT to PC (PC=0x{:08X})", m_state.r15);
         }
@@ -648,7 +654,7 @@ void ARM_BlockDataTransfer(u32 instruction) {
   bool base_is_last = false;
 
   // Fail if we detect any unknown ARM11 edge-cases
-  if(m_model == Model::ARM11) {
+  if constexpr(model == Model::ARM11) {
     if(list == 0) {
       ATOM_PANIC("unknown ARM11 LDM/STM with empty register set: 0x{:08X}", instruction);
     }
@@ -682,7 +688,7 @@ void ARM_BlockDataTransfer(u32 instruction) {
     #endif
   } else {
     bytes = 16 * sizeof(u32);
-    if(m_model == Model::ARM7) {
+    if constexpr(model == Model::ARM7) {
       list = 1 << 15;
       transfer_pc = true;
     }
@@ -700,7 +706,7 @@ void ARM_BlockDataTransfer(u32 instruction) {
   // STM ARMv4: store new base if base is not the first register and old base otherwise.
   // STM ARMv5: always store old base.
   if constexpr(writeback && !load) {
-    if(m_model == Model::ARM7 && !base_is_first) {
+    if(model == Model::ARM7 && !base_is_first) {
       m_state.reg[base] = base_new;
     }
   }
@@ -752,7 +758,7 @@ void ARM_BlockDataTransfer(u32 instruction) {
 
   if constexpr(writeback) {
     if constexpr(load) {
-      switch(m_model) {
+      switch(model) {
         case Model::ARM9:
         case Model::ARM11: // @todo: research ARM11MPCore behaviour
           // LDM ARMv5: writeback if base is the only register or not the last register.
@@ -772,7 +778,7 @@ void ARM_BlockDataTransfer(u32 instruction) {
 
   if constexpr(load) {
     if(transfer_pc) {
-      if((m_state.r15 & 1) && !user_mode && m_model != Model::ARM7) {
+      if((m_state.r15 & 1) && !user_mode && model != Model::ARM7) {
         m_state.cpsr.thumb = 1;
         m_state.r15 &= ~1;
       }
@@ -801,7 +807,7 @@ void ARM_SWI(u32 instruction) {
 }
 
 void ARM_CountLeadingZeros(u32 instruction) {
-  if(m_model == Model::ARM7) {
+  if constexpr(model == Model::ARM7) {
     ARM_Undefined(instruction);
     return;
   }
@@ -845,7 +851,7 @@ void ARM_CountLeadingZeros(u32 instruction) {
 
 template <int opcode>
 void ARM_SaturatingAddSubtract(u32 instruction) {
-  if(m_model == Model::ARM7) {
+  if constexpr(model == Model::ARM7) {
     ARM_Undefined(instruction);
     return;
   }
@@ -1,28 +1,51 @@
 
 using Bus = Memory::Bus;
 
+// Accesses memory through the page table of the bus if possible and otherwise calls into the memory bus.
+template<typename T>
+auto ReadMemory(const PageTable* page_table, u32 address, Bus bus) -> T {
+  if(T value; page_table && page_table->TryRead<T>(address & ~(sizeof(T) - 1u), value)) [[likely]] {
+    return value;
+  }
+
+  if constexpr(std::is_same_v<T, u8 >) return m_memory.ReadByte(address, bus);
+  if constexpr(std::is_same_v<T, u16>) return m_memory.ReadHalf(address, bus);
+  if constexpr(std::is_same_v<T, u32>) return m_memory.ReadWord(address, bus);
+}
+
+template<typename T>
+void WriteMemory(u32 address, T value) {
+  if(m_data_page_table && m_data_page_table->TryWrite<T>(address & ~(sizeof(T) - 1u), value)) [[likely]] {
+    return;
+  }
+
+  if constexpr(std::is_same_v<T, u8 >) m_memory.WriteByte(address, value, Bus::Data);
+  if constexpr(std::is_same_v<T, u16>) m_memory.WriteHalf(address, value, Bus::Data);
+  if constexpr(std::is_same_v<T, u32>) m_memory.WriteWord(address, value, Bus::Data);
+}
+
 auto ReadByte(u32 address) -> u32 {
-  return m_memory.ReadByte(address, Bus::Data);
+  return ReadMemory<u8>(m_data_page_table, address, Bus::Data);
 }
 
 auto ReadHalf(u32 address) -> u32 {
-  return m_memory.ReadHalf(address, Bus::Data);
+  return ReadMemory<u16>(m_data_page_table, address, Bus::Data);
 }
 
 auto ReadWord(u32 address) -> u32 {
-  return m_memory.ReadWord(address, Bus::Data);
+  return ReadMemory<u32>(m_data_page_table, address, Bus::Data);
 }
 
 auto ReadHalfCode(u32 address) -> u32 {
-  return m_memory.ReadHalf(address, Bus::Code);
+  return ReadMemory<u16>(m_code_page_table, address, Bus::Code);
 }
 
 auto ReadWordCode(u32 address) -> u32 {
-  return m_memory.ReadWord(address, Bus::Code);
+  return ReadMemory<u32>(m_code_page_table, address, Bus::Code);
 }
 
 auto ReadByteSigned(u32 address) -> u32 {
-  u32 value = m_memory.ReadByte(address, Bus::Data);
+  u32 value = ReadMemory<u8>(m_data_page_table, address, Bus::Data);
 
   if(value & 0x80) {
     value |= 0xFFFFFF00;
@@ -32,9 +55,9 @@ auto ReadByteSigned(u32 address) -> u32 {
 }
 
 auto ReadHalfMaybeRotate(u32 address) -> u32 {
-  u32 value = m_memory.ReadHalf(address, Bus::Data);
+  u32 value = ReadMemory<u16>(m_data_page_table, address, Bus::Data);
   
-  if((address & 1) && m_model == Model::ARM7) {
+  if(model == Model::ARM7 && (address & 1)) {
     value = (value >> 8) | (value << 24);
   }
   
@@ -42,11 +65,11 @@ auto ReadHalfMaybeRotate(u32 address) -> u32 {
 }
 
 auto ReadHalfSigned(u32 address) -> u32 {
-  if((address & 1) && m_model == Model::ARM7) {
+  if(model == Model::ARM7 && (address & 1)) {
     return ReadByteSigned(address);
   }
 
-  u32 value = m_memory.ReadHalf(address, Bus::Data);
+  u32 value = ReadMemory<u16>(m_data_page_table, address, Bus::Data);
   if(value & 0x8000) {
     return value | 0xFFFF0000;
   }
@@ -54,7 +77,7 @@ auto ReadHalfSigned(u32 address) -> u32 {
 }
 
 auto ReadWordRotate(u32 address) -> u32 {
-  auto value = m_memory.ReadWord(address, Bus::Data);
+  auto value = ReadMemory<u32>(m_data_page_table, address, Bus::Data);
   auto shift = (address & 3) * 8;
 
   if(!m_unaligned_data_access_enable) {
@@ -65,13 +88,13 @@ auto ReadWordRotate(u32 address) -> u32 {
 }
 
 void WriteByte(u32 address, u8  value) {
-  m_memory.WriteByte(address, value, Bus::Data);
+  WriteMemory<u8>(address, value);
 }
 
 void WriteHalf(u32 address, u16 value) {
-  m_memory.WriteHalf(address, value, Bus::Data);
+  WriteMemory<u16>(address, value);
 }
 
 void WriteWord(u32 address, u32 value) {
-  m_memory.WriteWord(address, value, Bus::Data);
+  WriteMemory<u32>(address, value);
 }
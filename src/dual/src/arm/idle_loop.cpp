@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <dual/nds/arm7/memory.hpp>
+#include <dual/nds/arm9/memory.hpp>
+
+#include "arm.hpp"
+
+namespace dual::arm {
+
+  // Returns whether an ARM instruction is free of side effects (other than writing the registers in written).
+  template<CPU::Model model, typename MemoryBus>
+  bool ARM<model, MemoryBus>::AnalyzeIdleLoopInstruction32(IdleLoop& loop, u32 address, u32 instruction, u16& written) {
+    const int reg_n = (int)((instruction >> 16) & 15u);
+    const int reg_d = (int)((instruction >> 12) & 15u);
+    const int reg_s = (int)((instruction >>  8) & 15u);
+    const int reg_m = (int)(instruction & 15u);
+
+    if((instruction >> 28) == 15u) {
+      return false;
+    }
+
+    switch((instruction >> 25) & 7u) {
+      case 0b000: {
+        if((instruction & 0x90u) == 0x90u) {
+          // LDRH, LDRSB and LDRSH with an immediate offset and without writeback
+          if((instruction & 0x01700000u) != 0x01500000u || (instruction & 0x60u) == 0u || reg_d == 15) {
+            return false;
+          }
+
+          const u32 offset = ((instruction >> 4) & 0xF0u) | (instruction & 0x0Fu);
+
+          written |= 1u << reg_d;
+
+          if(reg_n == 15) {
+            return loop.AddLoad(-1, -1, address + 8u + ((instruction & (1u << 23)) ? offset : -offset));
+          }
+          return loop.AddLoad(reg_n, -1, (instruction & (1u << 23)) ? offset : -offset);
+        }
+
+        if(reg_m == 15 || ((instruction & 0x10u) && reg_s == 15)) {
+          return false;
+        }
+        [[fallthrough]];
+      }
+      case 0b001: {
+        const int opcode = (int)((instruction >> 21) & 15u);
+        const bool compare = opcode >= 8 && opcode <= 11;
+
+        // MRS, MSR, BX and friends
+        if(compare && !(instruction & (1u << 20))) {
+          return false;
+        }
+
+        if(reg_d == 15 || reg_n == 15) {
+          return false;
+        }
+
+        if(!compare) {
+          written |= 1u << reg_d;
+        }
+        return true;
+      }
+      case 0b010: {
+        // LDR and LDRB with an immediate offset and without writeback
+        if((instruction & 0x01300000u) != 0x01100000u || reg_d == 15) {
+          return false;
+        }
+
+        const u32 offset = instruction & 0xFFFu;
+
+        written |= 1u << reg_d;
+
+        if(reg_n == 15) {
+          return loop.AddLoad(-1, -1, address + 8u + ((instruction & (1u << 23)) ? offset : -offset));
+        }
+        return loop.AddLoad(reg_n, -1, (instruction & (1u << 23)) ? offset : -offset);
+      }
+    }
+
+    return false;
+  }
+
+  // Returns whether a Thumb instruction is free of side effects (other than writing the registers in written).
+  template<CPU::Model model, typename MemoryBus>
+  bool ARM<model, MemoryBus>::AnalyzeIdleLoopInstruction16(IdleLoop& loop, u32 address, u16 instruction, u16& written) {
+    const int reg_d = instruction & 7;
+    const int reg_s = (instruction >> 3) & 7;
+
+    switch(instruction >> 11) {
+      // Move shifted register, add and subtract
+      case 0b00000:
+      case 0b00001:
+      case 0b00010:
+      case 0b00011: {
+        written |= 1u << reg_d;
+        return true;
+      }
+      // Move, compare, add and subtract immediate
+      case 0b00100:
+      case 0b00110:
+      case 0b00111: {
+        written |= 1u << ((instruction >> 8) & 7);
+        return true;
+      }
+      case 0b00101: {
+        return true;
+      }
+      case 0b01000: {
+        // ALU operations
+        if((instruction & 0x0400u) == 0u) {
+          const int opcode = (instruction >> 6) & 15;
+
+          // Everything except TST, CMP and CMN
+          if(opcode != 8 && opcode != 10 && opcode != 11) {
+            written |= 1u << reg_d;
+          }
+          return true;
+        }
+
+        // High register operations (except BX and BLX)
+        const int opcode = (instruction >> 8) & 3;
+        const int reg_hd = reg_d | ((instruction >> 4) & 8);
+        const int reg_hs = (instruction >> 3) & 15;
+
+        if(opcode == 3 || reg_hd == 15 || reg_hs == 15) {
+          return false;
+        }
+
+        if(opcode != 1) {
+          written |= 1u << reg_hd;
+        }
+        return true;
+      }
+      // PC-relative load
+      case 0b01001: {
+        written |= 1u << ((instruction >> 8) & 7);
+        return loop.AddLoad(-1, -1, ((address + 4u) & ~2u) + (instruction & 0xFFu) * 4u);
+      }
+      // Load and store with register offset
+      case 0b01010:
+      case 0b01011: {
+        // STR, STRH and STRB
+        if(((instruction >> 9) & 7) <= 2) {
+          return false;
+        }
+
+        written |= 1u << reg_d;
+        return loop.AddLoad(reg_s, (instruction >> 6) & 7, 0u);
+      }
+      // LDR, LDRB and LDRH with immediate offset
+      case 0b01101: {
+        written |= 1u << reg_d;
+        return loop.AddLoad(reg_s, -1, ((instruction >> 6) & 31u) * 4u);
+      }
+      case 0b01111: {
+        written |= 1u << reg_d;
+        return loop.AddLoad(reg_s, -1, (instruction >> 6) & 31u);
+      }
+      case 0b10001: {
+        written |= 1u << reg_d;
+        return loop.AddLoad(reg_s, -1, ((instruction >> 6) & 31u) * 2u);
+      }
+      // SP-relative load
+      case 0b10011: {
+        written |= 1u << ((instruction >> 8) & 7);
+        return loop.AddLoad(13, -1, (instruction & 0xFFu) * 4u);
+      }
+      // Load address
+      case 0b10100:
+      case 0b10101: {
+        written |= 1u << ((instruction >> 8) & 7);
+        return true;
+      }
+      // Add offset to stack pointer
+      case 0b10110: {
+        if((instruction & 0xFF00u) != 0xB000u) {
+          return false;
+        }
+
+        written |= 1u << 13;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  auto ARM<model, MemoryBus>::GetIdleLoop(u32 branch_address, u32 target, bool thumb) -> IdleLoop* {
+    const u32 key = branch_address | (thumb ? 1u : 0u);
+
+    IdleLoop& loop = m_idle_loops[(branch_address >> 1) & (k_idle_loop_cache_size - 1)];
+
+    if(loop.key != key || PageTable::LoadCodePageVersion(loop.version) != loop.version_snapshot) {
+      const u32* version = m_memory.GetCodePageVersion(branch_address);
+
+      // The loop must be in cacheable memory and must not cross a code page boundary.
+      if(version == nullptr || (target >> Memory::k_code_page_shift) != (branch_address >> Memory::k_code_page_shift)) {
+        return nullptr;
+      }
+
+      loop = {};
+      loop.key = key;
+      loop.version = version;
+      loop.version_snapshot = PageTable::LoadCodePageVersion(version);
+      loop.side_effect_free = AnalyzeIdleLoop(loop, branch_address, target, thumb);
+    }
+
+    if(!loop.side_effect_free) {
+      return nullptr;
+    }
+    return &loop;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool ARM<model, MemoryBus>::AnalyzeIdleLoop(IdleLoop& loop, u32 branch_address, u32 target, bool thumb) {
+    u16 written = 0u;
+
+    for(u32 address = target; address != branch_address; address += thumb ? 2u : 4u) {
+      const bool side_effect_free = thumb ?
+        AnalyzeIdleLoopInstruction16(loop, address, ReadHalfCode(address), written) :
+        AnalyzeIdleLoopInstruction32(loop, address, ReadWordCode(address), written);
+
+      if(!side_effect_free) {
+        return false;
+      }
+    }
+
+    // Load addresses must be loop invariant, so that they can be evaluated from the register state at the branch.
+    for(int i = 0; i < loop.load_count; i++) {
+      const typename IdleLoop::Load& load = loop.loads[i];
+
+      if((load.base >= 0 && (written & (1u << load.base))) || (load.index >= 0 && (written & (1u << load.index)))) {
+        return false;
+      }
+    }
+
+    loop.length = (int)((branch_address - target) >> (thumb ? 1 : 2)) + 1;
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::DetectIdleLoop(u32 branch_address, u32 target, bool thumb) {
+    IdleLoop* loop = GetIdleLoop(branch_address, target, thumb);
+
+    if(loop == nullptr) {
+      return;
+    }
+
+    const u64 timestamp = m_cycle_counter.GetDeviceTimestampNow();
+
+    // The previous iteration must have run without interruption (i.e. an exception) and must not have changed any state.
+    bool idle = timestamp > loop->timestamp && timestamp - loop->timestamp == (u64)loop->length &&
+                m_state.cpsr.word == loop->cpsr &&
+                std::equal(loop->reg.begin(), loop->reg.end(), &m_state.reg[0]);
+
+    for(int i = 0; idle && i < loop->load_count; i++) {
+      const typename IdleLoop::Load& load = loop->loads[i];
+
+      u32 address = load.offset;
+
+      if(load.base >= 0) address += m_state.reg[load.base];
+      if(load.index >= 0) address += m_state.reg[load.index];
+
+      idle = !m_memory.IsVolatile(address);
+    }
+
+    if(idle) {
+      m_idle_loop = loop;
+    } else {
+      std::copy_n(&m_state.reg[0], loop->reg.size(), loop->reg.begin());
+      loop->cpsr = m_state.cpsr.word;
+    }
+
+    loop->timestamp = timestamp;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void ARM<model, MemoryBus>::SkipIdleLoop(int cycles) {
+    const u64 cycles_until_target = m_cycle_counter.GetDeviceCyclesUntil(GetTimestampTarget());
+    const uint skipped_cycles = (uint)std::min<u64>((u64)std::max(cycles, 0), cycles_until_target);
+
+    m_cycle_counter.AddDeviceCycles(skipped_cycles);
+    m_idle_loop_skipped_cycles += skipped_cycles;
+
+    // The CPU state does not change while idling, so the next iteration may be skipped straight away.
+    m_idle_loop->timestamp += skipped_cycles;
+    m_idle_loop = nullptr;
+  }
+
+  using ARM9 = ARM<CPU::Model::ARM9, nds::arm9::MemoryBus>;
+  using ARM7 = ARM<CPU::Model::ARM7, nds::arm7::MemoryBus>;
+
+  template auto ARM9::GetIdleLoop(u32 branch_address, u32 target, bool thumb) -> IdleLoop*;
+  template void ARM9::DetectIdleLoop(u32 branch_address, u32 target, bool thumb);
+  template void ARM9::SkipIdleLoop(int cycles);
+  template auto ARM7::GetIdleLoop(u32 branch_address, u32 target, bool thumb) -> IdleLoop*;
+  template void ARM7::DetectIdleLoop(u32 branch_address, u32 target, bool thumb);
+  template void ARM7::SkipIdleLoop(int cycles);
+
+} // namespace dual::arm
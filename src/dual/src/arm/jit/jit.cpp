@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <atom/panic.hpp>
+#include <dual/nds/arm7/memory.hpp>
+#include <dual/nds/arm9/memory.hpp>
+
+#include "jit.hpp"
+
+namespace dual::arm {
+
+  template<CPU::Model model, typename MemoryBus>
+  JIT<model, MemoryBus>::JIT(
+    MemoryBus& memory,
+    Scheduler& scheduler,
+    CycleCounter& cycle_counter
+  )   : Base{memory, scheduler, cycle_counter} {
+    const auto offset_of = [this](const void* pointer) {
+      return (s32)((const u8*)pointer - (const u8*)this);
+    };
+
+    for(int i = 0; i < 16; i++) {
+      m_offsets.reg[i] = offset_of(&m_state.reg[i]);
+    }
+    m_offsets.cpsr = offset_of(&m_state.cpsr.word);
+    m_offsets.condition_table = offset_of(&m_condition_table[0][0]);
+    m_offsets.pending_cycles = offset_of(&m_pending_cycles);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::Reset() {
+    Base::Reset();
+    m_block_cache.Flush();
+    m_code_buffer_used = 0u;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::SetIdleLoopDetectionEnable(bool enable) {
+    if(enable != m_idle_loop_detection_enable) {
+      // Idle loop branches are only left to the interpreter handlers while the detection is enabled at compile time.
+      m_block_cache.Flush();
+      m_code_buffer_used = 0u;
+    }
+    Base::SetIdleLoopDetectionEnable(enable);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::Run(int cycles) {
+    if(GetWaitingForIRQ()) {
+      m_cycle_counter.AddDeviceCycles((uint)cycles);
+      m_halted_cycles += (uint)cycles;
+      return;
+    }
+
+    while(cycles > 0 && m_cycle_counter.GetTimestampNow() < GetTimestampTarget()) {
+      if(GetIRQFlag()) {
+        SignalIRQ();
+      }
+
+      const bool thumb = m_state.cpsr.thumb;
+      u32 address;
+
+      if(thumb) {
+        m_state.r15 &= ~1;
+        address = m_state.r15 - 4;
+      } else {
+        m_state.r15 &= ~3;
+        address = m_state.r15 - 8;
+      }
+
+      if(Block* block = GetBlock(address, thumb); block) [[likely]] {
+        const u64 cycles_until_target = m_cycle_counter.GetDeviceCyclesUntil(GetTimestampTarget());
+        const int budget = (int)std::min<u64>((u64)cycles, cycles_until_target);
+
+        m_pending_cycles = 0;
+        m_current_block = block;
+        cycles -= block->function(this, budget);
+        m_cycle_counter.AddDeviceCycles((uint)m_pending_cycles);
+      } else {
+        StepUncached(address, thumb);
+        cycles--;
+      }
+
+      if(GetWaitingForIRQ()) {
+        m_cycle_counter.AddDeviceCycles(cycles);
+        m_halted_cycles += (uint)cycles;
+        return;
+      }
+
+      if(m_idle_loop) [[unlikely]] {
+        SkipIdleLoop(cycles);
+        return;
+      }
+    }
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  auto JIT<model, MemoryBus>::GetBlock(u32 address, bool thumb) -> Block* {
+    const u32 key = BlockCache<Block>::GetKey(address, thumb);
+
+    if(Block* block = m_block_cache.Get(key); block) [[likely]] {
+      return block;
+    }
+
+    const u32* version = m_memory.GetCodePageVersion(address);
+
+    // Code outside of cacheable memory (i.e. MMIO or VRAM) is interpreted.
+    if(version == nullptr) {
+      return nullptr;
+    }
+
+    Block* block = &m_block_cache.Insert(key, version);
+
+    // Start from scratch once the code buffer is exhausted.
+    if(!Compile(*block, address, thumb)) {
+      m_block_cache.Flush();
+      m_code_buffer_used = 0u;
+
+      block = &m_block_cache.Insert(key, version);
+
+      if(!Compile(*block, address, thumb)) {
+        ATOM_PANIC("failed to compile block @ 0x{:08X}", address);
+      }
+    }
+
+    return block;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::StepUncached(u32 address, bool thumb) {
+    if(thumb) {
+      const u16 opcode = ReadHalfCode(address);
+
+      Dispatch16(k_opcode_lut_16[opcode >> 5], opcode);
+    } else {
+      const u32 opcode = ReadWordCode(address);
+      const auto condition = static_cast<Condition>(opcode >> 28);
+
+      int hash = static_cast<int>(((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0x00F));
+
+      if(condition == Condition::NV) {
+        hash |= 4096;
+      }
+
+      if(EvaluateCondition(condition)) {
+        Dispatch32(k_opcode_lut_32[hash], opcode);
+      } else {
+        m_state.r15 += 4;
+      }
+    }
+
+    m_cycle_counter.AddDeviceCycles(1u);
+  }
+
+  // Returns the number of instructions the compiled code may still execute before it has to return to Run().
+  // Only the interpreter handlers access memory, so a store into the code page of the running block is caught here.
+  template<CPU::Model model, typename MemoryBus>
+  int JIT<model, MemoryBus>::GetBudget(u32 next_r15, int budget) {
+    if(m_state.r15 != next_r15 || m_wait_for_irq || (m_irq_line && !m_state.cpsr.mask_irq) || !m_current_block->IsValid()) {
+      return 0;
+    }
+
+    const u64 cycles_until_target = m_cycle_counter.GetDeviceCyclesUntil(GetTimestampTarget());
+
+    return (int)std::min<u64>((u64)(budget - 1), cycles_until_target);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  int JIT<model, MemoryBus>::CallHandler16(JIT* jit, const Instruction* instruction, int pending_cycles, int budget) {
+    jit->m_cycle_counter.AddDeviceCycles((uint)pending_cycles);
+
+    const u32 next_r15 = jit->m_state.r15 + 2;
+    jit->Dispatch16(instruction->handler16, (u16)instruction->opcode);
+    jit->m_cycle_counter.AddDeviceCycles(1u);
+
+    return jit->GetBudget(next_r15, budget);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  int JIT<model, MemoryBus>::CallHandler32(JIT* jit, const Instruction* instruction, int pending_cycles, int budget) {
+    jit->m_cycle_counter.AddDeviceCycles((uint)pending_cycles);
+
+    const u32 next_r15 = jit->m_state.r15 + 4;
+    jit->Dispatch32(instruction->handler32, instruction->opcode);
+    jit->m_cycle_counter.AddDeviceCycles(1u);
+
+    return jit->GetBudget(next_r15, budget);
+  }
+
+  template class JIT<CPU::Model::ARM9, nds::arm9::MemoryBus>;
+  template class JIT<CPU::Model::ARM7, nds::arm7::MemoryBus>;
+
+} // namespace dual::arm
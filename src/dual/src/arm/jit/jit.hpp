@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+
+#include "arm/arm.hpp"
+#include "arm/block_cache.hpp"
+#include "arm/jit/x64/code_buffer.hpp"
+#include "arm/jit/x64/emitter.hpp"
+
+namespace dual::arm {
+
+  /**
+   * Dynamic recompiler which translates guest basic blocks to x86-64 host code.
+   * Simple data processing instructions and branches are translated to native code,
+   * everything else calls into the interpreter handlers from the generated code.
+   * Timing, interrupt and halt behaviour matches the interpreter exactly.
+   */
+  template<CPU::Model model, typename MemoryBus>
+  class JIT final : public ARM<model, MemoryBus> {
+    public:
+      JIT(
+        MemoryBus& memory,
+        Scheduler& scheduler,
+        CycleCounter& cycle_counter
+      );
+
+      void Reset() override;
+      void Run(int cycles) override;
+      void SetIdleLoopDetectionEnable(bool enable) override;
+
+    private:
+      using Base = ARM<model, MemoryBus>;
+      using typename Base::Condition;
+      using typename Base::Handler16;
+      using typename Base::Handler32;
+      using Base::m_memory;
+      using Base::GetTimestampTarget;
+      using Base::m_cycle_counter;
+      using Base::m_irq_line;
+      using Base::m_wait_for_irq;
+      using Base::m_state;
+      using Base::m_condition_table;
+      using Base::m_halted_cycles;
+      using Base::m_idle_loop;
+      using Base::m_idle_loop_detection_enable;
+      using Base::k_opcode_lut_16;
+      using Base::k_opcode_lut_32;
+      using Base::GetWaitingForIRQ;
+      using Base::GetIRQFlag;
+      using Base::SignalIRQ;
+      using Base::GetIdleLoop;
+      using Base::IsIdleLoopBranch;
+      using Base::SkipIdleLoop;
+      using Base::EvaluateCondition;
+      using Base::Dispatch16;
+      using Base::Dispatch32;
+      using Base::ReadHalfCode;
+      using Base::ReadWordCode;
+
+      static constexpr int k_max_block_length = 32;
+      static constexpr size_t k_code_buffer_size = 32u * 1024u * 1024u;
+
+      // Signature of compiled blocks: returns the number of executed instructions.
+      using Function = int (*)(JIT* jit, int budget);
+
+      struct Instruction {
+        union {
+          Handler16 handler16;
+          Handler32 handler32;
+        };
+        u32 opcode;
+      };
+
+      struct Block : BlockBase {
+        Function function{};
+        std::vector<Instruction> instructions{};
+      };
+
+      struct Offsets {
+        s32 reg[16];
+        s32 cpsr;
+        s32 condition_table;
+        s32 pending_cycles;
+      };
+
+      using Label = x64::Emitter::Label;
+
+      Block* GetBlock(u32 address, bool thumb);
+      void StepUncached(u32 address, bool thumb);
+
+      bool Compile(Block& block, u32 address, bool thumb);
+      void CompileCall(x64::Emitter& code, Label& label_exit, Block& block, const Instruction& instruction, bool thumb);
+      void CompileRetire(x64::Emitter& code, Label& label_exit);
+      void CompileCondition(x64::Emitter& code, Condition condition, Label& label_false);
+      void CompileSetR15(x64::Emitter& code, u32 value);
+
+      bool CompileNativeARM(x64::Emitter& code, u32 address, u32 instruction);
+      bool CompileDataProcessingARM(x64::Emitter& code, u32 address, u32 instruction);
+      bool CompileBranchARM(x64::Emitter& code, u32 address, u32 instruction);
+      bool CompileNativeThumb(x64::Emitter& code, u32 address, u16 instruction);
+      bool CompileShiftThumb(x64::Emitter& code, u32 address, u16 instruction);
+      bool CompileAddSubThumb(x64::Emitter& code, u32 address, u16 instruction);
+      bool CompileImmediateThumb(x64::Emitter& code, u32 address, u16 instruction);
+      bool CompileALUThumb(x64::Emitter& code, u32 address, u16 instruction);
+      bool CompileHighRegisterThumb(x64::Emitter& code, u32 address, u16 instruction);
+      bool CompileBranchThumb(x64::Emitter& code, u32 address, u16 instruction);
+
+      void CompileFlagsNZ(x64::Emitter& code, int carry = -1);
+      void CompileFlagsNZC(x64::Emitter& code);
+      void CompileFlagsNZCV(x64::Emitter& code, bool subtract);
+
+      int GetBudget(u32 next_r15, int budget);
+
+      static int CallHandler16(JIT* jit, const Instruction* instruction, int pending_cycles, int budget);
+      static int CallHandler32(JIT* jit, const Instruction* instruction, int pending_cycles, int budget);
+
+      x64::CodeBuffer m_code_buffer{k_code_buffer_size};
+      size_t m_code_buffer_used = 0u;
+
+      BlockCache<Block> m_block_cache{};
+      const Block* m_current_block{}; //< Block which is being executed
+      Offsets m_offsets{};
+      int m_pending_cycles = 0;
+  };
+
+} // namespace dual::arm
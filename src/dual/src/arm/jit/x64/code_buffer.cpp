@@ -0,0 +1,39 @@
+#include <atom/panic.hpp>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+#endif
+
+#include "code_buffer.hpp"
+
+namespace dual::arm::x64 {
+
+  CodeBuffer::CodeBuffer(size_t capacity) : m_capacity{capacity} {
+#ifdef _WIN32
+    m_data = (u8*)VirtualAlloc(nullptr, capacity, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+
+    if(m_data == nullptr) {
+      ATOM_PANIC("failed to allocate {} bytes of executable memory", capacity);
+    }
+#else
+    void* data = mmap(nullptr, capacity, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if(data == MAP_FAILED) {
+      ATOM_PANIC("failed to allocate {} bytes of executable memory", capacity);
+    }
+
+    m_data = (u8*)data;
+#endif
+  }
+
+  CodeBuffer::~CodeBuffer() {
+#ifdef _WIN32
+    VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+    munmap(m_data, m_capacity);
+#endif
+  }
+
+} // namespace dual::arm::x64
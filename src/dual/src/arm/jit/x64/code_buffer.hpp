@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atom/integer.hpp>
+
+namespace dual::arm::x64 {
+
+  // Block of host memory which is writable and executable at the same time.
+  class CodeBuffer {
+    public:
+      explicit CodeBuffer(size_t capacity);
+     ~CodeBuffer();
+
+      CodeBuffer(const CodeBuffer&) = delete;
+      CodeBuffer& operator=(const CodeBuffer&) = delete;
+
+      u8* GetData() {
+        return m_data;
+      }
+
+      size_t GetCapacity() const {
+        return m_capacity;
+      }
+
+    private:
+      u8* m_data;
+      size_t m_capacity;
+  };
+
+} // namespace dual::arm::x64
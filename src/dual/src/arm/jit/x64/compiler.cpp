@@ -0,0 +1,630 @@
+#include <dual/nds/arm7/memory.hpp>
+#include <dual/nds/arm9/memory.hpp>
+
+#include "arm/jit/jit.hpp"
+
+namespace dual::arm {
+
+  using namespace x64;
+
+  /**
+   * Register allocation inside of compiled blocks:
+   *   RBX: pointer to the JIT instance
+   *   R12: cycles of natively executed instructions not yet added to the cycle counter
+   *   R13: number of instructions the block may still execute (budget)
+   *   R14: number of executed instructions
+   * RAX, RCX, RDX, R8 and R9 are used as temporaries.
+   */
+#ifdef _WIN32
+  static constexpr Reg k_arg[4] { Reg::RCX, Reg::RDX, Reg::R8, Reg::R9 };
+  static constexpr u8 k_stack_adjust = 40u; // Shadow space plus alignment
+#else
+  static constexpr Reg k_arg[4] { Reg::RDI, Reg::RSI, Reg::RDX, Reg::RCX };
+  static constexpr u8 k_stack_adjust = 8u;
+#endif
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::Compile(Block& block, u32 address, bool thumb) {
+    constexpr u32 page_mask = (1u << Memory::k_code_page_shift) - 1u;
+
+    const u32 page_end = (address | page_mask) + 1u;
+
+    Emitter code{m_code_buffer.GetData() + m_code_buffer_used, m_code_buffer.GetCapacity() - m_code_buffer_used};
+    Label label_exit{};
+
+    // Handler pointers are passed to the thunks, so the vector must never reallocate.
+    block.instructions.clear();
+    block.instructions.reserve(k_max_block_length);
+
+    code.PUSH(Reg::RBX);
+    code.PUSH(Reg::R12);
+    code.PUSH(Reg::R13);
+    code.PUSH(Reg::R14);
+    code.SUB64(Reg::RSP, k_stack_adjust);
+    code.MOV64(Reg::RBX, k_arg[0]);
+    code.MOV(Reg::R13, k_arg[1]);
+    code.MOV(Reg::R12, 0u);
+    code.MOV(Reg::R14, 0u);
+
+    for(int i = 0; i < k_max_block_length && address != page_end; i++) {
+      bool block_end;
+
+      if(thumb) {
+        const u16 opcode = ReadHalfCode(address);
+
+        block_end = EndsBlock16(opcode);
+
+        if(CompileNativeThumb(code, address, opcode)) {
+          CompileRetire(code, label_exit);
+        } else {
+          Instruction instruction{};
+          instruction.handler16 = k_opcode_lut_16[opcode >> 5];
+          instruction.opcode = opcode;
+          CompileCall(code, label_exit, block, instruction, true);
+        }
+
+        address += 2u;
+      } else {
+        const u32 opcode = ReadWordCode(address);
+        const auto condition = static_cast<Condition>(opcode >> 28);
+        const bool conditional = condition != Condition::AL && condition != Condition::NV;
+
+        Label label_skip{};
+        Label label_done{};
+
+        block_end = EndsBlock32(opcode);
+
+        if(conditional) {
+          CompileCondition(code, condition, label_skip);
+        }
+
+        if(CompileNativeARM(code, address, opcode)) {
+          CompileRetire(code, label_exit);
+        } else {
+          int hash = static_cast<int>(((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0x00F));
+
+          if(condition == Condition::NV) {
+            hash |= 4096;
+          }
+
+          Instruction instruction{};
+          instruction.handler32 = k_opcode_lut_32[hash];
+          instruction.opcode = opcode;
+          CompileCall(code, label_exit, block, instruction, false);
+        }
+
+        if(conditional) {
+          code.JMP(label_done);
+          code.Bind(label_skip);
+          CompileSetR15(code, address + 12u);
+          CompileRetire(code, label_exit);
+          code.Bind(label_done);
+        }
+
+        address += 4u;
+      }
+
+      if(block_end) {
+        break;
+      }
+    }
+
+    code.Bind(label_exit);
+    code.MOV(Mem{Reg::RBX, m_offsets.pending_cycles}, Reg::R12);
+    code.MOV(Reg::RAX, Reg::R14);
+    code.ADD64(Reg::RSP, k_stack_adjust);
+    code.POP(Reg::R14);
+    code.POP(Reg::R13);
+    code.POP(Reg::R12);
+    code.POP(Reg::RBX);
+    code.RET();
+
+    if(code.Overflowed()) {
+      return false;
+    }
+
+    block.function = (Function)(m_code_buffer.GetData() + m_code_buffer_used);
+    m_code_buffer_used += code.GetSize();
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::CompileCall(Emitter& code, Label& label_exit, Block& block, const Instruction& instruction, bool thumb) {
+    block.instructions.push_back(instruction);
+
+    code.MOV64(k_arg[0], Reg::RBX);
+    code.MOV64(k_arg[1], (u64)(uintptr_t)&block.instructions.back());
+    code.MOV(k_arg[2], Reg::R12);
+    code.MOV(k_arg[3], Reg::R13);
+
+    if(thumb) {
+      code.CALL(reinterpret_cast<const void*>(&CallHandler16));
+    } else {
+      code.CALL(reinterpret_cast<const void*>(&CallHandler32));
+    }
+
+    // The thunk has flushed the pending cycles and returns the remaining budget.
+    code.MOV(Reg::R12, 0u);
+    code.INC(Reg::R14);
+    code.MOV(Reg::R13, Reg::RAX);
+    code.TEST(Reg::RAX, Reg::RAX);
+    code.Jcc(x64::Condition::Z, label_exit);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::CompileRetire(Emitter& code, Label& label_exit) {
+    code.INC(Reg::R12);
+    code.INC(Reg::R14);
+    code.DEC(Reg::R13);
+    code.Jcc(x64::Condition::Z, label_exit);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::CompileCondition(Emitter& code, Condition condition, Label& label_false) {
+    code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.cpsr});
+    code.SHR(Reg::RAX, 28);
+    code.CMP8(Mem{Reg::RBX, Reg::RAX, m_offsets.condition_table + (int)condition * 16}, 0u);
+    code.Jcc(x64::Condition::Z, label_false);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::CompileSetR15(Emitter& code, u32 value) {
+    code.MOV(Mem{Reg::RBX, m_offsets.reg[15]}, value);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileNativeARM(Emitter& code, u32 address, u32 instruction) {
+    if((instruction >> 28) == (u32)Condition::NV) {
+      return false;
+    }
+
+    if((instruction & 0x0C000000u) == 0u) {
+      return CompileDataProcessingARM(code, address, instruction);
+    }
+
+    if((instruction & 0x0E000000u) == 0x0A000000u) {
+      return CompileBranchARM(code, address, instruction);
+    }
+
+    return false;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileDataProcessingARM(Emitter& code, u32 address, u32 instruction) {
+    enum Opcode { AND, EOR, SUB, RSB, ADD, ADC, SBC, RSC, TST, TEQ, CMP, CMN, ORR, MOV, BIC, MVN };
+
+    const bool immediate = instruction & (1u << 25);
+    const bool set_flags = instruction & (1u << 20);
+    const int opcode = (int)((instruction >> 21) & 15u);
+    const int reg_n = (int)((instruction >> 16) & 15u);
+    const int reg_d = (int)((instruction >> 12) & 15u);
+
+    const bool compare = opcode >= TST && opcode <= CMN;
+    const bool logical = opcode == AND || opcode == EOR || opcode == ORR || opcode == MOV ||
+                         opcode == BIC || opcode == MVN || opcode == TST || opcode == TEQ;
+
+    // Register specified shifts, multiplies and the extra load/store encodings
+    if(!immediate && (instruction & 0x10u)) {
+      return false;
+    }
+
+    // MRS, MSR, BX and friends
+    if(compare && !set_flags) {
+      return false;
+    }
+
+    if(opcode == ADC || opcode == SBC || opcode == RSC) {
+      return false;
+    }
+
+    if((!compare && reg_d == 15) || (opcode != MOV && opcode != MVN && reg_n == 15)) {
+      return false;
+    }
+
+    // Shifter carry: -1 = unchanged, otherwise a compile-time constant
+    int carry = -1;
+
+    if(immediate) {
+      const u32 value = instruction & 0xFFu;
+      const int shift = (int)((instruction >> 8) & 15u) * 2;
+
+      if(shift != 0) {
+        code.MOV(Reg::RCX, (value >> shift) | (value << (32 - shift)));
+        carry = (int)((value >> (shift - 1)) & 1u);
+      } else {
+        code.MOV(Reg::RCX, value);
+      }
+    } else {
+      const int reg_m = (int)(instruction & 15u);
+      const int shift_type = (int)((instruction >> 5) & 3u);
+      const int shift = (int)((instruction >> 7) & 31u);
+
+      if(reg_m == 15) {
+        return false;
+      }
+
+      // Shifts which produce a carry out are only emitted for the arithmetic operations, which ignore it.
+      if(shift_type == 0 && shift == 0) {
+        code.MOV(Reg::RCX, Mem{Reg::RBX, m_offsets.reg[reg_m]});
+      } else {
+        // Immediate LSR, ASR or ROR by zero encode special cases (LSR #32, ASR #32, RRX)
+        if((shift_type != 0 && shift == 0) || (logical && set_flags)) {
+          return false;
+        }
+
+        code.MOV(Reg::RCX, Mem{Reg::RBX, m_offsets.reg[reg_m]});
+
+        switch(shift_type) {
+          case 0: code.SHL(Reg::RCX, (u8)shift); break;
+          case 1: code.SHR(Reg::RCX, (u8)shift); break;
+          case 2: code.SAR(Reg::RCX, (u8)shift); break;
+          case 3: code.ROR(Reg::RCX, (u8)shift); break;
+        }
+      }
+    }
+
+    if(opcode != MOV && opcode != MVN) {
+      code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.reg[reg_n]});
+    }
+
+    switch(opcode) {
+      case AND:
+      case TST: code.AND(Reg::RAX, Reg::RCX); break;
+      case EOR:
+      case TEQ: code.XOR(Reg::RAX, Reg::RCX); break;
+      case SUB:
+      case CMP: code.SUB(Reg::RAX, Reg::RCX); break;
+      case RSB: code.SUB(Reg::RCX, Reg::RAX); code.MOV(Reg::RAX, Reg::RCX); break;
+      case ADD:
+      case CMN: code.ADD(Reg::RAX, Reg::RCX); break;
+      case ORR: code.OR(Reg::RAX, Reg::RCX); break;
+      case MOV: code.MOV(Reg::RAX, Reg::RCX); break;
+      case BIC: code.NOT(Reg::RCX); code.AND(Reg::RAX, Reg::RCX); break;
+      case MVN: code.NOT(Reg::RCX); code.MOV(Reg::RAX, Reg::RCX); break;
+    }
+
+    if(!compare) {
+      code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, Reg::RAX);
+    }
+
+    if(set_flags) {
+      if(logical) {
+        // MOV and NOT do not update the host flags.
+        if(opcode == MOV || opcode == MVN) {
+          code.TEST(Reg::RAX, Reg::RAX);
+        }
+        CompileFlagsNZ(code, carry);
+      } else {
+        CompileFlagsNZCV(code, opcode == SUB || opcode == RSB || opcode == CMP);
+      }
+    }
+
+    CompileSetR15(code, address + 12u);
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileBranchARM(Emitter& code, u32 address, u32 instruction) {
+    const bool link = instruction & (1u << 24);
+    const u32 offset = (u32)(((s32)(instruction << 8)) >> 6);
+    const u32 target = address + 8u + offset;
+
+    // Leave branches which close side-effect free loops to the interpreter handler, which detects idle loops.
+    if(!link && m_idle_loop_detection_enable && IsIdleLoopBranch(address, target, false) && GetIdleLoop(address, target, false)) {
+      return false;
+    }
+
+    if(link) {
+      code.MOV(Mem{Reg::RBX, m_offsets.reg[14]}, address + 4u);
+    }
+
+    CompileSetR15(code, target + 8u);
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileNativeThumb(Emitter& code, u32 address, u16 instruction) {
+    if((instruction & 0xF800u) == 0x1800u) return CompileAddSubThumb(code, address, instruction);
+    if((instruction & 0xE000u) == 0x0000u) return CompileShiftThumb(code, address, instruction);
+    if((instruction & 0xE000u) == 0x2000u) return CompileImmediateThumb(code, address, instruction);
+    if((instruction & 0xFC00u) == 0x4000u) return CompileALUThumb(code, address, instruction);
+    if((instruction & 0xFC00u) == 0x4400u) return CompileHighRegisterThumb(code, address, instruction);
+    if((instruction & 0xF000u) == 0xD000u) return CompileBranchThumb(code, address, instruction);
+    if((instruction & 0xF800u) == 0xE000u) return CompileBranchThumb(code, address, instruction);
+
+    return false;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileShiftThumb(Emitter& code, u32 address, u16 instruction) {
+    const int opcode = (instruction >> 11) & 3;
+    const int shift = (instruction >> 6) & 31;
+    const int reg_s = (instruction >> 3) & 7;
+    const int reg_d = instruction & 7;
+
+    // LSR #32 and ASR #32
+    if(opcode != 0 && shift == 0) {
+      return false;
+    }
+
+    code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.reg[reg_s]});
+
+    if(shift == 0) {
+      code.TEST(Reg::RAX, Reg::RAX);
+      code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, Reg::RAX);
+      CompileFlagsNZ(code);
+    } else {
+      switch(opcode) {
+        case 0: code.SHL(Reg::RAX, (u8)shift); break;
+        case 1: code.SHR(Reg::RAX, (u8)shift); break;
+        case 2: code.SAR(Reg::RAX, (u8)shift); break;
+      }
+      code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, Reg::RAX);
+      CompileFlagsNZC(code);
+    }
+
+    CompileSetR15(code, address + 6u);
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileAddSubThumb(Emitter& code, u32 address, u16 instruction) {
+    const bool immediate = instruction & (1u << 10);
+    const bool subtract = instruction & (1u << 9);
+    const int field = (instruction >> 6) & 7;
+    const int reg_s = (instruction >> 3) & 7;
+    const int reg_d = instruction & 7;
+
+    if(immediate) {
+      code.MOV(Reg::RCX, (u32)field);
+    } else {
+      code.MOV(Reg::RCX, Mem{Reg::RBX, m_offsets.reg[field]});
+    }
+
+    code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.reg[reg_s]});
+
+    if(subtract) {
+      code.SUB(Reg::RAX, Reg::RCX);
+    } else {
+      code.ADD(Reg::RAX, Reg::RCX);
+    }
+
+    code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, Reg::RAX);
+    CompileFlagsNZCV(code, subtract);
+    CompileSetR15(code, address + 6u);
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileImmediateThumb(Emitter& code, u32 address, u16 instruction) {
+    const int opcode = (instruction >> 11) & 3;
+    const int reg_d = (instruction >> 8) & 7;
+    const u32 imm = instruction & 0xFFu;
+
+    if(opcode == 0) {
+      // MOV: N is always clear and Z is known at compile time.
+      code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, imm);
+      code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.cpsr});
+      code.AND(Reg::RAX, 0x3FFFFFFFu);
+      if(imm == 0u) {
+        code.OR(Reg::RAX, 1u << 30);
+      }
+      code.MOV(Mem{Reg::RBX, m_offsets.cpsr}, Reg::RAX);
+    } else {
+      code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.reg[reg_d]});
+
+      switch(opcode) {
+        case 1: code.CMP(Reg::RAX, imm); break;
+        case 2: code.ADD(Reg::RAX, imm); break;
+        case 3: code.SUB(Reg::RAX, imm); break;
+      }
+
+      if(opcode != 1) {
+        code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, Reg::RAX);
+      }
+      CompileFlagsNZCV(code, opcode != 2);
+    }
+
+    CompileSetR15(code, address + 6u);
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileALUThumb(Emitter& code, u32 address, u16 instruction) {
+    enum Opcode { AND, EOR, LSL, LSR, ASR, ADC, SBC, ROR, TST, NEG, CMP, CMN, ORR, MUL, BIC, MVN };
+
+    const int opcode = (instruction >> 6) & 15;
+    const int reg_s = (instruction >> 3) & 7;
+    const int reg_d = instruction & 7;
+
+    switch(opcode) {
+      case LSL: case LSR: case ASR: case ADC: case SBC: case ROR: case MUL: {
+        return false;
+      }
+    }
+
+    code.MOV(Reg::RCX, Mem{Reg::RBX, m_offsets.reg[reg_s]});
+
+    if(opcode == NEG) {
+      code.MOV(Reg::RAX, 0u);
+    } else if(opcode != MVN) {
+      code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.reg[reg_d]});
+    }
+
+    switch(opcode) {
+      case AND:
+      case TST: code.AND(Reg::RAX, Reg::RCX); break;
+      case EOR: code.XOR(Reg::RAX, Reg::RCX); break;
+      case NEG:
+      case CMP: code.SUB(Reg::RAX, Reg::RCX); break;
+      case CMN: code.ADD(Reg::RAX, Reg::RCX); break;
+      case ORR: code.OR(Reg::RAX, Reg::RCX); break;
+      case BIC: code.NOT(Reg::RCX); code.AND(Reg::RAX, Reg::RCX); break;
+      case MVN: code.NOT(Reg::RCX); code.MOV(Reg::RAX, Reg::RCX); code.TEST(Reg::RAX, Reg::RAX); break;
+    }
+
+    if(opcode != TST && opcode != CMP && opcode != CMN) {
+      code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, Reg::RAX);
+    }
+
+    if(opcode == NEG || opcode == CMP || opcode == CMN) {
+      CompileFlagsNZCV(code, opcode != CMN);
+    } else {
+      CompileFlagsNZ(code);
+    }
+
+    CompileSetR15(code, address + 6u);
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileHighRegisterThumb(Emitter& code, u32 address, u16 instruction) {
+    const int opcode = (instruction >> 8) & 3;
+    const int reg_s = ((instruction >> 3) & 7) | ((instruction >> 3) & 8);
+    const int reg_d = (instruction & 7) | ((instruction >> 4) & 8);
+
+    // BX/BLX and anything involving R15
+    if(opcode == 3 || reg_s == 15 || reg_d == 15) {
+      return false;
+    }
+
+    code.MOV(Reg::RCX, Mem{Reg::RBX, m_offsets.reg[reg_s]});
+
+    switch(opcode) {
+      case 0: {
+        code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.reg[reg_d]});
+        code.ADD(Reg::RAX, Reg::RCX);
+        code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, Reg::RAX);
+        break;
+      }
+      case 1: {
+        code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.reg[reg_d]});
+        code.CMP(Reg::RAX, Reg::RCX);
+        CompileFlagsNZCV(code, true);
+        break;
+      }
+      case 2: {
+        code.MOV(Mem{Reg::RBX, m_offsets.reg[reg_d]}, Reg::RCX);
+        break;
+      }
+    }
+
+    CompileSetR15(code, address + 6u);
+    return true;
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  bool JIT<model, MemoryBus>::CompileBranchThumb(Emitter& code, u32 address, u16 instruction) {
+    // Unconditional branch
+    if((instruction & 0xF800u) == 0xE000u) {
+      const u32 offset = (u32)(((s32)((u32)instruction << 21)) >> 20);
+      const u32 target = address + 4u + offset;
+
+      if(m_idle_loop_detection_enable && IsIdleLoopBranch(address, target, true) && GetIdleLoop(address, target, true)) {
+        return false;
+      }
+
+      CompileSetR15(code, target + 4u);
+      return true;
+    }
+
+    const auto condition = static_cast<Condition>((instruction >> 8) & 15);
+
+    // Undefined and SWI
+    if(condition == Condition::AL || condition == Condition::NV) {
+      return false;
+    }
+
+    const u32 offset = (u32)(((s32)((u32)instruction << 24)) >> 23);
+    const u32 target = address + 4u + offset;
+
+    if(m_idle_loop_detection_enable && IsIdleLoopBranch(address, target, true) && GetIdleLoop(address, target, true)) {
+      return false;
+    }
+
+    Label label_not_taken{};
+    Label label_done{};
+
+    CompileCondition(code, condition, label_not_taken);
+    CompileSetR15(code, target + 4u);
+    code.JMP(label_done);
+    code.Bind(label_not_taken);
+    CompileSetR15(code, address + 6u);
+    code.Bind(label_done);
+    return true;
+  }
+
+  // Updates N and Z from the host flags and optionally C from a compile-time constant.
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::CompileFlagsNZ(Emitter& code, int carry) {
+    u32 mask = 0x3FFFFFFFu;
+    u32 bits = 0u;
+
+    if(carry != -1) {
+      mask = 0x1FFFFFFFu;
+      bits = (u32)carry << 29;
+    }
+
+    code.SETCC(x64::Condition::S, Reg::RCX);
+    code.SETCC(x64::Condition::Z, Reg::RDX);
+    code.MOVZX8(Reg::RCX, Reg::RCX);
+    code.MOVZX8(Reg::RDX, Reg::RDX);
+    code.SHL(Reg::RCX, 31);
+    code.SHL(Reg::RDX, 30);
+    code.OR(Reg::RCX, Reg::RDX);
+    code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.cpsr});
+    code.AND(Reg::RAX, mask);
+    code.OR(Reg::RAX, Reg::RCX);
+    if(bits != 0u) {
+      code.OR(Reg::RAX, bits);
+    }
+    code.MOV(Mem{Reg::RBX, m_offsets.cpsr}, Reg::RAX);
+  }
+
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::CompileFlagsNZC(Emitter& code) {
+    code.SETCC(x64::Condition::S, Reg::RCX);
+    code.SETCC(x64::Condition::Z, Reg::RDX);
+    code.SETCC(x64::Condition::C, Reg::R8);
+    code.MOVZX8(Reg::RCX, Reg::RCX);
+    code.MOVZX8(Reg::RDX, Reg::RDX);
+    code.MOVZX8(Reg::R8, Reg::R8);
+    code.SHL(Reg::RCX, 31);
+    code.SHL(Reg::RDX, 30);
+    code.SHL(Reg::R8, 29);
+    code.OR(Reg::RCX, Reg::RDX);
+    code.OR(Reg::RCX, Reg::R8);
+    code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.cpsr});
+    code.AND(Reg::RAX, 0x1FFFFFFFu);
+    code.OR(Reg::RAX, Reg::RCX);
+    code.MOV(Mem{Reg::RBX, m_offsets.cpsr}, Reg::RAX);
+  }
+
+  // ARM uses an inverted carry (NOT borrow) for subtraction.
+  template<CPU::Model model, typename MemoryBus>
+  void JIT<model, MemoryBus>::CompileFlagsNZCV(Emitter& code, bool subtract) {
+    code.SETCC(x64::Condition::S, Reg::RCX);
+    code.SETCC(x64::Condition::Z, Reg::RDX);
+    code.SETCC(subtract ? x64::Condition::NC : x64::Condition::C, Reg::R8);
+    code.SETCC(x64::Condition::O, Reg::R9);
+    code.MOVZX8(Reg::RCX, Reg::RCX);
+    code.MOVZX8(Reg::RDX, Reg::RDX);
+    code.MOVZX8(Reg::R8, Reg::R8);
+    code.MOVZX8(Reg::R9, Reg::R9);
+    code.SHL(Reg::RCX, 31);
+    code.SHL(Reg::RDX, 30);
+    code.SHL(Reg::R8, 29);
+    code.SHL(Reg::R9, 28);
+    code.OR(Reg::RCX, Reg::RDX);
+    code.OR(Reg::RCX, Reg::R8);
+    code.OR(Reg::RCX, Reg::R9);
+    code.MOV(Reg::RAX, Mem{Reg::RBX, m_offsets.cpsr});
+    code.AND(Reg::RAX, 0x0FFFFFFFu);
+    code.OR(Reg::RAX, Reg::RCX);
+    code.MOV(Mem{Reg::RBX, m_offsets.cpsr}, Reg::RAX);
+  }
+
+  template bool JIT<CPU::Model::ARM9, nds::arm9::MemoryBus>::Compile(Block& block, u32 address, bool thumb);
+  template bool JIT<CPU::Model::ARM7, nds::arm7::MemoryBus>::Compile(Block& block, u32 address, bool thumb);
+
+} // namespace dual::arm
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <atom/integer.hpp>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace dual::arm::x64 {
+
+  enum class Reg : u8 {
+    RAX = 0,
+    RCX = 1,
+    RDX = 2,
+    RBX = 3,
+    RSP = 4,
+    RBP = 5,
+    RSI = 6,
+    RDI = 7,
+    R8  = 8,
+    R9  = 9,
+    R10 = 10,
+    R11 = 11,
+    R12 = 12,
+    R13 = 13,
+    R14 = 14,
+    R15 = 15
+  };
+
+  enum class Condition : u8 {
+    O  = 0x0,
+    NO = 0x1,
+    C  = 0x2,
+    NC = 0x3,
+    Z  = 0x4,
+    NZ = 0x5,
+    BE = 0x6,
+    A  = 0x7,
+    S  = 0x8,
+    NS = 0x9,
+    L  = 0xC,
+    GE = 0xD,
+    LE = 0xE,
+    G  = 0xF
+  };
+
+  // Memory operand of the form [base + index + displacement]
+  struct Mem {
+    Mem(Reg base, s32 displacement) : base{base}, displacement{displacement} {}
+    Mem(Reg base, Reg index, s32 displacement) : base{base}, index{index}, has_index{true}, displacement{displacement} {}
+
+    Reg base;
+    Reg index{};
+    bool has_index{};
+    s32 displacement;
+  };
+
+  /**
+   * Minimal x86-64 machine code emitter supporting just the instructions needed by the JIT.
+   * All ALU operations work on 32-bit registers unless noted otherwise.
+   * Once the buffer is full, further code is dropped and Overflowed() returns true.
+   */
+  class Emitter {
+    public:
+      struct Label {
+        size_t position = 0;
+        bool bound = false;
+        std::vector<size_t> fixups{};
+      };
+
+      Emitter(u8* buffer, size_t capacity) : m_buffer{buffer}, m_capacity{capacity} {}
+
+      size_t GetSize() const {
+        return m_size;
+      }
+
+      bool Overflowed() const {
+        return m_overflow;
+      }
+
+      void Bind(Label& label) {
+        label.position = m_size;
+        label.bound = true;
+
+        for(size_t fixup : label.fixups) {
+          Patch32(fixup, (u32)(m_size - (fixup + 4)));
+        }
+        label.fixups.clear();
+      }
+
+      // ALU operations (opcode extensions of the 0x81 group and the matching /r opcodes)
+      void ADD(Reg dst, Reg src) { RR(0x01, src, dst); }
+      void OR (Reg dst, Reg src) { RR(0x09, src, dst); }
+      void AND(Reg dst, Reg src) { RR(0x21, src, dst); }
+      void SUB(Reg dst, Reg src) { RR(0x29, src, dst); }
+      void XOR(Reg dst, Reg src) { RR(0x31, src, dst); }
+      void CMP(Reg dst, Reg src) { RR(0x39, src, dst); }
+      void TEST(Reg dst, Reg src) { RR(0x85, src, dst); }
+
+      void ADD(Reg dst, u32 imm) { RI(0, dst, imm); }
+      void OR (Reg dst, u32 imm) { RI(1, dst, imm); }
+      void AND(Reg dst, u32 imm) { RI(4, dst, imm); }
+      void SUB(Reg dst, u32 imm) { RI(5, dst, imm); }
+      void XOR(Reg dst, u32 imm) { RI(6, dst, imm); }
+      void CMP(Reg dst, u32 imm) { RI(7, dst, imm); }
+
+      void NOT(Reg reg) { Rex(false, 0, reg); Emit8(0xF7); ModRM(3, 2, reg); }
+      void NEG(Reg reg) { Rex(false, 0, reg); Emit8(0xF7); ModRM(3, 3, reg); }
+      void INC(Reg reg) { Rex(false, 0, reg); Emit8(0xFF); ModRM(3, 0, reg); }
+      void DEC(Reg reg) { Rex(false, 0, reg); Emit8(0xFF); ModRM(3, 1, reg); }
+
+      void IMUL(Reg dst, Reg src) {
+        Rex(false, (u8)dst, src);
+        Emit8(0x0F);
+        Emit8(0xAF);
+        ModRM(3, (u8)dst, src);
+      }
+
+      void ROR(Reg reg, u8 amount) { Shift(1, reg, amount); }
+      void SHL(Reg reg, u8 amount) { Shift(4, reg, amount); }
+      void SHR(Reg reg, u8 amount) { Shift(5, reg, amount); }
+      void SAR(Reg reg, u8 amount) { Shift(7, reg, amount); }
+
+      void MOV(Reg dst, Reg src) { RR(0x89, src, dst); }
+
+      void MOV(Reg dst, u32 imm) {
+        Rex(false, 0, dst);
+        Emit8(0xB8 + ((u8)dst & 7));
+        Emit32(imm);
+      }
+
+      void MOV64(Reg dst, Reg src) {
+        Rex(true, (u8)src, dst);
+        Emit8(0x89);
+        ModRM(3, (u8)src, dst);
+      }
+
+      void MOV64(Reg dst, u64 imm) {
+        Rex(true, 0, dst);
+        Emit8(0xB8 + ((u8)dst & 7));
+        Emit32((u32)imm);
+        Emit32((u32)(imm >> 32));
+      }
+
+      void MOV(Reg dst, const Mem& src) { RM(0x8B, (u8)dst, src); }
+      void MOV(const Mem& dst, Reg src) { RM(0x89, (u8)src, dst); }
+
+      void MOV(const Mem& dst, u32 imm) {
+        RM(0xC7, 0, dst);
+        Emit32(imm);
+      }
+
+      void ADD(const Mem& dst, u32 imm) {
+        RM(0x81, 0, dst);
+        Emit32(imm);
+      }
+
+      // Compares a byte in memory against an 8-bit immediate.
+      void CMP8(const Mem& dst, u8 imm) {
+        RM(0x80, 7, dst);
+        Emit8(imm);
+      }
+
+      void SETCC(Condition condition, Reg dst) {
+        // A REX prefix is needed to address SPL, BPL, SIL, DIL and R8B - R15B.
+        if((u8)dst >= 4) {
+          Emit8(0x40 | (((u8)dst >> 3) & 1));
+        }
+        Emit8(0x0F);
+        Emit8(0x90 + (u8)condition);
+        ModRM(3, 0, dst);
+      }
+
+      void MOVZX8(Reg dst, Reg src) {
+        if((u8)dst >= 8 || (u8)src >= 4) {
+          Emit8(0x40 | ((((u8)dst >> 3) & 1) << 2) | (((u8)src >> 3) & 1));
+        }
+        Emit8(0x0F);
+        Emit8(0xB6);
+        ModRM(3, (u8)dst, src);
+      }
+
+      void PUSH(Reg reg) {
+        if((u8)reg >= 8) Emit8(0x41);
+        Emit8(0x50 + ((u8)reg & 7));
+      }
+
+      void POP(Reg reg) {
+        if((u8)reg >= 8) Emit8(0x41);
+        Emit8(0x58 + ((u8)reg & 7));
+      }
+
+      void ADD64(Reg dst, u8 imm) { Rex(true, 0, dst); Emit8(0x83); ModRM(3, 0, dst); Emit8(imm); }
+      void SUB64(Reg dst, u8 imm) { Rex(true, 0, dst); Emit8(0x83); ModRM(3, 5, dst); Emit8(imm); }
+
+      void CALL(const void* function) {
+        MOV64(Reg::RAX, (u64)(uintptr_t)function);
+        Emit8(0xFF);
+        ModRM(3, 2, Reg::RAX);
+      }
+
+      void RET() {
+        Emit8(0xC3);
+      }
+
+      void JMP(Label& label) {
+        Emit8(0xE9);
+        Emit32Label(label);
+      }
+
+      void Jcc(Condition condition, Label& label) {
+        Emit8(0x0F);
+        Emit8(0x80 + (u8)condition);
+        Emit32Label(label);
+      }
+
+    private:
+      void Emit8(u8 value) {
+        if(m_size + 1 > m_capacity) {
+          m_overflow = true;
+          return;
+        }
+        m_buffer[m_size++] = value;
+      }
+
+      void Emit32(u32 value) {
+        for(int i = 0; i < 4; i++) {
+          Emit8((u8)(value >> (i * 8)));
+        }
+      }
+
+      void Emit32Label(Label& label) {
+        if(label.bound) {
+          Emit32((u32)(label.position - (m_size + 4)));
+        } else {
+          label.fixups.push_back(m_size);
+          Emit32(0u);
+        }
+      }
+
+      void Patch32(size_t position, u32 value) {
+        if(position + 4 <= m_capacity) {
+          std::memcpy(&m_buffer[position], &value, sizeof(u32));
+        }
+      }
+
+      void Rex(bool w, u8 reg, Reg rm) {
+        const u8 rex = 0x40 | (w ? 8 : 0) | (((reg >> 3) & 1) << 2) | (((u8)rm >> 3) & 1);
+
+        if(rex != 0x40) {
+          Emit8(rex);
+        }
+      }
+
+      void ModRM(u8 mod, u8 reg, Reg rm) {
+        Emit8((u8)((mod << 6) | ((reg & 7) << 3) | ((u8)rm & 7)));
+      }
+
+      void RR(u8 opcode, Reg reg, Reg rm) {
+        Rex(false, (u8)reg, rm);
+        Emit8(opcode);
+        ModRM(3, (u8)reg, rm);
+      }
+
+      void RI(u8 extension, Reg rm, u32 imm) {
+        Rex(false, 0, rm);
+        Emit8(0x81);
+        ModRM(3, extension, rm);
+        Emit32(imm);
+      }
+
+      void Shift(u8 extension, Reg rm, u8 amount) {
+        Rex(false, 0, rm);
+        Emit8(0xC1);
+        ModRM(3, extension, rm);
+        Emit8(amount);
+      }
+
+      void RM(u8 opcode, u8 reg, const Mem& mem) {
+        const u8 rex = 0x40 | (((reg >> 3) & 1) << 2) |
+                       (mem.has_index ? (((u8)mem.index >> 3) & 1) << 1 : 0) |
+                       (((u8)mem.base >> 3) & 1);
+
+        if(rex != 0x40) {
+          Emit8(rex);
+        }
+        Emit8(opcode);
+
+        // Always use a 32-bit displacement, which also avoids the special case for RBP/R13 as the base.
+        if(mem.has_index) {
+          Emit8((u8)(0x80 | ((reg & 7) << 3) | 4));
+          Emit8((u8)((((u8)mem.index & 7) << 3) | ((u8)mem.base & 7)));
+        } else {
+          Emit8((u8)(0x80 | ((reg & 7) << 3) | ((u8)mem.base & 7)));
+
+          if(((u8)mem.base & 7) == 4) {
+            Emit8(0x24); // SIB byte for RSP/R12 as the base
+          }
+        }
+        Emit32((u32)mem.displacement);
+      }
+
+      u8* m_buffer;
+      size_t m_capacity;
+      size_t m_size = 0;
+      bool m_overflow = false;
+  };
+
+} // namespace dual::arm::x64
@@ -1,20 +1,27 @@
 
 #include <atom/meta.hpp>
 
+#include <dual/nds/arm7/memory.hpp>
+#include <dual/nds/arm9/memory.hpp>
+
 #include "arm/arm.hpp"
 #include "decoder.hpp"
 
 namespace dual::arm {
 
-  using Handler16 = ARM::Handler16;
-  using Handler32 = ARM::Handler32;
-
   /** A helper class used to generate lookup tables for
     * the interpreter at compiletime.
     * The motivation is to separate the code used for generation from
     * the interpreter class and its header itself.
     */
+  template<CPU::Model model, typename MemoryBus>
   struct TableGen {
+    using ARM = arm::ARM<model, MemoryBus>;
+
+    // The generators return member pointers, which are wrapped into thunks with DUAL_ARM_STATIC_DISPATCH.
+    using Handler16 = void (ARM::*)(u16);
+    using Handler32 = void (ARM::*)(u32);
+
     #ifdef __clang__
     #pragma clang diagnostic push
     #pragma clang diagnostic ignored "-Weverything"
@@ -27,37 +34,76 @@ namespace dual::arm {
     #pragma clang diagnostic pop
     #endif
 
-    static constexpr auto GenerateTableThumb() -> std::array<Handler16, 2048> {
-      std::array<Handler16, 2048> lut = {};
+    template<Handler16 handler>
+    static void Thunk16(ARM& cpu, u16 instruction) {
+      (cpu.*handler)(instruction);
+    }
+
+    template<Handler32 handler>
+    static void Thunk32(ARM& cpu, u32 instruction) {
+      (cpu.*handler)(instruction);
+    }
+
+    template<Handler16 handler>
+    static constexpr auto Wrap16() -> typename ARM::Handler16 {
+#ifdef DUAL_ARM_STATIC_DISPATCH
+      return &Thunk16<handler>;
+#else
+      return handler;
+#endif
+    }
+
+    template<Handler32 handler>
+    static constexpr auto Wrap32() -> typename ARM::Handler32 {
+#ifdef DUAL_ARM_STATIC_DISPATCH
+      return &Thunk32<handler>;
+#else
+      return handler;
+#endif
+    }
+
+    static constexpr auto GenerateTableThumb() -> std::array<typename ARM::Handler16, 2048> {
+      std::array<typename ARM::Handler16, 2048> lut = {};
 
       atom::static_for<std::size_t, 0, 2048>([&](auto i) {
-        lut[i] = GenerateHandlerThumb<i << 5>();
+        lut[i] = Wrap16<GenerateHandlerThumb<i << 5>()>();
       });
       return lut;
     }
 
-    static constexpr auto GenerateTableARM() -> std::array<Handler32, 8192> {
-      std::array<Handler32, 8192> lut = {};
+    static constexpr auto GenerateTableARM() -> std::array<typename ARM::Handler32, 8192> {
+      std::array<typename ARM::Handler32, 8192> lut = {};
 
       // Conditional instructions
       atom::static_for<std::size_t, 0, 4096>([&](auto i) {
-        lut[i] = GenerateHandlerARM<
+        lut[i] = Wrap32<GenerateHandlerARM<
           ((i & 0xFF0) << 16) |
-          ((i & 0xF) << 4)>();
+          ((i & 0xF) << 4)>()>();
       });
 
       // Unconditional instructions
       atom::static_for<std::size_t, 0, 4096>([&](auto i) {
-        lut[4096 + i] = GenerateHandlerARM<
+        lut[4096 + i] = Wrap32<GenerateHandlerARM<
           ((i & 0xFF0) << 16) |
-          ((i & 0xF) << 4) | 0xF0000000>();
+          ((i & 0xF) << 4) | 0xF0000000>()>();
       });
 
       return lut;
     }
   };
 
-  std::array<Handler16, 2048> ARM::k_opcode_lut_16 = TableGen::GenerateTableThumb();
-  std::array<Handler32, 8192> ARM::k_opcode_lut_32 = TableGen::GenerateTableARM();
+  template<CPU::Model model, typename MemoryBus>
+  std::array<typename ARM<model, MemoryBus>::Handler16, 2048> ARM<model, MemoryBus>::k_opcode_lut_16 = TableGen<model, MemoryBus>::GenerateTableThumb();
+
+  template<CPU::Model model, typename MemoryBus>
+  std::array<typename ARM<model, MemoryBus>::Handler32, 8192> ARM<model, MemoryBus>::k_opcode_lut_32 = TableGen<model, MemoryBus>::GenerateTableARM();
+
+  using ARM9 = ARM<CPU::Model::ARM9, nds::arm9::MemoryBus>;
+  using ARM7 = ARM<CPU::Model::ARM7, nds::arm7::MemoryBus>;
+
+  template std::array<ARM9::Handler16, 2048> ARM9::k_opcode_lut_16;
+  template std::array<ARM9::Handler32, 8192> ARM9::k_opcode_lut_32;
+  template std::array<ARM7::Handler16, 2048> ARM7::k_opcode_lut_16;
+  template std::array<ARM7::Handler32, 8192> ARM7::k_opcode_lut_32;
 
 } // namespace dual::arm
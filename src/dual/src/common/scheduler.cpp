@@ -1,97 +1,261 @@
-
+#include <algorithm>
+#include <atom/logger/logger.hpp>
 #include <atom/panic.hpp>
 #include <dual/common/scheduler.hpp>
 
 namespace dual {
 
   Scheduler::Scheduler() {
-    for(int i = 0; i < k_event_limit; i++) {
-      m_heap[i] = &m_pool[i];
-      m_heap[i]->handle = i;
+    m_heap.reserve(k_initial_capacity);
+
+    for(int i = 0; i < k_initial_capacity; i++) {
+      FreeEvent(&m_pool.emplace_back());
     }
+
+    m_event_class_end_of_queue = Register([](void*, int, int) {
+      ATOM_PANIC("reached end of the event queue.");
+    }, nullptr);
+
     Reset();
   }
 
   void Scheduler::Reset() {
-    m_heap_size = 0;
+    for(const Node& node : m_heap) {
+      FreeEvent(node.event);
+    }
+
+    m_heap.clear();
     m_timestamp_now = 0;
+    m_event_count = 0u;
 
-    Add(std::numeric_limits<u64>::max(), [](int) {
-      ATOM_PANIC("reached end of the event queue.");
-    });
+    Add(std::numeric_limits<u64>::max(), m_event_class_end_of_queue);
   }
 
   void Scheduler::Step() {
     const u64 now = GetTimestampNow();
 
-    while(m_heap_size > 0 && m_heap[0]->timestamp <= now) {
-      auto event = m_heap[0];
+    while(m_heap[0].timestamp <= now) {
+      auto event = m_heap[0].event;
+      const EventType& event_type = m_event_types[event->event_class];
+
+      m_fired_event = event;
 
-      event->callback(int(now - event->timestamp));
+      event_type.callback(event_type.context, event->arg, int(now - m_heap[0].timestamp));
+      m_event_count++;
 
+      // The callback clears m_fired_event if it rescheduled or cancelled the event.
       // @note: the handle may have changed due to the event callback.
-      Remove(event->handle);
+      if(m_fired_event != nullptr) {
+        Remove(event->handle);
+        m_fired_event = nullptr;
+      }
     }
   }
 
-  auto Scheduler::Add(u64 delay, std::function<void(int)> callback) -> Event* {
-    int n = m_heap_size++;
-    int p = Parent(n);
+  auto Scheduler::Register(EventCallback callback, void* context) -> EventClass {
+    m_event_types.push_back({callback, context});
 
-    if(m_heap_size > k_event_limit) {
-      ATOM_PANIC("exceeded maximum number of scheduler events.");
+    return (EventClass)m_event_types.size() - 1;
+  }
+
+  auto Scheduler::Add(u64 delay, EventClass event_class, int arg) -> Event* {
+    const int n = (int)m_heap.size();
+
+    auto event = AllocateEvent();
+    event->event_class = event_class;
+    event->arg = arg;
+
+    m_heap.push_back({GetTimestampNow() + delay, event});
+    SiftUp(n);
+
+    return event;
+  }
+
+  void Scheduler::Cancel(Event* event) {
+    if(event == m_fired_event) {
+      m_fired_event = nullptr;
     }
 
-    auto event = m_heap[n];
-    event->timestamp = GetTimestampNow() + delay;
-    event->callback = callback;
+    Remove(event->handle);
+  }
 
-    while(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp) {
-      Swap(n, p);
-      n = p;
-      p = Parent(n);
+  void Scheduler::Reschedule(Event* event, u64 delay) {
+    const int n = event->handle;
+    const u64 timestamp = GetTimestampNow() + delay;
+    const u64 old_timestamp = m_heap[n].timestamp;
+
+    if(event == m_fired_event) {
+      m_fired_event = nullptr;
     }
 
-    return event;
+    m_heap[n].timestamp = timestamp;
+
+    if(timestamp < old_timestamp) {
+      SiftUp(n);
+    } else {
+      SiftDown(n);
+    }
+  }
+
+  auto Scheduler::FindEvent(EventClass event_class, int arg) -> Event* {
+    for(const Node& node : m_heap) {
+      if(node.event->event_class == event_class && node.event->arg == arg) {
+        return node.event;
+      }
+    }
+    return nullptr;
+  }
+
+  void Scheduler::SaveState(StateWriter& state) const {
+    state.Write(m_timestamp_now);
+    state.Write(m_event_count);
+    state.Write((u32)m_heap.size());
+
+    // @note: writing the nodes in heap order restores the exact same heap layout (and thus order of simultaneous events) on load.
+    for(const Node& node : m_heap) {
+      state.Write(node.timestamp);
+      state.Write(node.event->event_class);
+      state.Write(node.event->arg);
+    }
+  }
+
+  void Scheduler::LoadState(StateReader& state) {
+    for(const Node& node : m_heap) {
+      FreeEvent(node.event);
+    }
+
+    m_heap.clear();
+
+    state.Read(m_timestamp_now);
+    state.Read(m_event_count);
+
+    const u32 event_count = state.Read<u32>();
+
+    for(u32 i = 0; i < event_count; i++) {
+      const u64 timestamp = state.Read<u64>();
+
+      auto event = AllocateEvent();
+      state.Read(event->event_class);
+      state.Read(event->arg);
+
+      if(state.Good() && (event->event_class < 0 || event->event_class >= (EventClass)m_event_types.size())) {
+        ATOM_ERROR("save state references an unknown event class: {}", event->event_class);
+        state.Fail();
+      }
+
+      if(!state.Good()) {
+        // The caller rejects the save state, but the queue must stay valid until the next reset.
+        FreeEvent(event);
+        break;
+      }
+
+      m_heap.push_back({timestamp, event});
+      SiftUp((int)i);
+    }
+
+    if(state.Good() && m_heap.empty()) {
+      ATOM_ERROR("save state does not contain any events");
+      state.Fail();
+    }
+
+    if(!state.Good()) {
+      for(const Node& node : m_heap) {
+        FreeEvent(node.event);
+      }
+      m_heap.clear();
+      m_timestamp_now = 0;
+      Add(std::numeric_limits<u64>::max(), m_event_class_end_of_queue);
+    }
   }
 
   void Scheduler::Remove(int n) {
-    Swap(n, --m_heap_size);
+    FreeEvent(m_heap[n].event);
 
-    int p = Parent(n);
+    const Node last = m_heap.back();
 
-    if(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp) {
-      do {
-        Swap(n, p);
-        n = p;
-        p = Parent(n);
-      } while(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp);
+    m_heap.pop_back();
+
+    if(n == (int)m_heap.size()) {
+      return;
+    }
+
+    m_heap[n] = last;
+
+    if(n != 0 && m_heap[Parent(n)].timestamp > last.timestamp) {
+      SiftUp(n);
     } else {
-      Heapify(n);
+      SiftDown(n);
     }
   }
 
-  void Scheduler::Swap(int i, int j) {
-    auto tmp = m_heap[i];
-    m_heap[i] = m_heap[j];
-    m_heap[j] = tmp;
-    m_heap[i]->handle = i;
-    m_heap[j]->handle = j;
+  void Scheduler::SiftUp(int n) {
+    const Node node = m_heap[n];
+
+    while(n != 0) {
+      const int p = Parent(n);
+
+      if(m_heap[p].timestamp <= node.timestamp) {
+        break;
+      }
+
+      m_heap[n] = m_heap[p];
+      m_heap[n].event->handle = n;
+      n = p;
+    }
+
+    m_heap[n] = node;
+    node.event->handle = n;
   }
 
-  void Scheduler::Heapify(int n) {
-    const int l = LeftChild(n);
-    const int r = RightChild(n);
+  void Scheduler::SiftDown(int n) {
+    const Node node = m_heap[n];
+    const int size = (int)m_heap.size();
+
+    while(true) {
+      const int first_child = FirstChild(n);
+
+      if(first_child >= size) {
+        break;
+      }
+
+      const int last_child = std::min(first_child + 4, size);
+
+      int min_child = first_child;
+
+      for(int i = first_child + 1; i < last_child; i++) {
+        if(m_heap[i].timestamp < m_heap[min_child].timestamp) {
+          min_child = i;
+        }
+      }
 
-    if(l < m_heap_size && m_heap[l]->timestamp < m_heap[n]->timestamp) {
-      Swap(l, n);
-      Heapify(l);
+      if(m_heap[min_child].timestamp >= node.timestamp) {
+        break;
+      }
+
+      m_heap[n] = m_heap[min_child];
+      m_heap[n].event->handle = n;
+      n = min_child;
     }
 
-    if(r < m_heap_size && m_heap[r]->timestamp < m_heap[n]->timestamp) {
-      Swap(r, n);
-      Heapify(r);
+    m_heap[n] = node;
+    node.event->handle = n;
+  }
+
+  auto Scheduler::AllocateEvent() -> Event* {
+    const auto event = m_free_events;
+
+    if(event == nullptr) [[unlikely]] {
+      // Events are never released to the host, so that pointers to them stay valid.
+      return &m_pool.emplace_back();
     }
+
+    m_free_events = event->next_free;
+    return event;
+  }
+
+  void Scheduler::FreeEvent(Event* event) {
+    event->next_free = m_free_events;
+    m_free_events = event;
   }
 
-} // namespace dual
\ No newline at end of file
+} // namespace dual
@@ -22,7 +22,10 @@ namespace dual::nds::arm7 {
     0x7FFF
   };
 
-  APU::APU(Scheduler& scheduler, arm::Memory& bus) : m_scheduler{scheduler}, m_bus{bus} {}
+  APU::APU(Scheduler& scheduler, arm::Memory& bus) : m_scheduler{scheduler}, m_bus{bus} {
+    m_event_class_sample_mixers = scheduler.Register<&APU::SampleMixers>(this);
+    m_event_class_sample_channel = scheduler.Register<&APU::SampleChannel>(this);
+  }
 
   void APU::Reset() {
     m_soundxcnt.fill({});
@@ -35,14 +38,59 @@ namespace dual::nds::arm7 {
     m_channels.fill({});
 
     for(int id = 0; id < 16; id++) {
-      m_channels[id].sampling_event_fn = [this, id](int cycles_late) {
-        SampleChannel(id, cycles_late);
-      };
-
       RecomputeChannelSamplingInterval(id);
     }
 
-    m_scheduler.Add(k_cycles_per_sample, this, &APU::SampleMixers);
+    m_mixer_event = m_scheduler.Add(k_cycles_per_sample, m_event_class_sample_mixers);
+  }
+
+  void APU::SaveState(StateWriter& state) const {
+    for(const auto& soundxcnt : m_soundxcnt) state.Write(soundxcnt.word);
+    state.Write(m_soundxsad);
+    state.Write(m_soundxtmr);
+    state.Write(m_soundxpnt);
+    state.Write(m_soundxlen);
+    state.Write(m_soundcnt.word);
+    state.Write(m_soundbias);
+
+    for(const auto& channel : m_channels) {
+      state.Write(channel.sampling_interval);
+      state.Write(channel.current_sample);
+      state.Write(channel.current_address);
+      state.Write(channel.sample_format);
+      state.Write(channel.adpcm);
+      state.Write(channel.noise_lfsr);
+      state.Write(channel.samples_left);
+      state.Write(channel.samples_pipe);
+    }
+  }
+
+  void APU::LoadState(StateReader& state) {
+    for(auto& soundxcnt : m_soundxcnt) state.Read(soundxcnt.word);
+    state.Read(m_soundxsad);
+    state.Read(m_soundxtmr);
+    state.Read(m_soundxpnt);
+    state.Read(m_soundxlen);
+    state.Read(m_soundcnt.word);
+    state.Read(m_soundbias);
+
+    for(int id = 0; id < 16; id++) {
+      auto& channel = m_channels[id];
+
+      state.Read(channel.sampling_interval);
+      state.Read(channel.current_sample);
+      state.Read(channel.current_address);
+      state.Read(channel.sample_format);
+      state.Read(channel.adpcm);
+      state.Read(channel.noise_lfsr);
+      state.Read(channel.samples_left);
+      state.Read(channel.samples_pipe);
+
+      // @note: the scheduler must have been loaded already.
+      channel.sampling_event = m_scheduler.FindEvent(m_event_class_sample_channel, id);
+    }
+
+    m_mixer_event = m_scheduler.FindEvent(m_event_class_sample_mixers);
   }
 
   AudioDriverBase* APU::GetAudioDriver() {
@@ -100,7 +148,7 @@ namespace dual::nds::arm7 {
       m_audio_buffer.Clear();
     }
 
-    m_scheduler.Add(k_cycles_per_sample - cycles_late, this, &APU::SampleMixers);
+    m_scheduler.Reschedule(m_mixer_event, k_cycles_per_sample - cycles_late);
   }
 
   void APU::SampleChannel(int id, int cycles_late) {
@@ -112,7 +160,9 @@ namespace dual::nds::arm7 {
     }
 
     if(m_soundxcnt[id].running) {
-      ScheduleSampleChannel(id, cycles_late);
+      const Channel& channel = m_channels[id];
+
+      m_scheduler.Reschedule(channel.sampling_event, channel.sampling_interval - cycles_late);
     }
   }
 
@@ -259,10 +309,10 @@ namespace dual::nds::arm7 {
     ScheduleSampleChannel(id);
   }
 
-  void APU::ScheduleSampleChannel(int id, int cycles_late) {
+  void APU::ScheduleSampleChannel(int id) {
     Channel& channel = m_channels[id];
 
-    channel.sampling_event = m_scheduler.Add(channel.sampling_interval - cycles_late, channel.sampling_event_fn);
+    channel.sampling_event = m_scheduler.Add(channel.sampling_interval, m_event_class_sample_channel, id);
   }
 
   void APU::CancelSampleChannel(int id) {
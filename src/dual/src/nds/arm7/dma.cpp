@@ -22,6 +22,24 @@ namespace dual::nds::arm7 {
     for(auto& latch : m_latch) latch = {};
   }
 
+  void DMA::SaveState(StateWriter& state) const {
+    for(int id = 0; id < 4; id++) {
+      state.Write(m_dmasad[id]);
+      state.Write(m_dmadad[id]);
+      state.Write(m_dmacnt[id].word);
+      state.Write(m_latch[id]);
+    }
+  }
+
+  void DMA::LoadState(StateReader& state) {
+    for(int id = 0; id < 4; id++) {
+      state.Read(m_dmasad[id]);
+      state.Read(m_dmadad[id]);
+      state.Read(m_dmacnt[id].word);
+      state.Read(m_latch[id]);
+    }
+  }
+
   void DMA::Request(StartTime timing) {
     for(int id : {0, 1, 2, 3}) {
       const auto& dmacnt = m_dmacnt[id];
@@ -125,6 +125,10 @@ namespace dual::nds::arm7 {
       case REG(0x04000108): return hw.timer.Read_TMCNT(2);
       case REG(0x0400010C): return hw.timer.Read_TMCNT(3);
 
+      // Keypad
+      case REG(0x04000130): return hw.input.Read_KEYINPUT();
+      case REG(0x04000134): return hw.input.Read_EXTKEYIN() << 16;
+
       // RTC
       case REG(0x04000138): return hw.rtc.Read_RTC();
 
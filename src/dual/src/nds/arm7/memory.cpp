@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <dual/nds/arm7/memory.hpp>
 
 namespace dual::nds::arm7 {
@@ -6,21 +7,47 @@ namespace dual::nds::arm7 {
   namespace bit = atom::bit;
 
   MemoryBus::MemoryBus(SystemMemory& memory, const HW& hw)
-      : m_boot_rom{memory.arm7.bios.data()}
+      : m_io{hw}
+      , m_boot_rom{memory.arm7.bios.data()}
       , m_ewram{memory.ewram.data()}
       , m_iwram{memory.arm7.iwram.data()}
       , m_swram{memory.swram}
       , m_vram{memory.vram}
-      , m_io{hw} {
+      , m_code_pages{memory.code_pages} {
+    m_page_tables.fill(&m_page_table);
+
+    m_swram.AddCallback([this]() {
+      UpdatePageTable(0x03000000u, 0x03FFFFFFu);
+    });
+
+    m_vram.region_arm7_wram.AddCallback([this](u32, size_t) {
+      UpdatePageTable(0x06000000u, 0x06FFFFFFu);
+    });
+
+    UpdatePageTable(0u, arm::PageTable::k_address_limit - 1u);
+  }
+
+  void MemoryBus::SaveState(StateWriter& state) const {
+    state.Write(m_io.postflg);
+  }
+
+  void MemoryBus::LoadState(StateReader& state) {
+    state.Read(m_io.postflg);
   }
 
   void MemoryBus::Reset() {
     m_io.postflg = 0u;
+
+    UpdatePageTable(0u, arm::PageTable::k_address_limit - 1u);
   }
 
   template<typename T> T MemoryBus::Read(u32 address, Bus bus) {
     address &= ~(sizeof(T) - 1u);
 
+    if(T value; m_page_table.TryRead<T>(address, value)) [[likely]] {
+      return value;
+    }
+
     switch(address >> 24) {
       case 0x00: {
         return atom::read<T>(m_boot_rom, address & 0x3FFFu);
@@ -35,6 +62,8 @@ namespace dual::nds::arm7 {
         return atom::read<T>(m_swram.arm7.data, address & m_swram.arm7.mask);
       }
       case 0x04: {
+        m_io.hw.cpu_sync.Synchronize(CPU::ARM7);
+
         if constexpr(std::is_same_v<T, u8 >) return m_io.ReadByte(address);
         if constexpr(std::is_same_v<T, u16>) return m_io.ReadHalf(address);
         if constexpr(std::is_same_v<T, u32>) return m_io.ReadWord(address);
@@ -53,20 +82,29 @@ namespace dual::nds::arm7 {
   template<typename T> void MemoryBus::Write(u32 address, T value, Bus bus) {
     address &= ~(sizeof(T) - 1u);
 
+    if(m_page_table.TryWrite<T>(address, value)) [[likely]] {
+      return;
+    }
+
     switch(address >> 24) {
       case 0x02: {
         atom::write<T>(m_ewram, address & 0x3FFFFFu, value);
+        CodePages::Increment(m_code_pages.ewram[(address & 0x3FFFFFu) >> CodePages::k_page_shift]);
         break;
       }
       case 0x03: {
         if((address & 0x00800000u) || !m_swram.arm7.data) {
           atom::write<T>(m_iwram, address & 0xFFFFu, value);
+          m_code_pages.iwram[(address & 0xFFFFu) >> CodePages::k_page_shift]++;
         } else {
           atom::write<T>(m_swram.arm7.data, address & m_swram.arm7.mask, value);
+          CodePages::Increment(m_swram.arm7.code_pages[(address & m_swram.arm7.mask) >> CodePages::k_page_shift]);
         }
         break;
       }
       case 0x04: {
+        m_io.hw.cpu_sync.Synchronize(CPU::ARM7);
+
         if constexpr(std::is_same_v<T, u8 >) m_io.WriteByte(address, value);
         if constexpr(std::is_same_v<T, u16>) m_io.WriteHalf(address, value);
         if constexpr(std::is_same_v<T, u32>) m_io.WriteWord(address, value);
@@ -110,4 +148,86 @@ namespace dual::nds::arm7 {
     Write<u32>(address, value, bus);
   }
 
+  void MemoryBus::UpdatePageTable(u32 address_lo, u32 address_hi) {
+    address_hi = std::min(address_hi, arm::PageTable::k_address_limit - 1u);
+
+    for(u32 address = address_lo & ~arm::PageTable::k_page_mask; address <= address_hi; address += arm::PageTable::k_page_size) {
+      m_page_table.SetReadPage(address, LookupReadPage(address));
+      m_page_table.SetWritePage(address, LookupWritePage(address));
+    }
+  }
+
+  const u8* MemoryBus::LookupReadPage(u32 address) {
+    switch(address >> 24) {
+      case 0x00: {
+        return &m_boot_rom[address & 0x3FFFu];
+      }
+      case 0x02: {
+        return &m_ewram[address & 0x3FFFFFu];
+      }
+      case 0x03: {
+        if((address & 0x00800000u) || !m_swram.arm7.data) {
+          return &m_iwram[address & 0xFFFFu];
+        }
+        return &m_swram.arm7.data[address & m_swram.arm7.mask];
+      }
+      case 0x06: {
+        return m_vram.region_arm7_wram.GetUnsafePointer<u8>(address);
+      }
+    }
+
+    return nullptr;
+  }
+
+  arm::PageTable::WritePage MemoryBus::LookupWritePage(u32 address) {
+    switch(address >> 24) {
+      case 0x02: {
+        const u32 offset = address & 0x3FFFFFu;
+
+        return {&m_ewram[offset], &m_code_pages.ewram[offset >> CodePages::k_page_shift]};
+      }
+      case 0x03: {
+        if((address & 0x00800000u) || !m_swram.arm7.data) {
+          const u32 offset = address & 0xFFFFu;
+
+          return {&m_iwram[offset], &m_code_pages.iwram[offset >> CodePages::k_page_shift]};
+        }
+
+        const u32 offset = address & m_swram.arm7.mask;
+
+        return {&m_swram.arm7.data[offset], &m_swram.arm7.code_pages[offset >> CodePages::k_page_shift]};
+      }
+      case 0x06: {
+        return {m_vram.region_arm7_wram.GetUnsafePointer<u8>(address), nullptr};
+      }
+    }
+
+    return {};
+  }
+
+  const u32* MemoryBus::GetCodePageVersion(u32 address) {
+    switch(address >> 24) {
+      case 0x00: {
+        return &m_code_pages.rom;
+      }
+      case 0x02: {
+        return &m_code_pages.ewram[(address & 0x3FFFFFu) >> CodePages::k_page_shift];
+      }
+      case 0x03: {
+        if((address & 0x00800000u) || !m_swram.arm7.data) {
+          return &m_code_pages.iwram[(address & 0xFFFFu) >> CodePages::k_page_shift];
+        }
+        return &m_swram.arm7.code_pages[(address & m_swram.arm7.mask) >> CodePages::k_page_shift];
+      }
+    }
+
+    return nullptr;
+  }
+
+  bool MemoryBus::IsVolatile(u32 address) {
+    // Timer counters are updated lazily and reading IPCFIFORECV or the cartridge data port consumes data.
+    return (address >= 0x04000100u && address <= 0x0400010Fu) ||
+           (address >= 0x04100000u && address <= 0x04100013u);
+  }
+
 } // namespace dual::nds::arm7
@@ -20,6 +20,30 @@ namespace dual::nds::arm7 {
     m_stat2 = 0u;
   }
 
+  void RTC::SaveState(StateWriter& state) const {
+    state.Write(m_current_bit);
+    state.Write(m_current_byte);
+    state.Write(m_reg);
+    state.Write(m_data);
+    state.Write(m_buffer);
+    state.Write(m_port);
+    state.Write(m_state);
+    state.Write(m_stat1);
+    state.Write(m_stat2);
+  }
+
+  void RTC::LoadState(StateReader& state) {
+    state.Read(m_current_bit);
+    state.Read(m_current_byte);
+    state.Read(m_reg);
+    state.Read(m_data);
+    state.Read(m_buffer);
+    state.Read(m_port);
+    state.Read(m_state);
+    state.Read(m_stat1);
+    state.Read(m_stat2);
+  }
+
   auto RTC::Read_RTC() -> u8 {
     return (m_port.sio << 0) |
            (m_port.sck << 1) |
@@ -6,10 +6,10 @@
 
 namespace dual::nds::arm7 {
 
-  SPI::SPI(IRQ& irq) : m_irq{irq} {
+  SPI::SPI(IRQ& irq, const Input& input) : m_irq{irq} {
     // @todo: better handle the case where firmware.bin does not exist.
     m_device_table[1] = std::make_unique<FLASH>("firmware.bin", FLASH::Size::_256K);
-    m_device_table[2] = std::make_unique<TouchScreen>();
+    m_device_table[2] = std::make_unique<TouchScreen>(input);
     ReadAndApplyTouchScreenCalibrationData();
   }
 
@@ -25,6 +25,30 @@ namespace dual::nds::arm7 {
     }
   }
 
+  void SPI::SaveState(StateWriter& state) const {
+    state.Write(m_spicnt.half);
+    state.Write(m_spidata);
+    state.Write(m_chip_select);
+
+    for(const auto& device : m_device_table) {
+      if(device) {
+        device->SaveState(state);
+      }
+    }
+  }
+
+  void SPI::LoadState(StateReader& state) {
+    state.Read(m_spicnt.half);
+    state.Read(m_spidata);
+    state.Read(m_chip_select);
+
+    for(auto& device : m_device_table) {
+      if(device) {
+        device->LoadState(state);
+      }
+    }
+  }
+
   auto SPI::Read_SPICNT() -> u16 {
     return m_spicnt.half;
   }
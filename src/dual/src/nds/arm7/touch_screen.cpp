@@ -8,6 +8,14 @@ namespace dual::nds::arm7 {
     m_data_out = 0u;
   }
 
+  void TouchScreen::SaveState(StateWriter& state) const {
+    state.Write(m_data_out);
+  }
+
+  void TouchScreen::LoadState(StateReader& state) {
+    state.Read(m_data_out);
+  }
+
   void TouchScreen::Select() {
   }
 
@@ -34,12 +42,11 @@ namespace dual::nds::arm7 {
 
     m_data_out <<= 8;
 
-    /*const */u16 adc_x = 0x0000u;
-    /*const */u16 adc_y = 0x0FFFu;
+    u16 adc_x = 0x0000u;
+    u16 adc_y = 0x0FFFu;
 
-    {
-      const int screen_x = 64;
-      const int screen_y = 32;
+    if(m_input.GetPenDown()) {
+      const auto [screen_x, screen_y] = m_input.GetTouchPosition();
 
       adc_x = (u16)((screen_x - m_screen_x_top_left + 1) * m_adc_x_delta / m_screen_x_delta + m_adc_x_top_left);
       adc_y = (u16)((screen_y - m_screen_y_top_left + 1) * m_adc_y_delta / m_screen_y_delta + m_adc_y_top_left);
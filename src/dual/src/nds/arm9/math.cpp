@@ -17,6 +17,28 @@ namespace dual::nds::arm9 {
     m_sqrt_result = 0u;
   }
 
+  void Math::SaveState(StateWriter& state) const {
+    state.Write(m_divcnt.word);
+    state.Write(m_div_numerator);
+    state.Write(m_div_denominator);
+    state.Write(m_div_result);
+    state.Write(m_div_remainder);
+    state.Write(m_sqrtcnt.word);
+    state.Write(m_sqrt_result);
+    state.Write(m_sqrt_param);
+  }
+
+  void Math::LoadState(StateReader& state) {
+    state.Read(m_divcnt.word);
+    state.Read(m_div_numerator);
+    state.Read(m_div_denominator);
+    state.Read(m_div_result);
+    state.Read(m_div_remainder);
+    state.Read(m_sqrtcnt.word);
+    state.Read(m_sqrt_result);
+    state.Read(m_sqrt_param);
+  }
+
   u32 Math::Read_DIVCNT() {
     return m_divcnt.word;
   }
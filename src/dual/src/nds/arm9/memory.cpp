@@ -1,5 +1,5 @@
 
-#include <SDL.h>
+#include <algorithm>
 
 #include <dual/nds/arm9/memory.hpp>
 
@@ -8,32 +8,86 @@ namespace dual::nds::arm9 {
   namespace bit = atom::bit;
 
   MemoryBus::MemoryBus(SystemMemory& memory, const HW& hw)
-      : m_boot_rom{memory.arm9.bios.data()}
+      : m_io{hw}
+      , m_boot_rom{memory.arm9.bios.data()}
       , m_ewram{memory.ewram.data()}
       , m_pram{memory.pram.data()}
       , m_oam{memory.oam.data()}
       , m_swram{hw.swram}
       , m_vram{hw.vram}
-      , m_io{hw} {
+      , m_code_pages{memory.code_pages} {
     m_dtcm.data = memory.arm9.dtcm.data();
     m_itcm.data = memory.arm9.itcm.data();
+
+    for(int bus = 0; bus < 3; bus++) {
+      m_page_tables[bus] = &m_page_table[bus];
+    }
+
+    m_swram.AddCallback([this]() {
+      UpdatePageTable(0x03000000u, 0x03FFFFFFu);
+    });
+
+    const auto add_vram_callback = [this](const auto& region, u32 address_lo, u32 address_hi) {
+      region.AddCallback([=, this](u32, size_t) {
+        UpdatePageTable(address_lo, address_hi);
+      });
+    };
+
+    add_vram_callback(m_vram.region_ppu_bg[0],  0x06000000u, 0x061FFFFFu);
+    add_vram_callback(m_vram.region_ppu_bg[1],  0x06200000u, 0x063FFFFFu);
+    add_vram_callback(m_vram.region_ppu_obj[0], 0x06400000u, 0x065FFFFFu);
+    add_vram_callback(m_vram.region_ppu_obj[1], 0x06600000u, 0x067FFFFFu);
+    add_vram_callback(m_vram.region_lcdc,       0x06800000u, 0x06FFFFFFu);
+
+    UpdatePageTable(0u, arm::PageTable::k_address_limit - 1u);
+  }
+
+  void MemoryBus::SaveState(StateWriter& state) const {
+    state.Write(m_io.postflg);
+  }
+
+  void MemoryBus::LoadState(StateReader& state) {
+    state.Read(m_io.postflg);
   }
 
   void MemoryBus::Reset() {
     m_io.postflg = 0u;
+
+    UpdatePageTable(0u, arm::PageTable::k_address_limit - 1u);
   }
 
   void MemoryBus::SetupDTCM(const TCM::Config& config) {
+    if(config == m_dtcm.config) {
+      return;
+    }
+
+    const TCM::Config old_config = m_dtcm.config;
+
     m_dtcm.config = config;
+    UpdatePageTable(old_config);
+    UpdatePageTable(config);
   }
 
   void MemoryBus::SetupITCM(const TCM::Config& config) {
+    if(config == m_itcm.config) {
+      return;
+    }
+
+    const TCM::Config old_config = m_itcm.config;
+
     m_itcm.config = config;
+    m_code_pages.Invalidate();
+    UpdatePageTable(old_config);
+    UpdatePageTable(config);
   }
 
   template<typename T> T MemoryBus::Read(u32 address, Bus bus) {
     address &= ~(sizeof(T) - 1u);
 
+    if(T value; m_page_table[(int)bus].TryRead<T>(address, value)) [[likely]] {
+      return value;
+    }
+
     if(
       bus != Bus::System && m_itcm.config.readable &&
       address >= m_itcm.config.base_address &&
@@ -61,24 +115,7 @@ namespace dual::nds::arm9 {
         return atom::read<T>(m_swram.arm9.data, address & m_swram.arm9.mask);
       }
       case 0x04: {
-        if(address == 0x04000130) {
-          const u8* key_state = SDL_GetKeyboardState(nullptr);
-
-          u16 keyinput = 0x03FFu;
-
-          if(key_state[SDL_SCANCODE_A]) keyinput &= ~1u;
-          if(key_state[SDL_SCANCODE_S]) keyinput &= ~2u;
-          if(key_state[SDL_SCANCODE_BACKSPACE]) keyinput &= ~4u;
-          if(key_state[SDL_SCANCODE_RETURN]) keyinput &= ~8u;
-          if(key_state[SDL_SCANCODE_RIGHT]) keyinput &= ~16u;
-          if(key_state[SDL_SCANCODE_LEFT]) keyinput &= ~32u;
-          if(key_state[SDL_SCANCODE_UP]) keyinput &= ~64u;
-          if(key_state[SDL_SCANCODE_DOWN]) keyinput &= ~128u;
-          if(key_state[SDL_SCANCODE_F]) keyinput &= ~256u;
-          if(key_state[SDL_SCANCODE_D]) keyinput &= ~512u;
-
-          return keyinput;
-        }
+        m_io.hw.cpu_sync.Synchronize(CPU::ARM9);
 
         if constexpr(std::is_same_v<T, u8 >) return m_io.ReadByte(address);
         if constexpr(std::is_same_v<T, u16>) return m_io.ReadHalf(address);
@@ -116,12 +153,19 @@ namespace dual::nds::arm9 {
   template<typename T> void MemoryBus::Write(u32 address, T value, Bus bus) {
     address &= ~(sizeof(T) - 1u);
 
+    if(m_page_table[(int)bus].TryWrite<T>(address, value)) [[likely]] {
+      return;
+    }
+
     if(
       bus != Bus::System && m_itcm.config.writable &&
       address >= m_itcm.config.base_address &&
       address <= m_itcm.config.high_address
     ) {
-      atom::write<T>(m_itcm.data, (address - m_itcm.config.base_address) & 0x7FFFu, value);
+      const u32 offset = (address - m_itcm.config.base_address) & 0x7FFFu;
+
+      atom::write<T>(m_itcm.data, offset, value);
+      m_code_pages.itcm[offset >> CodePages::k_page_shift]++;
       return;
     }
 
@@ -137,6 +181,7 @@ namespace dual::nds::arm9 {
     switch(address >> 24) {
       case 0x02: {
         atom::write<T>(m_ewram, address & 0x3FFFFFu, value);
+        CodePages::Increment(m_code_pages.ewram[(address & 0x3FFFFFu) >> CodePages::k_page_shift]);
         break;
       }
       case 0x03: {
@@ -144,9 +189,12 @@ namespace dual::nds::arm9 {
           return;
         }
         atom::write<T>(m_swram.arm9.data, address & m_swram.arm9.mask, value);
+        CodePages::Increment(m_swram.arm9.code_pages[(address & m_swram.arm9.mask) >> CodePages::k_page_shift]);
         break;
       }
       case 0x04: {
+        m_io.hw.cpu_sync.Synchronize(CPU::ARM9);
+
         if constexpr(std::is_same_v<T, u8 >) m_io.WriteByte(address, value);
         if constexpr(std::is_same_v<T, u16>) m_io.WriteHalf(address, value);
         if constexpr(std::is_same_v<T, u32>) m_io.WriteWord(address, value);
@@ -214,4 +262,150 @@ namespace dual::nds::arm9 {
     Write<u32>(address, value, bus);
   }
 
+  void MemoryBus::UpdatePageTable(u32 address_lo, u32 address_hi) {
+    address_hi = std::min(address_hi, arm::PageTable::k_address_limit - 1u);
+
+    for(u32 address = address_lo & ~arm::PageTable::k_page_mask; address <= address_hi; address += arm::PageTable::k_page_size) {
+      for(int bus = 0; bus < 3; bus++) {
+        m_page_table[bus].SetReadPage(address, LookupReadPage(address, (Bus)bus));
+        m_page_table[bus].SetWritePage(address, LookupWritePage(address, (Bus)bus));
+      }
+    }
+  }
+
+  void MemoryBus::UpdatePageTable(const TCM::Config& config) {
+    if(config.readable || config.writable) {
+      UpdatePageTable(config.base_address, config.high_address);
+    }
+  }
+
+  // Returns: 0 = page is outside the TCM, 1 = page is fully inside the TCM, -1 = page is partially inside the TCM.
+  static int GetTCMCoverage(const MemoryBus::TCM::Config& config, u32 address) {
+    const u32 address_hi = address + arm::PageTable::k_page_mask;
+
+    if(address_hi < config.base_address || address > config.high_address) {
+      return 0;
+    }
+
+    if(address >= config.base_address && address_hi <= config.high_address) {
+      return 1;
+    }
+
+    return -1;
+  }
+
+  const u8* MemoryBus::LookupReadPage(u32 address, Bus bus) {
+    if(bus != Bus::System && m_itcm.config.readable) {
+      switch(GetTCMCoverage(m_itcm.config, address)) {
+        case  1: return &m_itcm.data[(address - m_itcm.config.base_address) & 0x7FFFu];
+        case -1: return nullptr;
+      }
+    }
+
+    if(bus == Bus::Data && m_dtcm.config.readable) {
+      switch(GetTCMCoverage(m_dtcm.config, address)) {
+        case  1: return &m_dtcm.data[(address - m_dtcm.config.base_address) & 0x3FFFu];
+        case -1: return nullptr;
+      }
+    }
+
+    switch(address >> 24) {
+      case 0x02: {
+        return &m_ewram[address & 0x3FFFFFu];
+      }
+      case 0x03: {
+        if(!m_swram.arm9.data) {
+          return nullptr;
+        }
+        return &m_swram.arm9.data[address & m_swram.arm9.mask];
+      }
+      case 0x06: {
+        // Pages to which multiple or no banks are mapped are handled by the slow path.
+        switch((address >> 20) & 15) {
+          case 0: case 1: return m_vram.region_ppu_bg [0].GetUnsafePointer<u8>(address & 0x1FFFFFu);
+          case 2: case 3: return m_vram.region_ppu_bg [1].GetUnsafePointer<u8>(address & 0x1FFFFFu);
+          case 4: case 5: return m_vram.region_ppu_obj[0].GetUnsafePointer<u8>(address & 0x1FFFFFu);
+          case 6: case 7: return m_vram.region_ppu_obj[1].GetUnsafePointer<u8>(address & 0x1FFFFFu);
+          default:        return m_vram.region_lcdc.GetUnsafePointer<u8>(address & 0xFFFFFu);
+        }
+      }
+    }
+
+    return nullptr;
+  }
+
+  arm::PageTable::WritePage MemoryBus::LookupWritePage(u32 address, Bus bus) {
+    if(bus != Bus::System && m_itcm.config.writable) {
+      const u32 offset = (address - m_itcm.config.base_address) & 0x7FFFu;
+
+      switch(GetTCMCoverage(m_itcm.config, address)) {
+        case  1: return {&m_itcm.data[offset], &m_code_pages.itcm[offset >> CodePages::k_page_shift]};
+        case -1: return {};
+      }
+    }
+
+    if(bus == Bus::Data && m_dtcm.config.writable) {
+      switch(GetTCMCoverage(m_dtcm.config, address)) {
+        case  1: return {&m_dtcm.data[(address - m_dtcm.config.base_address) & 0x3FFFu], nullptr};
+        case -1: return {};
+      }
+    }
+
+    // VRAM, PRAM and OAM writes must notify the PPUs and therefore always take the slow path.
+    switch(address >> 24) {
+      case 0x02: {
+        const u32 offset = address & 0x3FFFFFu;
+
+        return {&m_ewram[offset], &m_code_pages.ewram[offset >> CodePages::k_page_shift]};
+      }
+      case 0x03: {
+        if(!m_swram.arm9.data) {
+          return {};
+        }
+
+        const u32 offset = address & m_swram.arm9.mask;
+
+        return {&m_swram.arm9.data[offset], &m_swram.arm9.code_pages[offset >> CodePages::k_page_shift]};
+      }
+    }
+
+    return {};
+  }
+
+  const u32* MemoryBus::GetCodePageVersion(u32 address) {
+    if(
+      m_itcm.config.readable &&
+      address >= m_itcm.config.base_address &&
+      address <= m_itcm.config.high_address
+    ) {
+      return &m_code_pages.itcm[((address - m_itcm.config.base_address) & 0x7FFFu) >> CodePages::k_page_shift];
+    }
+
+    switch(address >> 24) {
+      case 0x02: {
+        return &m_code_pages.ewram[(address & 0x3FFFFFu) >> CodePages::k_page_shift];
+      }
+      case 0x03: {
+        if(!m_swram.arm9.data) {
+          return nullptr;
+        }
+        return &m_swram.arm9.code_pages[(address & m_swram.arm9.mask) >> CodePages::k_page_shift];
+      }
+      case 0xFF: {
+        if(address >= 0xFFFF0000u) {
+          return &m_code_pages.rom;
+        }
+        return nullptr;
+      }
+    }
+
+    return nullptr;
+  }
+
+  bool MemoryBus::IsVolatile(u32 address) {
+    // Timer counters are updated lazily and reading IPCFIFORECV or the cartridge data port consumes data.
+    return (address >= 0x04000100u && address <= 0x0400010Fu) ||
+           (address >= 0x04100000u && address <= 0x04100013u);
+  }
+
 } // namespace dual::nds::arm9
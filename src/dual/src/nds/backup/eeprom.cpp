@@ -67,6 +67,24 @@ namespace dual::nds {
     m_status_reg_write_disable = false;
   }
 
+  void EEPROM::SaveState(StateWriter& state) const {
+    state.Write(m_state);
+    state.Write(m_current_cmd);
+    state.Write(m_address);
+    state.Write(m_write_enable_latch);
+    state.Write(m_write_protect_mode);
+    state.Write(m_status_reg_write_disable);
+  }
+
+  void EEPROM::LoadState(StateReader& state) {
+    state.Read(m_state);
+    state.Read(m_current_cmd);
+    state.Read(m_address);
+    state.Read(m_write_enable_latch);
+    state.Read(m_write_protect_mode);
+    state.Read(m_status_reg_write_disable);
+  }
+
   void EEPROM::Select() {
     if(m_state == State::Deselected) {
       m_state = State::ReceiveCommand;
@@ -20,6 +20,22 @@ namespace dual::nds {
     m_write_protect_mode = 0;
   }
 
+  void EEPROM512B::SaveState(StateWriter& state) const {
+    state.Write(m_state);
+    state.Write(m_current_cmd);
+    state.Write(m_address);
+    state.Write(m_write_enable_latch);
+    state.Write(m_write_protect_mode);
+  }
+
+  void EEPROM512B::LoadState(StateReader& state) {
+    state.Read(m_state);
+    state.Read(m_current_cmd);
+    state.Read(m_address);
+    state.Read(m_write_enable_latch);
+    state.Read(m_write_protect_mode);
+  }
+
   void EEPROM512B::Select() {
     if(m_state == State::Deselected) {
       m_state = State::ReceiveCommand;
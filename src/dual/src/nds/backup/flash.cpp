@@ -32,6 +32,22 @@ namespace dual::nds {
     m_deep_power_down = false;
   }
 
+  void FLASH::SaveState(StateWriter& state) const {
+    state.Write(m_state);
+    state.Write(m_current_cmd);
+    state.Write(m_address);
+    state.Write(m_write_enable_latch);
+    state.Write(m_deep_power_down);
+  }
+
+  void FLASH::LoadState(StateReader& state) {
+    state.Read(m_state);
+    state.Read(m_current_cmd);
+    state.Read(m_address);
+    state.Read(m_write_enable_latch);
+    state.Read(m_deep_power_down);
+  }
+
   void FLASH::Select() {
     if(m_state == State::Deselected) {
       m_state = State::ReceiveCommand;
@@ -18,6 +18,9 @@ namespace dual::nds {
   )   : m_scheduler{scheduler}, m_dma9{dma9}, m_dma7{dma7}, m_memory{memory} {
     m_irq[(int)CPU::ARM9] = &irq9;
     m_irq[(int)CPU::ARM7] = &irq7;
+
+    m_event_class_command = scheduler.Register<&Cartridge::HandleCommand>(this);
+    m_event_class_data_ready = scheduler.Register<&Cartridge::SignalDataReady>(this);
   }
 
   void Cartridge::Reset() {
@@ -33,6 +36,48 @@ namespace dual::nds {
     m_data_mode = DataMode::MainDataLoad;
   }
 
+  void Cartridge::SaveState(StateWriter& state) const {
+    state.Write(m_data_mode);
+    state.Write(m_auxspicnt.half);
+    state.Write(m_auxspidata);
+    state.Write(m_romctrl.word);
+    state.Write(m_cardcmd.quad);
+    state.Write(m_transfer.index);
+    state.Write(m_transfer.count);
+    state.Write(m_transfer.data_count);
+
+    // The KEY1 buffers are derived from the ROM and the ARM7 BIOS, so only the pending transfer data is saved.
+    state.WriteBytes(m_transfer.data, m_transfer.data_count * sizeof(u32));
+
+    if(m_backup) {
+      m_backup->SaveState(state);
+    }
+  }
+
+  void Cartridge::LoadState(StateReader& state) {
+    state.Read(m_data_mode);
+    state.Read(m_auxspicnt.half);
+    state.Read(m_auxspidata);
+    state.Read(m_romctrl.word);
+    state.Read(m_cardcmd.quad);
+    state.Read(m_transfer.index);
+    state.Read(m_transfer.count);
+    state.Read(m_transfer.data_count);
+
+    if(m_transfer.data_count < 0 || m_transfer.data_count > 0x1000) {
+      ATOM_ERROR("slot1: save state contains an invalid transfer size: {}", m_transfer.data_count);
+      m_transfer.data_count = 0;
+      state.Fail();
+      return;
+    }
+
+    state.ReadBytes(m_transfer.data, m_transfer.data_count * sizeof(u32));
+
+    if(m_backup) {
+      m_backup->LoadState(state);
+    }
+  }
+
   void Cartridge::SetROM(std::shared_ptr<ROM> rom, std::shared_ptr<arm7::SPI::Device> backup) {
     u32 game_id_code;
     rom->Read((u8*)&game_id_code, 12, sizeof(u32));
@@ -85,9 +130,7 @@ namespace dual::nds {
 
       const int transfer_duration = k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 8;
 
-      m_scheduler.Add(transfer_duration, [this](int _) {
-        HandleCommand();
-      });
+      m_scheduler.Add(transfer_duration, m_event_class_command);
     }
   }
 
@@ -129,22 +172,25 @@ namespace dual::nds {
         for(auto irq : m_irq) irq->Request(IRQ::Source::Cart_DataReady);
       }
     } else {
-      m_scheduler.Add(k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 4, [this](int _) {
-        m_romctrl.data_ready = true;
-
-        // if(exmemcnt.nds_slot_access == EXMEMCNT::CPU::ARM7) {
-        //   dma7.Request(DMA7::Time::Slot1);
-        // } else {
-        //  dma9.Request(DMA9::Time::Slot1);
-        //  }
-        m_dma9.Request(arm9::DMA::StartTime::Slot1);
-        m_dma7.Request(arm7::DMA::StartTime::Slot1);
-      });
+      m_scheduler.Add(k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 4, m_event_class_data_ready);
     }
 
     return data;
   }
 
+  void Cartridge::SignalDataReady() {
+    m_romctrl.data_ready = true;
+
+    // @todo
+    // if(exmemcnt.nds_slot_access == EXMEMCNT::CPU::ARM7) {
+    //   dma7.Request(DMA7::Time::Slot1);
+    // } else {
+    //   dma9.Request(DMA9::Time::Slot1);
+    // }
+    m_dma9.Request(arm9::DMA::StartTime::Slot1);
+    m_dma7.Request(arm7::DMA::StartTime::Slot1);
+  }
+
   void Cartridge::HandleCommand() {
     const auto Unhandled = [this]() {
       const u8* cmd = m_cardcmd.byte;
@@ -320,18 +366,7 @@ namespace dual::nds {
     m_romctrl.busy = m_transfer.data_count != 0;
 
     if(m_romctrl.busy) {
-      m_scheduler.Add(k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 4, [this](int late) {
-        m_romctrl.data_ready = true;
-
-        // @todo
-        // if(exmemcnt.nds_slot_access == EXMEMCNT::CPU::ARM7) {
-        //   dma7.Request(DMA7::Time::Slot1);
-        // } else {
-        //   dma9.Request(DMA9::Time::Slot1);
-        // }
-        m_dma9.Request(arm9::DMA::StartTime::Slot1);
-        m_dma7.Request(arm7::DMA::StartTime::Slot1);
-      });
+      m_scheduler.Add(k_cycles_per_byte[m_romctrl.transfer_clk_rate] * 4, m_event_class_data_ready);
     } else if(m_auxspicnt.enable_transfer_ready_irq) {
       // @todo
       // if(exmemcnt.nds_slot_access == EXMEMCNT::CPU::ARM7) {
@@ -0,0 +1,103 @@
+#include <dual/nds/cpu_sync.hpp>
+
+namespace dual::nds {
+
+  // Number of polls before a waiting thread starts giving up its time slice.
+  static constexpr int k_spin_count = 4096;
+
+  CPUSync::CPUSync(CycleCounter& cycle_counter_arm9, CycleCounter& cycle_counter_arm7) {
+    m_cycle_counter[(int)CPU::ARM9] = &cycle_counter_arm9;
+    m_cycle_counter[(int)CPU::ARM7] = &cycle_counter_arm7;
+  }
+
+  CPUSync::~CPUSync() {
+    Stop();
+  }
+
+  void CPUSync::Start(arm::CPU& arm7) {
+    Stop();
+
+    m_arm7 = &arm7;
+    m_quit = false;
+
+    // The window must be sampled before the thread is started, so that the thread cannot miss the first one.
+    m_thread = std::thread{[this, window = m_window.load()]() { ThreadMain(window); }};
+  }
+
+  void CPUSync::Stop() {
+    if(!m_thread.joinable()) {
+      return;
+    }
+
+    m_quit = true;
+    m_window.fetch_add(1u);
+    m_window.notify_one();
+    m_thread.join();
+  }
+
+  void CPUSync::Run(arm::CPU& arm9, int cycles, u64 timestamp_target) {
+    m_wait_timestamp[(int)CPU::ARM9] = k_running;
+    m_wait_timestamp[(int)CPU::ARM7] = k_running;
+    m_window_cycles = cycles;
+    m_window_timestamp_target = timestamp_target;
+    m_window_active = true;
+
+    m_window.fetch_add(1u);
+    m_window.notify_one();
+
+    arm9.Run(cycles * 2);
+    m_wait_timestamp[(int)CPU::ARM9] = k_done;
+
+    for(int i = 0; m_wait_timestamp[(int)CPU::ARM7] != k_done; i++) {
+      if(i >= k_spin_count) {
+        std::this_thread::yield();
+      }
+    }
+
+    m_window_active = false;
+  }
+
+  void CPUSync::WaitForTurn(CPU cpu) {
+    const u64 timestamp = m_cycle_counter[(int)cpu]->GetTimestampNow();
+
+    std::atomic<u64>& wait_timestamp_self = m_wait_timestamp[(int)cpu];
+    std::atomic<u64>& wait_timestamp_other = m_wait_timestamp[(int)~cpu];
+
+    wait_timestamp_self = timestamp;
+
+    for(int i = 0;; i++) {
+      const u64 other_timestamp = wait_timestamp_other;
+
+      // Proceed once the other CPU is stopped at a later point in time. On a tie the ARM9 goes first.
+      if(other_timestamp != k_running && (other_timestamp > timestamp || (other_timestamp == timestamp && cpu == CPU::ARM9))) {
+        break;
+      }
+
+      if(i >= k_spin_count) {
+        std::this_thread::yield();
+      }
+    }
+
+    wait_timestamp_self = k_running;
+  }
+
+  void CPUSync::ThreadMain(u64 window) {
+    while(true) {
+      for(int i = 0; m_window == window; i++) {
+        if(i >= k_spin_count) {
+          m_window.wait(window);
+        }
+      }
+
+      window = m_window;
+
+      if(m_quit) {
+        break;
+      }
+
+      m_arm7->RunUntil(m_window_cycles, m_window_timestamp_target);
+      m_wait_timestamp[(int)CPU::ARM7] = k_done;
+    }
+  }
+
+} // namespace dual::nds
@@ -14,6 +14,30 @@ namespace dual::nds {
     for(auto& fifo : m_fifo) fifo = {};
   }
 
+  void IPC::SaveState(StateWriter& state) const {
+    for(const auto& sync : m_sync) {
+      state.Write(sync.word);
+    }
+
+    for(const auto& fifo : m_fifo) {
+      fifo.send.SaveState(state);
+      state.Write(fifo.latch);
+      state.Write(fifo.control.word);
+    }
+  }
+
+  void IPC::LoadState(StateReader& state) {
+    for(auto& sync : m_sync) {
+      state.Read(sync.word);
+    }
+
+    for(auto& fifo : m_fifo) {
+      fifo.send.LoadState(state);
+      state.Read(fifo.latch);
+      state.Read(fifo.control.word);
+    }
+  }
+
   u32 IPC::Read_SYNC(CPU cpu) {
     return m_sync[(int)cpu].word;
   }
@@ -9,6 +9,19 @@ namespace dual::nds {
     m_reg_if = 0u;
   }
 
+  void IRQ::SaveState(StateWriter& state) const {
+    state.Write(m_reg_ime);
+    state.Write(m_reg_ie);
+    state.Write(m_reg_if);
+  }
+
+  void IRQ::LoadState(StateReader& state) {
+    // @note: the IRQ line is part of the CPU state and does not need to be updated.
+    state.Read(m_reg_ime);
+    state.Read(m_reg_ie);
+    state.Read(m_reg_if);
+  }
+
   auto IRQ::GetCPU() -> arm::CPU* {
     return m_cpu;
   }
@@ -0,0 +1,173 @@
+
+#include <atom/logger/logger.hpp>
+#include <dual/common/state.hpp>
+#include <dual/nds/movie.hpp>
+
+namespace dual::nds {
+
+  Movie::Movie(NDS& nds) : m_nds{nds} {
+    m_nds.AcquireDeterminism();
+  }
+
+  Movie::~Movie() {
+    m_nds.ReleaseDeterminism();
+  }
+
+  void Movie::StartRecording() {
+    m_nds.SaveState(m_state);
+    m_events.clear();
+    m_frame_hashes.clear();
+    m_next_event = 0u;
+    m_stats = {.frame = 0, .frame_count = 0, .hash_mismatches = 0, .first_mismatch_frame = -1};
+
+    // The save state does not contain the input state, so record it at the very start of the movie.
+    m_current_input = {
+      .timestamp = m_nds.GetTimestampNow(),
+      .touch_state = m_pending_touch_state.load(std::memory_order_relaxed),
+      .pressed_keys = m_pending_keys.load(std::memory_order_relaxed),
+      .padding = 0u
+    };
+    ApplyInput(m_current_input);
+    m_events.push_back(m_current_input);
+
+    m_mode = Mode::Record;
+  }
+
+  bool Movie::StartPlayback(std::span<const u8> data, bool verify) {
+    StateReader movie{data};
+
+    if(data.size() < sizeof(MovieHeader)) {
+      ATOM_ERROR("the movie is too small");
+      return false;
+    }
+
+    const auto header = movie.Read<MovieHeader>();
+
+    if(header.magic != k_movie_magic) {
+      ATOM_ERROR("the file is not a movie");
+      return false;
+    }
+
+    if(header.version != k_movie_version) {
+      ATOM_ERROR("unsupported movie version: {} (expected {})", header.version, k_movie_version);
+      return false;
+    }
+
+    const size_t payload_size = (size_t)header.state_size + header.event_count * sizeof(InputEvent) + header.frame_count * sizeof(u64);
+
+    if(payload_size != movie.GetRemainingSize()) {
+      ATOM_ERROR("the movie is truncated or corrupted");
+      return false;
+    }
+
+    m_state.resize(header.state_size);
+    m_events.resize(header.event_count);
+    m_frame_hashes.resize(header.frame_count);
+
+    movie.ReadBytes(m_state.data(), m_state.size());
+    movie.ReadBytes(m_events.data(), m_events.size() * sizeof(InputEvent));
+    movie.ReadBytes(m_frame_hashes.data(), m_frame_hashes.size() * sizeof(u64));
+
+    if(!m_nds.LoadState(m_state)) {
+      return false;
+    }
+
+    m_mode = Mode::Playback;
+    m_verify = verify;
+    m_next_event = 0u;
+    m_stats = {.frame = 0, .frame_count = (int)header.frame_count, .hash_mismatches = 0, .first_mismatch_frame = -1};
+    return true;
+  }
+
+  void Movie::Stop() {
+    m_mode = Mode::Idle;
+  }
+
+  void Movie::Save(std::vector<u8>& buffer) const {
+    StateWriter movie{buffer};
+
+    movie.Write(MovieHeader{
+      .magic = k_movie_magic,
+      .version = k_movie_version,
+      .state_size = (u32)m_state.size(),
+      .event_count = (u32)m_events.size(),
+      .frame_count = (u32)m_frame_hashes.size()
+    });
+
+    movie.WriteBytes(m_state.data(), m_state.size());
+    movie.WriteBytes(m_events.data(), m_events.size() * sizeof(InputEvent));
+    movie.WriteBytes(m_frame_hashes.data(), m_frame_hashes.size() * sizeof(u64));
+  }
+
+  bool Movie::RunFrame() {
+    const u64 timestamp_now = m_nds.GetTimestampNow();
+
+    if(m_mode == Mode::Playback) {
+      if(m_stats.frame == m_stats.frame_count) {
+        return false;
+      }
+
+      while(m_next_event < m_events.size() && m_events[m_next_event].timestamp <= timestamp_now) {
+        ApplyInput(m_events[m_next_event++]);
+      }
+    } else {
+      const InputEvent input{
+        .timestamp = timestamp_now,
+        .touch_state = m_pending_touch_state.load(std::memory_order_relaxed),
+        .pressed_keys = m_pending_keys.load(std::memory_order_relaxed),
+        .padding = 0u
+      };
+
+      if(input.pressed_keys != m_current_input.pressed_keys || input.touch_state != m_current_input.touch_state) {
+        ApplyInput(input);
+
+        if(m_mode == Mode::Record) {
+          m_events.push_back(input);
+        }
+      }
+    }
+
+    m_nds.Step(k_cycles_per_frame);
+
+    if(m_mode == Mode::Record) {
+      m_frame_hashes.push_back(HashPresentedFrame());
+    } else if(m_mode == Mode::Playback && m_verify && HashPresentedFrame() != m_frame_hashes[m_stats.frame]) {
+      if(m_stats.hash_mismatches++ == 0) {
+        m_stats.first_mismatch_frame = m_stats.frame;
+      }
+    }
+
+    m_stats.frame++;
+    return true;
+  }
+
+  void Movie::SetKeyState(u16 pressed_keys) {
+    m_pending_keys.store(pressed_keys, std::memory_order_relaxed);
+  }
+
+  void Movie::SetTouchState(bool pen_down, u8 x, u8 y) {
+    m_pending_touch_state.store((pen_down ? 0x10000u : 0u) | (u32)y << 8 | x, std::memory_order_relaxed);
+  }
+
+  void Movie::ApplyInput(const InputEvent& event) {
+    m_nds.SetKeyState(event.pressed_keys);
+    m_nds.SetTouchState(event.touch_state & 0x10000u, (u8)event.touch_state, (u8)(event.touch_state >> 8));
+    m_current_input = event;
+  }
+
+  u64 Movie::HashPresentedFrame() {
+    // 64-bit FNV-1a over the pixels of both screens
+    u64 hash = 0xCBF29CE484222325ull;
+
+    for(int id = 0; id < 2; id++) {
+      const u32* frame_buffer = m_nds.GetVideoUnit().GetPPU(id).GetPresentedFrameBuffer();
+
+      for(int i = 0; i < 256 * 192; i++) {
+        hash = (hash ^ frame_buffer[i]) * 0x100000001B3ull;
+      }
+    }
+
+    return hash;
+  }
+
+} // namespace dual::nds
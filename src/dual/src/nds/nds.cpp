@@ -1,29 +1,26 @@
 
 #include <algorithm>
+#include <cstddef>
+#include <atom/logger/logger.hpp>
 #include <atom/punning.hpp>
 #include <dual/nds/nds.hpp>
 #include <dual/nds/header.hpp>
 
 #include "arm/arm.hpp"
+#include "arm/cached_arm.hpp"
+
+#ifdef DUAL_JIT_X64
+  #include "arm/jit/jit.hpp"
+#endif
 
 namespace dual::nds {
 
-  NDS::NDS() {
-    m_arm9.cpu = std::make_unique<arm::ARM>(
-      m_arm9.bus,
-      m_scheduler,
-      m_arm9.cycle_counter,
-      arm::CPU::Model::ARM9
-    );
+  NDS::NDS(arm::CPU::Backend cpu_backend) {
+    m_arm9.cpu = CreateCPU<arm::CPU::Model::ARM9>(cpu_backend, m_arm9.bus, m_arm9.cycle_counter);
     m_arm9.cp15 = std::make_unique<arm9::CP15>(m_arm9.cpu.get(), &m_arm9.bus);
     m_arm9.cpu->SetCoprocessor(15, m_arm9.cp15.get());
 
-    m_arm7.cpu = std::make_unique<arm::ARM>(
-      m_arm7.bus,
-      m_scheduler,
-      m_arm7.cycle_counter,
-      arm::CPU::Model::ARM7
-    );
+    m_arm7.cpu = CreateCPU<arm::CPU::Model::ARM7>(cpu_backend, m_arm7.bus, m_arm7.cycle_counter);
 
     m_arm9.irq.SetCPU(m_arm9.cpu.get());
     m_arm7.irq.SetCPU(m_arm7.cpu.get());
@@ -70,25 +67,313 @@ namespace dual::nds {
     m_ipc.Reset();
 
     m_step_target = 0u;
+    m_cpu_sync_count = 0u;
   }
 
   void NDS::Step(int cycles_to_run) {
     const u64 step_target = m_step_target + cycles_to_run;
 
     while(m_scheduler.GetTimestampNow() < step_target) {
-      // @todo: do not sync so tightly when either CPU is halted.
       const u64 target = std::min(m_scheduler.GetTimestampTarget(), step_target);
-      const int cycles = std::min(32, static_cast<int>(target - m_scheduler.GetTimestampNow()));
+      const bool arm9_halted = m_arm9.cpu->GetWaitingForIRQ();
+      const bool arm7_halted = m_arm7.cpu->GetWaitingForIRQ();
+
+      int cycles = static_cast<int>(target - m_scheduler.GetTimestampNow());
+
+      // A halted CPU cannot observe the other CPU until it is woken up by an IRQ,
+      // so the CPUs only need to be kept in lockstep while both of them are running.
+      // If both CPUs are halted, this skips straight to the next event.
+      if(!arm9_halted && !arm7_halted) {
+        cycles = std::min(m_cpu_sync_quantum, cycles);
+      }
 
-      m_arm9.cpu->Run(cycles * 2);
-      m_arm7.cpu->Run(cycles);
+      if(!arm9_halted && !arm7_halted && m_cpu_sync.IsRunning()) {
+        m_cpu_sync.Run(*m_arm9.cpu, cycles, m_scheduler.GetTimestampTarget());
+      } else if(arm9_halted) {
+        // Run the active CPU first, in case it wakes up the halted one.
+        m_arm7.cpu->Run(cycles);
+        m_arm9.cpu->Run(cycles * 2);
+      } else {
+        m_arm9.cpu->Run(cycles * 2);
+        m_arm7.cpu->Run(cycles);
+      }
 
       m_scheduler.AddCycles(cycles);
+      m_cpu_sync_count++;
     }
 
     m_step_target = step_target;
   }
 
+  void NDS::SaveState(std::vector<u8>& buffer) {
+    StateWriter state{buffer};
+
+    // Memory makes up most of the save state.
+    state.Reserve(sizeof(SystemMemory) + 0x100000u);
+
+    state.Write(SaveStateHeader{
+      .magic = k_save_state_magic,
+      .version = k_save_state_version,
+      .game_code = GetGameCode(),
+      .payload_size = 0u
+    });
+
+    SaveSystemState(state, false);
+
+    state.Patch(offsetof(SaveStateHeader, payload_size), (u32)(state.GetOffset() - sizeof(SaveStateHeader)));
+  }
+
+  void NDS::SaveSnapshot(Snapshot& snapshot) {
+    StateWriter state{snapshot.m_state};
+
+    SaveSystemState(state, true);
+    snapshot.SaveMemory(m_memory);
+  }
+
+  void NDS::LoadSnapshot(Snapshot& snapshot) {
+    StateReader state{snapshot.m_state};
+
+    snapshot.LoadMemory(m_memory);
+    LoadSystemState(state, true);
+  }
+
+  void NDS::SaveSystemState(StateWriter& state, bool snapshot) {
+    m_scheduler.SaveState(state);
+
+    m_arm9.cycle_counter.SaveState(state);
+    m_arm7.cycle_counter.SaveState(state);
+    m_arm9.cpu->SaveState(state);
+    m_arm9.cp15->SaveState(state);
+    m_arm7.cpu->SaveState(state);
+
+    // Snapshots copy the memory which is tracked by code pages themselves.
+    if(!snapshot) {
+      state.Write(m_memory.ewram);
+    }
+
+    state.Write(m_memory.pram);
+    state.Write(m_memory.oam);
+    state.Write(m_memory.arm9.dtcm);
+
+    if(!snapshot) {
+      state.Write(m_memory.arm9.itcm);
+      state.Write(m_memory.arm7.iwram);
+      m_memory.swram.SaveState(state);
+    } else {
+      state.Write((u8)m_memory.swram.Read_WRAMCNT());
+    }
+
+    m_memory.vram.SaveState(state);
+
+    m_arm9.bus.SaveState(state);
+    m_arm9.irq.SaveState(state);
+    m_arm9.timer.SaveState(state);
+    m_arm9.dma.SaveState(state);
+    m_arm9.math.SaveState(state);
+
+    m_arm7.bus.SaveState(state);
+    m_arm7.irq.SaveState(state);
+    m_arm7.timer.SaveState(state);
+    m_arm7.dma.SaveState(state);
+    m_arm7.spi.SaveState(state);
+    m_arm7.rtc.SaveState(state);
+    m_arm7.apu.SaveState(state);
+
+    m_ipc.SaveState(state);
+    m_cartridge.SaveState(state);
+
+    if(snapshot) {
+      m_video_unit.SaveSnapshot(state);
+    } else {
+      m_video_unit.SaveState(state);
+    }
+
+    state.Write(m_step_target);
+    state.Write(m_cpu_sync_count);
+  }
+
+  bool NDS::LoadState(std::span<const u8> data) {
+    StateReader state{data};
+
+    if(data.size() < sizeof(SaveStateHeader)) {
+      ATOM_ERROR("the save state is too small");
+      return false;
+    }
+
+    const auto header = state.Read<SaveStateHeader>();
+
+    if(header.magic != k_save_state_magic) {
+      ATOM_ERROR("the file is not a save state");
+      return false;
+    }
+
+    if(header.version != k_save_state_version) {
+      ATOM_ERROR("unsupported save state version: {} (expected {})", header.version, k_save_state_version);
+      return false;
+    }
+
+    if(header.game_code != GetGameCode()) {
+      ATOM_ERROR("the save state has been created for a different ROM");
+      return false;
+    }
+
+    if(header.payload_size != state.GetRemainingSize()) {
+      ATOM_ERROR("the save state is truncated or corrupted");
+      return false;
+    }
+
+    LoadSystemState(state, false);
+
+    if(!state.Good()) {
+      ATOM_ERROR("the save state is truncated or corrupted");
+      return false;
+    }
+    return true;
+  }
+
+  void NDS::LoadSystemState(StateReader& state, bool snapshot) {
+    // The scheduler must be loaded first, so that components can look up their pending events.
+    m_scheduler.LoadState(state);
+
+    m_arm9.cycle_counter.LoadState(state);
+    m_arm7.cycle_counter.LoadState(state);
+    m_arm9.cpu->LoadState(state);
+    m_arm9.cp15->LoadState(state);
+    m_arm7.cpu->LoadState(state);
+
+    if(!snapshot) {
+      state.Read(m_memory.ewram);
+    }
+
+    state.Read(m_memory.pram);
+    state.Read(m_memory.oam);
+    state.Read(m_memory.arm9.dtcm);
+
+    if(!snapshot) {
+      state.Read(m_memory.arm9.itcm);
+      state.Read(m_memory.arm7.iwram);
+      m_memory.swram.LoadState(state);
+      m_memory.code_pages.Invalidate();
+    } else {
+      m_memory.swram.Write_WRAMCNT(state.Read<u8>());
+    }
+
+    m_memory.vram.LoadState(state);
+
+    m_arm9.bus.LoadState(state);
+    m_arm9.irq.LoadState(state);
+    m_arm9.timer.LoadState(state);
+    m_arm9.dma.LoadState(state);
+    m_arm9.math.LoadState(state);
+
+    m_arm7.bus.LoadState(state);
+    m_arm7.irq.LoadState(state);
+    m_arm7.timer.LoadState(state);
+    m_arm7.dma.LoadState(state);
+    m_arm7.spi.LoadState(state);
+    m_arm7.rtc.LoadState(state);
+    m_arm7.apu.LoadState(state);
+
+    m_ipc.LoadState(state);
+    m_cartridge.LoadState(state);
+
+    // Loaded last, because the PPUs refresh their copies of VRAM from the loaded VRAM mapping.
+    if(snapshot) {
+      m_video_unit.LoadSnapshot(state);
+    } else {
+      m_video_unit.LoadState(state);
+    }
+
+    state.Read(m_step_target);
+    state.Read(m_cpu_sync_count);
+
+    if(!state.Good()) {
+      return;
+    }
+
+    // The CPU pipelines are not saved (the cached interpreter and the JIT do not maintain them).
+    // Instead they are refilled from the loaded memory, which is what setting the PC does.
+    for(arm::CPU* cpu : {m_arm9.cpu.get(), m_arm7.cpu.get()}) {
+      const u32 pc = cpu->GetGPR(arm::CPU::GPR::PC);
+
+      cpu->SetGPR(arm::CPU::GPR::PC, pc - (cpu->GetCPSR().thumb ? 4u : 8u));
+    }
+  }
+
+  void NDS::SetKeyState(u16 pressed_keys) {
+    m_input.SetKeyState(pressed_keys);
+  }
+
+  void NDS::SetTouchState(bool pen_down, u8 x, u8 y) {
+    m_input.SetTouchState(pen_down, x, y);
+  }
+
+  void NDS::SetCPUSyncQuantum(int cycles) {
+    if(cycles <= 0) {
+      ATOM_PANIC("invalid CPU sync quantum: {}", cycles);
+    }
+    m_cpu_sync_quantum = cycles;
+  }
+
+  bool NDS::SetARM7ThreadEnable(bool enable) {
+    if(enable) {
+      if(m_determinism_users > 0) {
+        return false;
+      }
+      m_cpu_sync.Start(*m_arm7.cpu);
+    } else {
+      m_cpu_sync.Stop();
+    }
+    return true;
+  }
+
+  void NDS::AcquireDeterminism() {
+    if(m_cpu_sync.IsRunning()) {
+      ATOM_PANIC("deterministic emulation is not possible while the ARM7 runs on its own thread.");
+    }
+    m_determinism_users++;
+  }
+
+  void NDS::ReleaseDeterminism() {
+    m_determinism_users--;
+  }
+
+  auto NDS::GetStats() const -> Stats {
+    Stats stats{
+      .arm9_instructions = m_arm9.cpu->GetExecutedInstructionCount(),
+      .arm7_instructions = m_arm7.cpu->GetExecutedInstructionCount(),
+      .arm9_idle_loop_cycles = m_arm9.cpu->GetIdleLoopSkippedCycles(),
+      .arm7_idle_loop_cycles = m_arm7.cpu->GetIdleLoopSkippedCycles(),
+      .cpu_sync_quantum = m_cpu_sync_quantum,
+      .cpu_sync_count = m_cpu_sync_count,
+      .scheduler_events = m_scheduler.GetEventCount(),
+      .ppu_scanlines_submitted = 0u,
+      .ppu_worker_wakeups = 0u,
+      .ppu_wait_count = 0u,
+      .ppu_wait_time_ns = 0u
+    };
+
+    for(int id = 0; id < 2; id++) {
+      const PPU::Stats& ppu_stats = m_video_unit.GetPPU(id).GetStats();
+
+      stats.ppu_scanlines_submitted += ppu_stats.scanlines_submitted;
+      stats.ppu_worker_wakeups += ppu_stats.worker_wakeups;
+      stats.ppu_wait_count += ppu_stats.wait_count;
+      stats.ppu_wait_time_ns += ppu_stats.wait_time_ns;
+    }
+
+    return stats;
+  }
+
+  u32 NDS::GetGameCode() const {
+    u32 game_code = 0u;
+
+    if(m_rom && m_rom->Size() >= sizeof(Header)) {
+      m_rom->Read((u8*)&game_code, offsetof(Header, game_code), sizeof(u32));
+    }
+    return game_code;
+  }
+
   void NDS::LoadBootROM9(std::span<u8, 0x8000> data) {
     std::copy(data.begin(), data.end(), m_memory.arm9.bios.begin());
   }
@@ -193,4 +478,30 @@ namespace dual::nds {
     m_cartridge.DirectBoot();
   }
 
+  template<arm::CPU::Model model, typename MemoryBus>
+  auto NDS::CreateCPU(
+    arm::CPU::Backend backend,
+    MemoryBus& memory,
+    CycleCounter& cycle_counter
+  ) -> std::unique_ptr<arm::CPU> {
+    switch(backend) {
+      case arm::CPU::Backend::Interpreter: {
+        return std::make_unique<arm::ARM<model, MemoryBus>>(memory, m_scheduler, cycle_counter);
+      }
+      case arm::CPU::Backend::CachedInterpreter: {
+        return std::make_unique<arm::CachedARM<model, MemoryBus>>(memory, m_scheduler, cycle_counter);
+      }
+      case arm::CPU::Backend::JIT: {
+#ifdef DUAL_JIT_X64
+        return std::make_unique<arm::JIT<model, MemoryBus>>(memory, m_scheduler, cycle_counter);
+#else
+        ATOM_WARN("JIT is not supported on this platform, falling back to the cached interpreter");
+        return std::make_unique<arm::CachedARM<model, MemoryBus>>(memory, m_scheduler, cycle_counter);
+#endif
+      }
+    }
+
+    ATOM_PANIC("unknown CPU backend: {}", (int)backend);
+  }
+
 } // namespace dual::nds
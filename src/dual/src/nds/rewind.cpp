@@ -0,0 +1,266 @@
+
+#include <algorithm>
+#include <atom/panic.hpp>
+#include <chrono>
+#include <cstring>
+#include <dual/nds/rewind.hpp>
+
+namespace dual::nds {
+
+  Rewind::Rewind(NDS& nds, const Config& config) : m_nds{nds}, m_config{config}, m_snapshot{std::make_unique<Snapshot>()} {
+    if(config.frames_per_snapshot <= 0) {
+      ATOM_PANIC("invalid number of frames per rewind snapshot: {}", config.frames_per_snapshot);
+    }
+
+    m_nds.AcquireDeterminism();
+    m_timestamp_next_snapshot = m_nds.GetTimestampNow();
+    m_thread = std::thread{&Rewind::ThreadMain, this};
+  }
+
+  Rewind::~Rewind() {
+    {
+      std::lock_guard lock{m_mutex};
+      m_quit = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+    m_nds.ReleaseDeterminism();
+  }
+
+  bool Rewind::Update() {
+    using Clock = std::chrono::steady_clock;
+
+    const u64 timestamp_now = m_nds.GetTimestampNow();
+
+    if(timestamp_now < m_timestamp_next_snapshot) {
+      return false;
+    }
+
+    m_timestamp_next_snapshot = timestamp_now + m_config.frames_per_snapshot * k_cycles_per_frame;
+
+    std::unique_lock lock{m_mutex};
+
+    // Usually the worker has long finished compressing the previous snapshot.
+    WaitForWorker(lock);
+
+    const auto time_start = Clock::now();
+
+    m_nds.SaveSnapshot(*m_snapshot);
+
+    // The worker flattens the snapshot, which is left alone until the job is done.
+    m_job_pending = true;
+
+    m_last_capture_time = std::chrono::duration<double, std::milli>(Clock::now() - time_start).count();
+
+    lock.unlock();
+    m_cv.notify_all();
+    return true;
+  }
+
+  bool Rewind::StepBack() {
+    std::unique_lock lock{m_mutex};
+
+    WaitForWorker(lock);
+
+    if(!m_have_latest) {
+      return false;
+    }
+
+    // Restoring the snapshot only copies the memory pages that have been written since it was taken.
+    if(!m_snapshot->Deserialize(m_latest_buffer)) {
+      ATOM_PANIC("failed to load a rewind snapshot");
+    }
+
+    m_nds.LoadSnapshot(*m_snapshot);
+
+    if(m_deltas.empty()) {
+      m_have_latest = false;
+    } else {
+      ApplyDelta(m_latest_buffer, m_deltas.back());
+      m_memory_used -= m_deltas.back().size();
+      m_deltas.pop_back();
+    }
+
+    m_timestamp_next_snapshot = m_nds.GetTimestampNow() + m_config.frames_per_snapshot * k_cycles_per_frame;
+    return true;
+  }
+
+  void Rewind::Clear() {
+    std::unique_lock lock{m_mutex};
+
+    WaitForWorker(lock);
+
+    m_have_latest = false;
+    m_deltas.clear();
+    m_memory_used = 0u;
+    m_timestamp_next_snapshot = m_nds.GetTimestampNow();
+  }
+
+  auto Rewind::GetStats() const -> Stats {
+    std::lock_guard lock{m_mutex};
+
+    return {
+      .snapshot_count = m_have_latest ? (int)m_deltas.size() + 1 : 0,
+      .memory_used = m_memory_used,
+      .last_capture_time = m_last_capture_time
+    };
+  }
+
+  void Rewind::ThreadMain() {
+    std::unique_lock lock{m_mutex};
+
+    while(true) {
+      m_cv.wait(lock, [this]() { return m_job_pending || m_quit; });
+
+      if(m_quit) {
+        return;
+      }
+
+      // The emulation thread does not touch the snapshot, the pending and the latest buffers while a job is pending.
+      lock.unlock();
+
+      m_snapshot->Serialize(m_pending_buffer);
+
+      if(m_have_latest) {
+        EncodeDelta(m_pending_buffer, m_latest_buffer, m_delta_buffer);
+      }
+
+      std::swap(m_latest_buffer, m_pending_buffer);
+
+      lock.lock();
+
+      if(m_have_latest) {
+        m_deltas.emplace_back(m_delta_buffer.begin(), m_delta_buffer.end());
+        m_memory_used += m_deltas.back().size();
+        EvictSnapshots();
+      }
+
+      m_have_latest = true;
+      m_job_pending = false;
+      m_cv.notify_all();
+    }
+  }
+
+  void Rewind::WaitForWorker(std::unique_lock<std::mutex>& lock) {
+    m_cv.wait(lock, [this]() { return !m_job_pending; });
+  }
+
+  void Rewind::EvictSnapshots() {
+    // Dropping the first delta drops the oldest snapshot, which is the only one that depends on it.
+    while(m_memory_used > m_config.memory_limit && !m_deltas.empty()) {
+      m_memory_used -= m_deltas.front().size();
+      m_deltas.pop_front();
+    }
+  }
+
+  /**
+   * The delta is a sequence of (skipped words, literal words, literal words...) records over the XOR of both states
+   * in units of 64-bit words, preceded by the size of the old state. The states may differ in size,
+   * missing bytes are treated as zero.
+   */
+  void Rewind::EncodeDelta(const std::vector<u8>& state_new, const std::vector<u8>& state_old, std::vector<u8>& delta) {
+    const size_t size = std::max(state_new.size(), state_old.size());
+    const size_t word_count = (size + 7u) / 8u;
+    const size_t common_word_count = std::min(state_new.size(), state_old.size()) / 8u;
+
+    const auto GetWord = [&](size_t index) -> u64 {
+      u64 word_new = 0u;
+      u64 word_old = 0u;
+
+      if(index < common_word_count) [[likely]] {
+        std::memcpy(&word_new, &state_new[index * 8u], sizeof(u64));
+        std::memcpy(&word_old, &state_old[index * 8u], sizeof(u64));
+      } else {
+        const size_t offset = index * 8u;
+
+        if(offset < state_new.size()) std::memcpy(&word_new, &state_new[offset], std::min<size_t>(8u, state_new.size() - offset));
+        if(offset < state_old.size()) std::memcpy(&word_old, &state_old[offset], std::min<size_t>(8u, state_old.size() - offset));
+      }
+      return word_new ^ word_old;
+    };
+
+    const auto Append = [&](const void* data, size_t length) {
+      const size_t offset = delta.size();
+
+      delta.resize(offset + length);
+      std::memcpy(&delta[offset], data, length);
+    };
+
+    delta.clear();
+
+    const u32 old_size = (u32)state_old.size();
+    Append(&old_size, sizeof(u32));
+
+    size_t index = 0u;
+
+    while(index < word_count) {
+      const size_t literal_begin = index;
+
+      while(index < word_count && GetWord(index) == 0u) index++;
+
+      const u32 skip_count = (u32)(index - literal_begin);
+      const size_t header_offset = delta.size();
+
+      u32 literal_count = 0u;
+
+      Append(&skip_count, sizeof(u32));
+      Append(&literal_count, sizeof(u32));
+
+      while(index < word_count) {
+        const u64 word = GetWord(index);
+
+        if(word == 0u) {
+          break;
+        }
+
+        Append(&word, sizeof(u64));
+        literal_count++;
+        index++;
+      }
+
+      std::memcpy(&delta[header_offset + sizeof(u32)], &literal_count, sizeof(u32));
+    }
+  }
+
+  void Rewind::ApplyDelta(std::vector<u8>& state, const std::vector<u8>& delta) {
+    u32 old_size;
+    std::memcpy(&old_size, &delta[0], sizeof(u32));
+
+    const size_t word_count = (std::max<size_t>(state.size(), old_size) + 7u) / 8u;
+
+    state.resize(word_count * 8u);
+
+    size_t offset = sizeof(u32);
+    size_t index = 0u;
+
+    while(offset < delta.size()) {
+      u32 skip_count;
+      u32 literal_count;
+
+      std::memcpy(&skip_count, &delta[offset], sizeof(u32));
+      std::memcpy(&literal_count, &delta[offset + sizeof(u32)], sizeof(u32));
+      offset += 2u * sizeof(u32);
+      index += skip_count;
+
+      if(index + literal_count > word_count || offset + literal_count * sizeof(u64) > delta.size()) {
+        ATOM_PANIC("corrupted rewind snapshot");
+      }
+
+      for(u32 i = 0; i < literal_count; i++) {
+        u64 word;
+        u64 delta_word;
+
+        std::memcpy(&word, &state[index * 8u], sizeof(u64));
+        std::memcpy(&delta_word, &delta[offset], sizeof(u64));
+        word ^= delta_word;
+        std::memcpy(&state[index * 8u], &word, sizeof(u64));
+
+        offset += sizeof(u64);
+        index++;
+      }
+    }
+
+    state.resize(old_size);
+  }
+
+} // namespace dual::nds
@@ -0,0 +1,54 @@
+
+#include <atom/panic.hpp>
+#include <chrono>
+#include <dual/nds/run_ahead.hpp>
+
+namespace dual::nds {
+
+  RunAhead::RunAhead(NDS& nds, int frame_count) : m_nds{nds}, m_frame_count{frame_count} {
+    if(frame_count <= 0) {
+      ATOM_PANIC("invalid number of frames to run ahead: {}", frame_count);
+    }
+
+    m_snapshot = std::make_unique<Snapshot>();
+    m_nds.AcquireDeterminism();
+  }
+
+  RunAhead::~RunAhead() {
+    m_nds.ReleaseDeterminism();
+    m_nds.GetVideoUnit().SetEnableRendering(true);
+  }
+
+  void RunAhead::RunFrame() {
+    using Clock = std::chrono::steady_clock;
+
+    VideoUnit& video_unit = m_nds.GetVideoUnit();
+    arm7::APU& apu = m_nds.GetAPU();
+
+    // Video frames begin at multiples of k_cycles_per_frame, the first frame may thus be shorter.
+    const u64 frame_phase = (m_nds.GetTimestampNow() + k_cycles_per_frame - k_frame_boundary) % k_cycles_per_frame;
+
+    video_unit.SetEnableRendering(false);
+    m_nds.Step(k_cycles_per_frame - (int)frame_phase);
+
+    auto time_start = Clock::now();
+    m_nds.SaveSnapshot(*m_snapshot);
+    m_stats.last_save_time = std::chrono::duration<double, std::milli>(Clock::now() - time_start).count();
+
+    const bool enable_audio = apu.GetEnableOutput();
+
+    apu.SetEnableOutput(false);
+
+    for(int i = 1; i <= m_frame_count; i++) {
+      video_unit.SetEnableRendering(i == m_frame_count);
+      m_nds.Step(k_cycles_per_frame);
+    }
+
+    apu.SetEnableOutput(enable_audio);
+
+    time_start = Clock::now();
+    m_nds.LoadSnapshot(*m_snapshot);
+    m_stats.last_load_time = std::chrono::duration<double, std::milli>(Clock::now() - time_start).count();
+  }
+
+} // namespace dual::nds
@@ -0,0 +1,92 @@
+
+#include <atom/panic.hpp>
+#include <cstring>
+#include <dual/common/state.hpp>
+#include <dual/nds/snapshot.hpp>
+
+namespace dual::nds {
+
+  template<size_t size>
+  void Snapshot::TrackedMemory<size>::Save(const std::array<u8, size>& memory, const std::array<u32, k_page_count>& memory_versions, bool copy_all) {
+    for(size_t page = 0; page < k_page_count; page++) {
+      if(copy_all || versions[page] != memory_versions[page]) {
+        std::memcpy(&data[page * k_page_size], &memory[page * k_page_size], k_page_size);
+        versions[page] = memory_versions[page];
+      }
+    }
+  }
+
+  template<size_t size>
+  void Snapshot::TrackedMemory<size>::Load(std::array<u8, size>& memory, std::array<u32, k_page_count>& memory_versions) {
+    for(size_t page = 0; page < k_page_count; page++) {
+      if(versions[page] != memory_versions[page]) {
+        std::memcpy(&memory[page * k_page_size], &data[page * k_page_size], k_page_size);
+
+        // The page changed, so code compiled from it must be invalidated. Never go back to an older version.
+        versions[page] = ++memory_versions[page];
+      }
+    }
+  }
+
+  void Snapshot::Serialize(std::vector<u8>& buffer) const {
+    StateWriter state{buffer};
+
+    if(!m_valid) {
+      ATOM_PANIC("attempted to serialize an empty snapshot");
+    }
+
+    state.Reserve(sizeof(u32) + m_state.size() + sizeof(m_ewram) + sizeof(m_swram) + sizeof(m_itcm) + sizeof(m_iwram));
+    state.Write((u32)m_state.size());
+    state.WriteBytes(m_state.data(), m_state.size());
+    state.Write(m_ewram);
+    state.Write(m_swram);
+    state.Write(m_itcm);
+    state.Write(m_iwram);
+  }
+
+  bool Snapshot::Deserialize(std::span<const u8> data) {
+    StateReader state{data};
+
+    const u32 state_size = state.Read<u32>();
+
+    if(state_size > state.GetRemainingSize()) {
+      m_valid = false;
+      return false;
+    }
+
+    m_state.resize(state_size);
+    state.ReadBytes(m_state.data(), m_state.size());
+    state.Read(m_ewram);
+    state.Read(m_swram);
+    state.Read(m_itcm);
+    state.Read(m_iwram);
+
+    m_valid = state.Good() && state.GetRemainingSize() == 0u;
+    return m_valid;
+  }
+
+  void Snapshot::SaveMemory(SystemMemory& memory) {
+    CodePages& code_pages = memory.code_pages;
+
+    m_ewram.Save(memory.ewram, code_pages.ewram, !m_valid);
+    m_swram.Save(memory.swram.m_swram, code_pages.swram, !m_valid);
+    m_itcm.Save(memory.arm9.itcm, code_pages.itcm, !m_valid);
+    m_iwram.Save(memory.arm7.iwram, code_pages.iwram, !m_valid);
+
+    m_valid = true;
+  }
+
+  void Snapshot::LoadMemory(SystemMemory& memory) {
+    CodePages& code_pages = memory.code_pages;
+
+    if(!m_valid) {
+      ATOM_PANIC("attempted to load an empty snapshot");
+    }
+
+    m_ewram.Load(memory.ewram, code_pages.ewram);
+    m_swram.Load(memory.swram.m_swram, code_pages.swram);
+    m_itcm.Load(memory.arm9.itcm, code_pages.itcm);
+    m_iwram.Load(memory.arm7.iwram, code_pages.iwram);
+  }
+
+} // namespace dual::nds
@@ -8,6 +8,16 @@ namespace dual::nds {
     Write_WRAMCNT(3u);
   }
 
+  void SWRAM::SaveState(StateWriter& state) const {
+    state.Write(m_swram);
+    state.Write(m_wramcnt);
+  }
+
+  void SWRAM::LoadState(StateReader& state) {
+    state.Read(m_swram);
+    Write_WRAMCNT(state.Read<u8>());
+  }
+
   u32 SWRAM::Read_WRAMCNT() {
     return m_wramcnt;
   }
@@ -19,26 +29,33 @@ namespace dual::nds {
       return;
     }
 
+    constexpr int page_shift = CodePages::k_page_shift;
+
+    u32* code_pages = m_code_pages.swram.data();
+
     switch(allocation) {
       case 0b00:
-        arm9 = { &m_swram[0], 0x7FFFu };
-        arm7 = { nullptr, 0u };
+        arm9 = { &m_swram[0], 0x7FFFu, code_pages };
+        arm7 = { nullptr, 0u, nullptr };
         break;
       case 0b01:
-        arm9 = { &m_swram[0x4000], 0x3FFFu };
-        arm7 = { &m_swram[0x0000], 0x3FFFu };
+        arm9 = { &m_swram[0x4000], 0x3FFFu, &code_pages[0x4000 >> page_shift] };
+        arm7 = { &m_swram[0x0000], 0x3FFFu, code_pages };
         break;
       case 0b10:
-        arm9 = { &m_swram[0x0000], 0x3FFFu };
-        arm7 = { &m_swram[0x4000], 0x3FFFu };
+        arm9 = { &m_swram[0x0000], 0x3FFFu, code_pages };
+        arm7 = { &m_swram[0x4000], 0x3FFFu, &code_pages[0x4000 >> page_shift] };
         break;
       default:
-        arm9 = { nullptr, 0u };
-        arm7 = { &m_swram[0], 0x7FFFu };
+        arm9 = { nullptr, 0u, nullptr };
+        arm7 = { &m_swram[0], 0x7FFFu, code_pages };
         break;
     }
 
     m_wramcnt = allocation;
+    m_code_pages.Invalidate();
+
+    for(const auto& callback : m_callbacks) callback();
   }
 
 } // namespace dual::nds
\ No newline at end of file
@@ -7,12 +7,36 @@ namespace dual::nds {
       : m_scheduler{scheduler}
       , m_cpu_cycle_counter{cpu_cycle_counter}
       , m_irq{irq} {
+    m_event_class_overflow = scheduler.Register<&Timer::OnOverflowEvent>(this);
   }
 
   void Timer::Reset() {
     for(auto& channel : m_channel) channel = {};
   }
 
+  void Timer::SaveState(StateWriter& state) const {
+    for(const auto& channel : m_channel) {
+      state.Write(channel.tmcnt.word);
+      state.Write(channel.counter);
+      state.Write(channel.divider_shift);
+      state.Write(channel.timestamp_last_reload);
+    }
+  }
+
+  void Timer::LoadState(StateReader& state) {
+    for(int id = 0; id < 4; id++) {
+      auto& channel = m_channel[id];
+
+      state.Read(channel.tmcnt.word);
+      state.Read(channel.counter);
+      state.Read(channel.divider_shift);
+      state.Read(channel.timestamp_last_reload);
+
+      // @note: the scheduler must have been loaded already.
+      channel.event = m_scheduler.FindEvent(m_event_class_overflow, id);
+    }
+  }
+
   auto Timer::Read_TMCNT(int id) -> u32 {
     auto& channel = m_channel[id];
 
@@ -67,15 +91,20 @@ namespace dual::nds {
 
     const uint cycles = (0x10000u - channel.counter) << channel.divider_shift;
 
-    // @todo: do not recreate the lambda every time the timer overflows
-    channel.event = m_scheduler.Add(cycles + cycle_offset, [=, this](int cycles_late) {
-      DoOverflow(id);
-      ScheduleTimerOverflow(id, -cycles_late);
-    });
-
+    // The overflow event queues itself again in-place, other callers have cancelled the pending event.
+    if(channel.event != nullptr) {
+      m_scheduler.Reschedule(channel.event, cycles + cycle_offset);
+    } else {
+      channel.event = m_scheduler.Add(cycles + cycle_offset, m_event_class_overflow, id);
+    }
     channel.timestamp_last_reload = m_cpu_cycle_counter.GetTimestampNow();
   }
 
+  void Timer::OnOverflowEvent(int id, int cycles_late) {
+    DoOverflow(id);
+    ScheduleTimerOverflow(id, -cycles_late);
+  }
+
   void Timer::DoOverflow(int id) {
     auto& channel = m_channel[id];
 
@@ -12,6 +12,7 @@ namespace dual::nds::gpu {
       , m_arm9_irq{arm9_irq}
       , m_gxstat{io.gxstat}
       , m_geometry_engine{geometry_engine} {
+    m_event_class_process_commands = scheduler.Register<&CommandProcessor::ProcessCommands>(this);
   }
 
   void CommandProcessor::Reset() {
@@ -25,6 +26,60 @@ namespace dual::nds::gpu {
     m_clip_mtx_dirty = false;
   }
 
+  void CommandProcessor::SaveState(StateWriter& state) const {
+    const auto WriteMatrix = [&](const Matrix4<Fixed20x12>& matrix) {
+      for(int col = 0; col < 4; col++) {
+        for(int row = 0; row < 4; row++) state.Write(matrix[col][row].Raw());
+      }
+    };
+
+    state.Write(m_gxstat.word);
+    state.Write(m_unpack);
+    m_cmd_pipe.SaveState(state);
+    m_cmd_fifo.SaveState(state);
+
+    state.Write(m_mtx_mode);
+    WriteMatrix(m_projection_mtx_stack);
+    for(const auto& matrix : m_coordinate_mtx_stack) WriteMatrix(matrix);
+    for(const auto& matrix : m_direction_mtx_stack) WriteMatrix(matrix);
+    WriteMatrix(m_texture_mtx_stack);
+    WriteMatrix(m_projection_mtx);
+    WriteMatrix(m_coordinate_mtx);
+    WriteMatrix(m_direction_mtx);
+    WriteMatrix(m_texture_mtx);
+    state.Write(m_projection_mtx_index);
+    state.Write(m_coordinate_mtx_index);
+    state.Write(m_texture_mtx_index);
+    state.Write(m_clip_mtx_dirty);
+  }
+
+  void CommandProcessor::LoadState(StateReader& state) {
+    const auto ReadMatrix = [&](Matrix4<Fixed20x12>& matrix) {
+      for(int col = 0; col < 4; col++) {
+        for(int row = 0; row < 4; row++) matrix[col][row] = state.Read<i32>();
+      }
+    };
+
+    state.Read(m_gxstat.word);
+    state.Read(m_unpack);
+    m_cmd_pipe.LoadState(state);
+    m_cmd_fifo.LoadState(state);
+
+    state.Read(m_mtx_mode);
+    ReadMatrix(m_projection_mtx_stack);
+    for(auto& matrix : m_coordinate_mtx_stack) ReadMatrix(matrix);
+    for(auto& matrix : m_direction_mtx_stack) ReadMatrix(matrix);
+    ReadMatrix(m_texture_mtx_stack);
+    ReadMatrix(m_projection_mtx);
+    ReadMatrix(m_coordinate_mtx);
+    ReadMatrix(m_direction_mtx);
+    ReadMatrix(m_texture_mtx);
+    state.Read(m_projection_mtx_index);
+    state.Read(m_coordinate_mtx_index);
+    state.Read(m_texture_mtx_index);
+    state.Read(m_clip_mtx_dirty);
+  }
+
   void CommandProcessor::EnqueueFIFO(u8 command, u32 param) {
     const u64 entry = (u64)command << 32 | param;
 
@@ -148,9 +203,7 @@ namespace dual::nds::gpu {
 
     m_gxstat.busy = true;
     // @todo: think of a more efficient solution.
-    m_scheduler.Add(1, [this](int _) {
-      ProcessCommands();
-    });
+    m_scheduler.Add(1, m_event_class_process_commands);
   }
 
   void CommandProcessor::ExecuteCommand(u8 command) {
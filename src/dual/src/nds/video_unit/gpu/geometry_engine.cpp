@@ -10,6 +10,15 @@ namespace dual::nds::gpu {
     for(auto& ram : m_polygon_ram) ram.Clear();
   }
 
+  void GeometryEngine::SaveState(StateWriter& state) const {
+    // @todo: save vertex and polygon RAM once the geometry engine populates them.
+    for(int i = 0; i < 3; i++) state.Write(m_last_position[i].Raw());
+  }
+
+  void GeometryEngine::LoadState(StateReader& state) {
+    for(int i = 0; i < 3; i++) m_last_position[i] = state.Read<i32>();
+  }
+
   void GeometryEngine::SubmitVertex(Vector3<Fixed20x12> position) {
     // ...
   }
@@ -19,4 +19,14 @@ namespace dual::nds {
     m_geometry_engine.Reset();
   }
 
+  void GPU::SaveState(StateWriter& state) const {
+    m_cmd_processor.SaveState(state);
+    m_geometry_engine.SaveState(state);
+  }
+
+  void GPU::LoadState(StateReader& state) {
+    m_cmd_processor.LoadState(state);
+    m_geometry_engine.LoadState(state);
+  }
+
 } // namespace dual::nds
@@ -1,10 +1,14 @@
 
 #include <dual/nds/video_unit/ppu/ppu.hpp>
 
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
 namespace dual::nds {
 
   template<bool window, bool blending, bool opengl>
-  void PPU::ComposeScanlineTmpl(u16 vcount, int bg_min, int bg_max) {
+  void PPU::ComposeScanlineTmpl(RenderContext& context, u16 vcount, int bg_min, int bg_max) {
     auto& mmio = m_mmio_copy[vcount];
 
     u16 backdrop = ReadPalette(0, 0);
@@ -42,8 +46,8 @@ namespace dual::nds {
     atom::Bits<0, 6, u8> win_layer_enable{};
 
     if constexpr (window) {
-      win0_active = dispcnt.enable[ENABLE_WIN0] && m_window_scanline_enable[0];
-      win1_active = dispcnt.enable[ENABLE_WIN1] && m_window_scanline_enable[1];
+      win0_active = dispcnt.enable[ENABLE_WIN0] && mmio.window_scanline_enable[0];
+      win1_active = dispcnt.enable[ENABLE_WIN1] && mmio.window_scanline_enable[1];
       win2_active = dispcnt.enable[ENABLE_OBJWIN];
     }
 
@@ -56,11 +60,11 @@ namespace dual::nds {
     for(int x = 0; x < 256; x++) {
       if constexpr (window) {
         // Determine the window with the highest priority for this pixel.
-        if(win0_active && m_buffer_win[0][x]) {
+        if(win0_active && context.buffer_win[0][x]) {
           win_layer_enable = (u8)winin.win0_layer_enable;
-        } else if(win1_active && m_buffer_win[1][x]) {
+        } else if(win1_active && context.buffer_win[1][x]) {
           win_layer_enable = (u8)winin.win1_layer_enable;
-        } else if(win2_active && m_buffer_obj[x].window) {
+        } else if(win2_active && (context.buffer_obj[x].flags & OBJ_PIXEL_WINDOW)) {
           win_layer_enable = (u8)winout.win1_layer_enable;
         } else {
           win_layer_enable = (u8)winout.win0_layer_enable;
@@ -80,7 +84,7 @@ namespace dual::nds {
           int bg = bg_list[i];
 
           if(!window || win_layer_enable[bg]) {
-            auto pixel_new = m_buffer_bg[bg][x];
+            auto pixel_new = context.buffer_bg[bg][x];
             if(pixel_new != k_color_transparent) {
               layer[1] = layer[0];
               layer[0] = bg;
@@ -95,13 +99,13 @@ namespace dual::nds {
          */
         if((!window || win_layer_enable[LAYER_OBJ]) &&
             dispcnt.enable[ENABLE_OBJ] &&
-            m_buffer_obj[x].color != k_color_transparent) {
-          int priority = m_buffer_obj[x].priority;
+            context.buffer_obj[x].color != k_color_transparent) {
+          int priority = context.buffer_obj[x].priority;
 
           if(priority <= prio[0]) {
             layer[1] = layer[0];
             layer[0] = LAYER_OBJ;
-            is_alpha_obj = m_buffer_obj[x].alpha;
+            is_alpha_obj = context.buffer_obj[x].flags & OBJ_PIXEL_ALPHA;
 
             if constexpr(opengl) {
               prio[0] = priority;
@@ -122,10 +126,10 @@ namespace dual::nds {
           switch(_layer) {
             case 0: case 1:
             case 2: case 3:
-              pixel[i] = m_buffer_bg[_layer][x];
+              pixel[i] = context.buffer_bg[_layer][x];
               break;
             case 4:
-              pixel[i] = m_buffer_obj[x].color;
+              pixel[i] = context.buffer_obj[x].color;
               break;
             case 5:
               pixel[i] = backdrop;
@@ -155,7 +159,7 @@ namespace dual::nds {
           } if(blend_mode == BlendControl::Mode::Alpha) {
             // @todo: what does HW do if "enable BG0 3D" is disabled in mode 6.
             if(layer[0] == 0 && bg0_is_3d && have_src) {
-              const int eva = m_buffer_3d_alpha[x];
+              const int eva = context.buffer_3d_alpha[x];
               const int evb = 16 - eva;
 
               pixel[0] = AlphaBlend(pixel[0], pixel[1], eva, evb);
@@ -190,7 +194,7 @@ namespace dual::nds {
             int bg = bg_list[i];
 
             if(!window || win_layer_enable[bg]) {
-              u16 pixel_new = m_buffer_bg[bg][x];
+              u16 pixel_new = context.buffer_bg[bg][x];
               if(pixel_new != k_color_transparent) {
                 pixel[0] = pixel_new;
                 layer[0] = bg;
@@ -207,11 +211,11 @@ namespace dual::nds {
         // Check if a OBJ pixel takes priority over the top-most background pixel.
         if((!window || win_layer_enable[LAYER_OBJ]) &&
             dispcnt.enable[ENABLE_OBJ] &&
-            m_buffer_obj[x].color != k_color_transparent &&
-            m_buffer_obj[x].priority <= prio[0]) {
-          pixel[0] = m_buffer_obj[x].color;
+            context.buffer_obj[x].color != k_color_transparent &&
+            context.buffer_obj[x].priority <= prio[0]) {
+          pixel[0] = context.buffer_obj[x].color;
           layer[0] = LAYER_OBJ;
-          prio[0] = m_buffer_obj[x].priority;
+          prio[0] = context.buffer_obj[x].priority;
         }
 
         if constexpr(opengl) {
@@ -221,14 +225,241 @@ namespace dual::nds {
       }
 
       if constexpr(!opengl) {
-        m_buffer_compose[x] = pixel[0] | 0x8000;
+        context.buffer_compose[x] = pixel[0] | 0x8000;
       }
 
       buffer_index++;
     }
   }
 
-  void PPU::ComposeScanline(u16 vcount, int bg_min, int bg_max) {
+#if defined(__SSE2__)
+
+  /* SSE2 is part of the x86-64 baseline, so unlike SSE4.1 or AVX2 it is always available without runtime dispatch.
+   * The helpers below operate on eight BGR555 pixels at once and match AlphaBlend(), Brighten() and Darken() exactly.
+   */
+  static inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+  }
+
+  static inline __m128i HasAnyBit(__m128i value, __m128i bits) {
+    return _mm_andnot_si128(_mm_cmpeq_epi16(_mm_and_si128(value, bits), _mm_setzero_si128()), _mm_set1_epi16(-1));
+  }
+
+  static inline __m128i AlphaBlendSSE2(__m128i color_a, __m128i color_b, __m128i eva, __m128i evb) {
+    const __m128i mask = _mm_set1_epi16(0x1F);
+
+    __m128i result = _mm_setzero_si128();
+
+    for(int shift : {0, 5, 10}) {
+      const __m128i channel_a = _mm_and_si128(_mm_srli_epi16(color_a, shift), mask);
+      const __m128i channel_b = _mm_and_si128(_mm_srli_epi16(color_b, shift), mask);
+      const __m128i channel = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(channel_a, eva), _mm_mullo_epi16(channel_b, evb)), 4);
+
+      result = _mm_or_si128(result, _mm_slli_epi16(_mm_min_epi16(channel, mask), shift));
+    }
+
+    return result;
+  }
+
+  static inline __m128i BrightenSSE2(__m128i color, __m128i evy) {
+    const __m128i mask = _mm_set1_epi16(0x1F);
+
+    __m128i result = _mm_setzero_si128();
+
+    for(int shift : {0, 5, 10}) {
+      const __m128i channel = _mm_and_si128(_mm_srli_epi16(color, shift), mask);
+
+      result = _mm_or_si128(result, _mm_slli_epi16(_mm_add_epi16(channel, _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(mask, channel), evy), 4)), shift));
+    }
+
+    return result;
+  }
+
+  static inline __m128i DarkenSSE2(__m128i color, __m128i evy) {
+    const __m128i mask = _mm_set1_epi16(0x1F);
+
+    __m128i result = _mm_setzero_si128();
+
+    for(int shift : {0, 5, 10}) {
+      const __m128i channel = _mm_and_si128(_mm_srli_epi16(color, shift), mask);
+
+      result = _mm_or_si128(result, _mm_slli_epi16(_mm_sub_epi16(channel, _mm_srli_epi16(_mm_mullo_epi16(channel, evy), 4)), shift));
+    }
+
+    return result;
+  }
+
+  // Loads eight window flags (bool) as 16-bit masks.
+  static inline __m128i LoadWindowMask(const bool* buffer) {
+    const __m128i flags = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)buffer), _mm_setzero_si128());
+
+    return _mm_cmpgt_epi16(flags, _mm_setzero_si128());
+  }
+
+  /**
+   * Vectorized version of ComposeScanlineTmpl(), which processes eight pixels at once.
+   * Instead of the layer numbers it tracks the layer bits, which can be tested against the blend targets directly.
+   */
+  template<bool window, bool blending>
+  void PPU::ComposeScanlineSSE2(RenderContext& context, u16 vcount, int bg_min, int bg_max) {
+    const auto& mmio = m_mmio_copy[vcount];
+
+    const auto& dispcnt = mmio.dispcnt;
+    const auto& bgcnt = mmio.bgcnt;
+    const auto& winin = mmio.winin;
+    const auto& winout = mmio.winout;
+
+    int bg_list[4];
+    int bg_count = 0;
+
+    // Sort enabled backgrounds by their respective priority in ascending order.
+    for(int prio = 3; prio >= 0; prio--) {
+      for(int bg = bg_max; bg >= bg_min; bg--) {
+        if(dispcnt.enable[bg] && bgcnt[bg].priority == prio) {
+          bg_list[bg_count++] = bg;
+        }
+      }
+    }
+
+    const __m128i ones = _mm_set1_epi16(-1);
+    const __m128i transparent = _mm_set1_epi16((s16)k_color_transparent);
+    const __m128i backdrop = _mm_set1_epi16((s16)ReadPalette(0, 0));
+    const __m128i backdrop_bit = _mm_set1_epi16(1 << LAYER_BD);
+    const __m128i backdrop_prio = _mm_set1_epi16(4);
+    const __m128i obj_bit = _mm_set1_epi16(1 << LAYER_OBJ);
+    const __m128i obj_enable = dispcnt.enable[ENABLE_OBJ] ? ones : _mm_setzero_si128();
+
+    const bool win0_active = window && dispcnt.enable[ENABLE_WIN0] && mmio.window_scanline_enable[0];
+    const bool win1_active = window && dispcnt.enable[ENABLE_WIN1] && mmio.window_scanline_enable[1];
+    const bool win2_active = window && dispcnt.enable[ENABLE_OBJWIN];
+
+    const __m128i win0_layer_enable = _mm_set1_epi16((s16)winin.win0_layer_enable);
+    const __m128i win1_layer_enable = _mm_set1_epi16((s16)winin.win1_layer_enable);
+    const __m128i objwin_layer_enable = _mm_set1_epi16((s16)winout.win1_layer_enable);
+    const __m128i outside_layer_enable = _mm_set1_epi16((s16)winout.win0_layer_enable);
+
+    const auto blend_mode = (BlendControl::Mode)mmio.bldcnt.blend_mode;
+    const __m128i dst_targets = _mm_set1_epi16((s16)mmio.bldcnt.dst_targets);
+    const __m128i src_targets = _mm_set1_epi16((s16)mmio.bldcnt.src_targets);
+    const __m128i eva = _mm_set1_epi16((s16)std::min<int>(16, mmio.bldalpha.a));
+    const __m128i evb = _mm_set1_epi16((s16)std::min<int>(16, mmio.bldalpha.b));
+    const __m128i evy = _mm_set1_epi16((s16)std::min<int>(16, mmio.bldy.half));
+
+    for(int x = 0; x < 256; x += 8) {
+      // Unpack the OBJ pixels (color | priority << 16 | flags << 24) into 16-bit lanes.
+      const __m128i obj_lo = _mm_loadu_si128((const __m128i*)&context.buffer_obj[x + 0]);
+      const __m128i obj_hi = _mm_loadu_si128((const __m128i*)&context.buffer_obj[x + 4]);
+      const __m128i obj_color = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(obj_lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(obj_hi, 16), 16));
+      const __m128i obj_attr  = _mm_packs_epi32(_mm_srai_epi32(obj_lo, 16), _mm_srai_epi32(obj_hi, 16));
+      const __m128i obj_prio  = _mm_and_si128(obj_attr, _mm_set1_epi16(0xFF));
+
+      __m128i layer_enable = ones;
+
+      if constexpr(window) {
+        // Apply the windows from the lowest to the highest priority.
+        layer_enable = outside_layer_enable;
+
+        if(win2_active) {
+          layer_enable = Select(HasAnyBit(obj_attr, _mm_set1_epi16(OBJ_PIXEL_WINDOW << 8)), objwin_layer_enable, layer_enable);
+        }
+
+        if(win1_active) {
+          layer_enable = Select(LoadWindowMask(&context.buffer_win[1][x]), win1_layer_enable, layer_enable);
+        }
+
+        if(win0_active) {
+          layer_enable = Select(LoadWindowMask(&context.buffer_win[0][x]), win0_layer_enable, layer_enable);
+        }
+      }
+
+      __m128i top_color = backdrop;
+      __m128i top_bit = backdrop_bit;
+      __m128i top_prio = backdrop_prio;
+      __m128i bottom_color = backdrop;
+      __m128i bottom_bit = backdrop_bit;
+      __m128i bottom_prio = backdrop_prio;
+
+      // Find up to two top-most visible background pixels.
+      for(int i = 0; i < bg_count; i++) {
+        const int bg = bg_list[i];
+
+        const __m128i bg_bit = _mm_set1_epi16((s16)(1 << bg));
+        const __m128i color = _mm_loadu_si128((const __m128i*)&context.buffer_bg[bg][x]);
+
+        __m128i visible = _mm_andnot_si128(_mm_cmpeq_epi16(color, transparent), ones);
+
+        if constexpr(window) {
+          visible = _mm_and_si128(visible, HasAnyBit(layer_enable, bg_bit));
+        }
+
+        if constexpr(blending) {
+          bottom_color = Select(visible, top_color, bottom_color);
+          bottom_bit = Select(visible, top_bit, bottom_bit);
+          bottom_prio = Select(visible, top_prio, bottom_prio);
+
+          // Like ComposeScanlineTmpl(), only the blending path compares the OBJ priority against the background priority.
+          top_prio = Select(visible, _mm_set1_epi16((s16)bgcnt[bg].priority), top_prio);
+        }
+
+        top_color = Select(visible, color, top_color);
+        top_bit = Select(visible, bg_bit, top_bit);
+      }
+
+      // Insert the OBJ pixel if it takes priority over one of the two top-most background pixels.
+      __m128i obj_visible = _mm_andnot_si128(_mm_cmpeq_epi16(obj_color, transparent), obj_enable);
+
+      if constexpr(window) {
+        obj_visible = _mm_and_si128(obj_visible, HasAnyBit(layer_enable, obj_bit));
+      }
+
+      const __m128i obj_above_top = _mm_andnot_si128(_mm_cmpgt_epi16(obj_prio, top_prio), obj_visible);
+
+      if constexpr(blending) {
+        const __m128i obj_above_bottom = _mm_andnot_si128(obj_above_top, _mm_andnot_si128(_mm_cmpgt_epi16(obj_prio, bottom_prio), obj_visible));
+
+        bottom_color = Select(obj_above_top, top_color, Select(obj_above_bottom, obj_color, bottom_color));
+        bottom_bit = Select(obj_above_top, top_bit, Select(obj_above_bottom, obj_bit, bottom_bit));
+      }
+
+      top_color = Select(obj_above_top, obj_color, top_color);
+      top_bit = Select(obj_above_top, obj_bit, top_bit);
+
+      __m128i color = top_color;
+
+      if constexpr(blending) {
+        const __m128i is_alpha_obj = _mm_and_si128(obj_above_top, HasAnyBit(obj_attr, _mm_set1_epi16(OBJ_PIXEL_ALPHA << 8)));
+        const __m128i have_dst = HasAnyBit(top_bit, dst_targets);
+        const __m128i have_src = HasAnyBit(bottom_bit, src_targets);
+        const __m128i sfx_enable = window ? HasAnyBit(layer_enable, _mm_set1_epi16(1 << LAYER_SFX)) : ones;
+
+        color = Select(_mm_and_si128(is_alpha_obj, have_src), AlphaBlendSSE2(color, bottom_color, eva, evb), color);
+
+        switch(blend_mode) {
+          case BlendControl::Mode::Alpha: {
+            const __m128i mask = _mm_and_si128(_mm_and_si128(have_dst, have_src), sfx_enable);
+
+            color = Select(mask, AlphaBlendSSE2(color, bottom_color, eva, evb), color);
+            break;
+          }
+          case BlendControl::Mode::Brighten: {
+            color = Select(_mm_and_si128(have_dst, sfx_enable), BrightenSSE2(color, evy), color);
+            break;
+          }
+          case BlendControl::Mode::Darken: {
+            color = Select(_mm_and_si128(have_dst, sfx_enable), DarkenSSE2(color, evy), color);
+            break;
+          }
+          default: break;
+        }
+      }
+
+      _mm_storeu_si128((__m128i*)&context.buffer_compose[x], _mm_or_si128(color, _mm_set1_epi16((s16)0x8000)));
+    }
+  }
+
+#endif
+
+  void PPU::ComposeScanline(RenderContext& context, u16 vcount, int bg_min, int bg_max) {
     const auto& mmio = m_mmio_copy[vcount];
     const auto& dispcnt = mmio.dispcnt;
 
@@ -240,7 +471,7 @@ namespace dual::nds {
       key |= 1;
     }
 
-    if(mmio.bldcnt.blend_mode != BlendControl::Mode::Off || m_line_contains_alpha_obj) {
+    if(mmio.bldcnt.blend_mode != BlendControl::Mode::Off || context.line_contains_alpha_obj) {
       key |= 2;
     }
 
@@ -248,15 +479,137 @@ namespace dual::nds {
       key |= 4;
     }*/
 
+#if defined(__SSE2__)
+    u16  simd_result[256];
+    bool verify = false;
+
+    // A 3D BG0 layer is blended with per-pixel alpha, which only the scalar compositor implements.
+    const bool bg0_is_3d = dispcnt.enable[ENABLE_BG0] && (dispcnt.enable_bg0_3d || dispcnt.bg_mode == 6);
+
+    if((key & 4) == 0 && !bg0_is_3d) {
+      switch(key) {
+        case 0b00: ComposeScanlineSSE2<false, false>(context, vcount, bg_min, bg_max); break;
+        case 0b01: ComposeScanlineSSE2<true,  false>(context, vcount, bg_min, bg_max); break;
+        case 0b10: ComposeScanlineSSE2<false, true >(context, vcount, bg_min, bg_max); break;
+        case 0b11: ComposeScanlineSSE2<true,  true >(context, vcount, bg_min, bg_max); break;
+      }
+
+      if(!m_verify_simd) [[likely]] {
+        return;
+      }
+
+      // Fall through to the scalar compositor, which overwrites the line with the reference result.
+      std::memcpy(simd_result, context.buffer_compose, sizeof(simd_result));
+      verify = true;
+    }
+#endif
+
     switch(key) {
-      case 0b000: ComposeScanlineTmpl<false, false, false>(vcount, bg_min, bg_max); break;
-      case 0b001: ComposeScanlineTmpl<true,  false, false>(vcount, bg_min, bg_max); break;
-      case 0b010: ComposeScanlineTmpl<false, true,  false>(vcount, bg_min, bg_max); break;
-      case 0b011: ComposeScanlineTmpl<true,  true,  false>(vcount, bg_min, bg_max); break;
-      case 0b100: ComposeScanlineTmpl<false, false, true >(vcount, bg_min, bg_max); break;
-      case 0b101: ComposeScanlineTmpl<true,  false, true >(vcount, bg_min, bg_max); break;
-      case 0b110: ComposeScanlineTmpl<false, true,  true >(vcount, bg_min, bg_max); break;
-      case 0b111: ComposeScanlineTmpl<true,  true,  true >(vcount, bg_min, bg_max); break;
+      case 0b000: ComposeScanlineTmpl<false, false, false>(context, vcount, bg_min, bg_max); break;
+      case 0b001: ComposeScanlineTmpl<true,  false, false>(context, vcount, bg_min, bg_max); break;
+      case 0b010: ComposeScanlineTmpl<false, true,  false>(context, vcount, bg_min, bg_max); break;
+      case 0b011: ComposeScanlineTmpl<true,  true,  false>(context, vcount, bg_min, bg_max); break;
+      case 0b100: ComposeScanlineTmpl<false, false, true >(context, vcount, bg_min, bg_max); break;
+      case 0b101: ComposeScanlineTmpl<true,  false, true >(context, vcount, bg_min, bg_max); break;
+      case 0b110: ComposeScanlineTmpl<false, true,  true >(context, vcount, bg_min, bg_max); break;
+      case 0b111: ComposeScanlineTmpl<true,  true,  true >(context, vcount, bg_min, bg_max); break;
+    }
+
+#if defined(__SSE2__)
+    if(verify && std::memcmp(simd_result, context.buffer_compose, sizeof(simd_result)) != 0) {
+      m_simd_mismatches.fetch_add(1u, std::memory_order_relaxed);
+    }
+#endif
+  }
+
+  void PPU::ConvertScanline(const u16* src, u32* dst, const MasterBrightness& master_bright) {
+#if defined(__SSE2__)
+    ConvertScanlineSSE2(src, dst, master_bright);
+
+    if(m_verify_simd) [[unlikely]] {
+      u32 simd_result[256];
+
+      std::memcpy(simd_result, dst, sizeof(simd_result));
+      ConvertScanlineScalar(src, dst, master_bright);
+
+      if(std::memcmp(simd_result, dst, sizeof(simd_result)) != 0) {
+        m_simd_mismatches.fetch_add(1u, std::memory_order_relaxed);
+      }
+    }
+#else
+    ConvertScanlineScalar(src, dst, master_bright);
+#endif
+  }
+
+#if defined(__SSE2__)
+
+  void PPU::ConvertScanlineSSE2(const u16* src, u32* dst, const MasterBrightness& master_bright) {
+    const bool brightness = master_bright.mode != MasterBrightness::Mode::Off && master_bright.factor != 0;
+    const int  factor = std::min((int)master_bright.factor, 16);
+
+    // Converts to ARGB8888 and applies the master brightness to each 8-bit channel in one pass.
+    const __m128i channel_max = _mm_set1_epi16(0xFF);
+    const __m128i factor_v = _mm_set1_epi16((s16)factor);
+    const bool up = master_bright.mode == MasterBrightness::Mode::Up;
+
+    for(int x = 0; x < 256; x += 8) {
+      const __m128i color = _mm_loadu_si128((const __m128i*)&src[x]);
+
+      __m128i r = _mm_slli_epi16(_mm_and_si128(color, _mm_set1_epi16(0x1F)), 3);
+      __m128i g = _mm_and_si128(_mm_srli_epi16(color, 2), _mm_set1_epi16(0xF8));
+      __m128i b = _mm_and_si128(_mm_srli_epi16(color, 7), _mm_set1_epi16(0xF8));
+
+      if(brightness) {
+        if(up) {
+          r = _mm_add_epi16(r, _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(channel_max, r), factor_v), 4));
+          g = _mm_add_epi16(g, _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(channel_max, g), factor_v), 4));
+          b = _mm_add_epi16(b, _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(channel_max, b), factor_v), 4));
+        } else {
+          r = _mm_sub_epi16(r, _mm_srli_epi16(_mm_mullo_epi16(r, factor_v), 4));
+          g = _mm_sub_epi16(g, _mm_srli_epi16(_mm_mullo_epi16(g, factor_v), 4));
+          b = _mm_sub_epi16(b, _mm_srli_epi16(_mm_mullo_epi16(b, factor_v), 4));
+        }
+      }
+
+      const __m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+      const __m128i ar = _mm_or_si128(r, _mm_set1_epi16((s16)0xFF00));
+
+      _mm_storeu_si128((__m128i*)&dst[x + 0], _mm_unpacklo_epi16(gb, ar));
+      _mm_storeu_si128((__m128i*)&dst[x + 4], _mm_unpackhi_epi16(gb, ar));
+    }
+  }
+
+#endif
+
+  void PPU::ConvertScanlineScalar(const u16* src, u32* dst, const MasterBrightness& master_bright) {
+    const bool brightness = master_bright.mode != MasterBrightness::Mode::Off && master_bright.factor != 0;
+    const int  factor = std::min((int)master_bright.factor, 16);
+
+    for(int x = 0; x < 256; x++) {
+      dst[x] = ConvertColor(src[x]);
+    }
+
+    if(brightness) {
+      u32* buffer = dst;
+
+      if(master_bright.mode == MasterBrightness::Mode::Up) {
+        for(int x = 0; x < 256; x++) {
+          u32 rgba = *buffer;
+          u32 rgba_inv = ~rgba;
+
+          rgba += ((((rgba_inv & 0xFF00FF) * factor) & 0xFF00FF0) |
+                   (((rgba_inv & 0x00FF00) * factor) & 0x00FF000)) >> 4;
+          *buffer++ = rgba;
+        }
+      } else {
+        for(int x = 0; x < 256; x++) {
+          u32 rgba = *buffer;
+
+          rgba -= ((((rgba & 0xFF00FF) * factor) & 0xFF00FF0) |
+                   (((rgba & 0x00FF00) * factor) & 0x00FF000)) >> 4;
+          *buffer++ = rgba;
+        }
+      }
     }
   }
 
@@ -1,13 +1,16 @@
 
 #include <atom/panic.hpp>
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <dual/nds/video_unit/ppu/ppu.hpp>
+#include <dual/nds/video_unit/ppu/render_pool.hpp>
 
 namespace dual::nds {
 
   PPU::PPU(int id, SystemMemory& memory)
-      : m_vram_bg{memory.vram.region_ppu_bg[id]}
+      : m_id{id}
+      , m_vram_bg{memory.vram.region_ppu_bg[id]}
       , m_vram_obj{memory.vram.region_ppu_obj[id]}
       , m_extpal_bg{memory.vram.region_ppu_bg_extpal[id]}
       , m_extpal_obj{memory.vram.region_ppu_obj_extpal[id]}
@@ -56,18 +59,96 @@ namespace dual::nds {
     m_mmio.master_bright = {};
 
     m_vcount = 0;
+    m_stats = {};
 
-    m_vram_bg_dirty = {0, sizeof(m_render_vram_bg)};
-    m_vram_obj_dirty = {0, sizeof(m_render_vram_obj)};
-    m_extpal_bg_dirty = {0, sizeof(m_render_extpal_bg)};
-    m_extpal_obj_dirty = {0, sizeof(m_render_extpal_obj)};
-    m_vram_lcdc_dirty = {0, sizeof(m_render_vram_lcdc)};
-    m_pram_dirty = {0,sizeof(m_render_pram)};
-    m_oam_dirty = {0, sizeof(m_render_oam)};
+    MarkAllMemoryDirty();
 
     SetupRenderWorker();
   }
 
+  void PPU::SaveState(StateWriter& state) {
+    // Scanlines which have been submitted already must be in the frame buffer.
+    WaitForRenderWorker();
+
+    state.Write(m_mmio);
+    state.Write(m_vcount);
+    state.Write(m_frame);
+    state.Write(m_frame_buffer);
+    state.Write(m_window_scanline_enable);
+  }
+
+  void PPU::LoadState(StateReader& state) {
+    WaitForRenderWorker();
+    ApplyWriteJournal(k_total_lines);
+
+    state.Read(m_mmio);
+    state.Read(m_vcount);
+    state.Read(m_frame);
+    state.Read(m_frame_buffer);
+    state.Read(m_window_scanline_enable);
+
+    m_band_vcount_lo = m_vcount + 1;
+    m_band_vcount_hi = m_vcount;
+
+    // Memory writes during the visible lines are copied right away, so the copies must be refreshed immediately.
+    MarkAllMemoryDirty();
+
+    if(m_vcount < 192 && m_enable_rendering) {
+      CopyDirtyMemory();
+    }
+  }
+
+  void PPU::SaveSnapshot(StateWriter& state) {
+    WaitForRenderWorker();
+
+    state.Write(m_mmio);
+    state.Write(m_vcount);
+    state.Write(m_frame);
+    state.Write(m_window_scanline_enable);
+
+    m_vram_bg_written.Clear();
+    m_vram_obj_written.Clear();
+    m_extpal_bg_written.Clear();
+    m_extpal_obj_written.Clear();
+    m_vram_lcdc_written.Clear();
+    m_pram_written.Clear();
+    m_oam_written.Clear();
+  }
+
+  void PPU::LoadSnapshot(StateReader& state) {
+    WaitForRenderWorker();
+    ApplyWriteJournal(k_total_lines);
+
+    state.Read(m_mmio);
+    state.Read(m_vcount);
+    state.Read(m_frame);
+    state.Read(m_window_scanline_enable);
+
+    m_band_vcount_lo = m_vcount + 1;
+    m_band_vcount_hi = m_vcount;
+
+    // The copies are out-of-date where they were out-of-date already or where memory has been written since the snapshot.
+    m_vram_bg_dirty.Add(m_vram_bg_written);
+    m_vram_obj_dirty.Add(m_vram_obj_written);
+    m_extpal_bg_dirty.Add(m_extpal_bg_written);
+    m_extpal_obj_dirty.Add(m_extpal_obj_written);
+    m_vram_lcdc_dirty.Add(m_vram_lcdc_written);
+    m_pram_dirty.Add(m_pram_written);
+    m_oam_dirty.Add(m_oam_written);
+
+    m_vram_bg_written.Clear();
+    m_vram_obj_written.Clear();
+    m_extpal_bg_written.Clear();
+    m_extpal_obj_written.Clear();
+    m_vram_lcdc_written.Clear();
+    m_pram_written.Clear();
+    m_oam_written.Clear();
+
+    if(m_vcount < 192 && m_enable_rendering) {
+      CopyDirtyMemory();
+    }
+  }
+
   void PPU::OnDrawScanlineBegin(u16 vcount, bool capture_bg_and_3d) {
     m_vcount = vcount;
 
@@ -128,21 +209,34 @@ namespace dual::nds {
       bgy[0].current = (s32)bgy[0].initial;
       bgx[1].current = (s32)bgx[1].initial;
       bgy[1].current = (s32)bgy[1].initial;
+
+      // The visible lines have been submitted, apply the writes which the render worker did not need anymore.
+      WaitForRenderWorker();
+      ApplyWriteJournal(k_total_lines);
     }
 
     SubmitScanline(vcount, false);
   }
 
-  void PPU::RenderScanline(u16 vcount, bool capture_bg_and_3d) {
-    auto display_mode = m_mmio_copy[vcount].dispcnt.display_mode;
+  void PPU::RenderScanline(RenderContext& context, u16 vcount, bool capture_bg_and_3d) {
+    const auto& dispcnt = m_mmio_copy[vcount].dispcnt;
+    auto display_mode = dispcnt.display_mode;
+
+    if(dispcnt.enable[ENABLE_WIN0]) {
+      RenderWindow(context, 0, vcount);
+    }
+
+    if(dispcnt.enable[ENABLE_WIN1]) {
+      RenderWindow(context, 1, vcount);
+    }
 
     if(capture_bg_and_3d || display_mode == 1) {
-      RenderBackgroundsAndComposite(vcount);
+      RenderBackgroundsAndComposite(context, vcount);
     }
 
     switch(display_mode) {
       case 0: RenderDisplayOff(vcount); break;
-      case 1: RenderNormal(vcount);     break;
+      case 1: RenderNormal(context, vcount); break;
       case 2: RenderVideoMemoryDisplay(vcount); break;
       case 3: RenderMainMemoryDisplay(vcount);  break;
     }
@@ -156,14 +250,8 @@ namespace dual::nds {
     }
   }
 
-  void PPU::RenderNormal(u16 vcount) {
-    u32* line = &m_frame_buffer[m_frame][vcount * 256];
-
-    for(uint x = 0; x < 256; x++) {
-      line[x] = ConvertColor(m_buffer_compose[x]);
-    }
-
-    RenderMasterBrightness(vcount);
+  void PPU::RenderNormal(RenderContext& context, u16 vcount) {
+    ConvertScanline(context.buffer_compose, &m_frame_buffer[m_frame][vcount * 256], m_mmio_copy[vcount].master_bright);
   }
 
   void PPU::RenderVideoMemoryDisplay(u16 vcount) {
@@ -171,64 +259,26 @@ namespace dual::nds {
     auto vram_block = m_mmio_copy[vcount].dispcnt.vram_block;
     const u16* source = (const u16*)&m_render_vram_lcdc[vram_block * 0x20000 + vcount * 256 * sizeof(u16)];
 
-    if(source != nullptr) {
-      for(uint x = 0; x < 256; x++) {
-        line[x] = ConvertColor(*source++);
-      }
-    } else {
-      for(uint x = 0; x < 256; x++) {
-        line[x] = ConvertColor(0);
-      }
-    }
-
-    RenderMasterBrightness(vcount);
-  }
-
-  void PPU::RenderMasterBrightness(int vcount) {
-    const auto& master_bright = m_mmio_copy[vcount].master_bright;
-
-    if(master_bright.mode != MasterBrightness::Mode::Off && master_bright.factor != 0) {
-      int  factor = std::min((int)master_bright.factor, 16);
-      u32* buffer = &m_frame_buffer[m_frame][vcount * 256];
-
-      if(master_bright.mode == MasterBrightness::Mode::Up) {
-        for(int x = 0; x < 256; x++) {
-          u32 rgba = *buffer;
-          u32 rgba_inv = ~rgba;
-
-          rgba += ((((rgba_inv & 0xFF00FF) * factor) & 0xFF00FF0) |
-                   (((rgba_inv & 0x00FF00) * factor) & 0x00FF000)) >> 4;
-          *buffer++ = rgba;
-        }
-      } else {
-        for(int x = 0; x < 256; x++) {
-          u32 rgba = *buffer;
-
-          rgba -= ((((rgba & 0xFF00FF) * factor) & 0xFF00FF0) |
-                   (((rgba & 0x00FF00) * factor) & 0x00FF000)) >> 4;
-          *buffer++ = rgba;
-        }
-      }
-    }
+    ConvertScanline(source, line, m_mmio_copy[vcount].master_bright);
   }
 
   void PPU::RenderMainMemoryDisplay(u16 vcount) {
     ATOM_PANIC("PPU: unimplemented main memory display mode.");
   }
 
-  void PPU::RenderBackgroundsAndComposite(u16 vcount) {
+  void PPU::RenderBackgroundsAndComposite(RenderContext& context, u16 vcount) {
     const auto& mmio = m_mmio_copy[vcount];
 
     if(mmio.dispcnt.forced_blank) {
       for(uint x = 0; x < 256; x++) {
-        m_buffer_compose[x] = 0xFFFF;
+        context.buffer_compose[x] = 0xFFFF;
       }
       return;
     }
 
     // @todo: on a real Nintendo DS all sprites are rendered one scanline ahead.
     if(mmio.dispcnt.enable[ENABLE_OBJ]) {
-      RenderLayerOAM(vcount);
+      RenderLayerOAM(context, vcount);
     }
 
     if(mmio.dispcnt.enable[ENABLE_BG0]) {
@@ -237,73 +287,89 @@ namespace dual::nds {
         // gpu->CaptureColor(buffer_bg[0], vcount, 256, false);
         // gpu->CaptureAlpha(buffer_3d_alpha, vcount);
       } else {
-        RenderLayerText(0, vcount);
+        RenderLayerText(context, 0, vcount);
       }
     }
 
     if(mmio.dispcnt.enable[ENABLE_BG1] && mmio.dispcnt.bg_mode != 6) {
-      RenderLayerText(1, vcount);
+      RenderLayerText(context, 1, vcount);
     }
 
     if(mmio.dispcnt.enable[ENABLE_BG2]) {
       switch(mmio.dispcnt.bg_mode) {
         case 0:
         case 1:
-        case 3: RenderLayerText(2, vcount); break;
+        case 3: RenderLayerText(context, 2, vcount); break;
         case 2:
-        case 4: RenderLayerAffine(0, vcount); break;
-        case 5: RenderLayerExtended(0, vcount); break;
-        case 6: RenderLayerLarge(vcount); break;
+        case 4: RenderLayerAffine(context, 0, vcount); break;
+        case 5: RenderLayerExtended(context, 0, vcount); break;
+        case 6: RenderLayerLarge(context, vcount); break;
       }
     }
 
     if(mmio.dispcnt.enable[ENABLE_BG3]) {
       switch(mmio.dispcnt.bg_mode) {
-        case 0: RenderLayerText(3, vcount); break;
+        case 0: RenderLayerText(context, 3, vcount); break;
         case 1:
-        case 2: RenderLayerAffine(1, vcount); break;
+        case 2: RenderLayerAffine(context, 1, vcount); break;
         case 3:
         case 4:
-        case 5: RenderLayerExtended(1, vcount); break;
+        case 5: RenderLayerExtended(context, 1, vcount); break;
       }
     }
 
-    ComposeScanline(vcount, 0, 3);
+    ComposeScanline(context, vcount, 0, 3);
   }
 
   void PPU::SetupRenderWorker() {
     StopRenderWorker();
 
-    m_render_worker.vcount = 0;
-    m_render_worker.vcount_max = -1;
+    m_render_worker.head = 0u;
+    m_render_worker.tail = 0u;
+    m_render_worker.worker_sleeping = false;
+    m_render_worker.emulator_waiting = false;
     m_render_worker.running = true;
-    m_render_worker.ready = false;
+
+    // All memory is dirty, so the journaled writes are not needed anymore.
+    m_write_journal.write_index = 0u;
+    m_write_journal.read_index = 0u;
 
     m_render_worker.thread = std::thread([this]() {
-      while(m_render_worker.running.load()) {
-        while(m_render_worker.vcount <= m_render_worker.vcount_max) {
-          // @todo: this might be racy with SubmitScanline() resetting render_thread_vcount.
-          int vcount = m_render_worker.vcount;
+      auto& worker = m_render_worker;
 
-          if(m_mmio.dispcnt.enable[ENABLE_WIN0]) {
-            RenderWindow(0, vcount);
-          }
+      u32 tail = worker.tail.load(std::memory_order_relaxed);
 
-          if(m_mmio.dispcnt.enable[ENABLE_WIN1]) {
-            RenderWindow(1, vcount);
-          }
+      while(true) {
+        u32 head = worker.head.load(std::memory_order_acquire);
+
+        if(tail == head) {
+          // Announce that we are going to sleep before checking for work one last time, so that the emulation thread
+          // either sees the announcement and wakes us up or we see its new scanline.
+          worker.worker_sleeping.store(true);
+          head = worker.head.load();
 
-          if(vcount < 192) {
-            RenderScanline(vcount, m_mmio_copy[vcount].capture_bg_and_3d);
+          if(tail == head) {
+            worker.head.wait(head);
           }
 
-          m_render_worker.vcount++;
+          worker.worker_sleeping.store(false, std::memory_order_relaxed);
+          continue;
+        }
+
+        const int vcount = worker.jobs[tail % RenderWorker::k_capacity];
+
+        if(vcount == RenderWorker::k_stop) {
+          break;
         }
 
-        // Wait for the emulation thread to submit more work:
-        std::unique_lock lock{m_render_worker.mutex};
-        m_render_worker.cv.wait(lock, [this]() {return m_render_worker.ready;});
-        m_render_worker.ready = false;
+        ApplyWriteJournal(vcount);
+        RenderScanline(m_render_context, vcount, m_mmio_copy[vcount].capture_bg_and_3d);
+
+        worker.tail.store(++tail);
+
+        if(worker.emulator_waiting.load()) {
+          worker.tail.notify_one();
+        }
       }
     });
   }
@@ -313,55 +379,271 @@ namespace dual::nds {
       return;
     }
 
-    // Wake the render worker thread up if it is working for new data:
-    m_render_worker.mutex.lock();
-    m_render_worker.ready = true;
-    m_render_worker.cv.notify_one();
-    m_render_worker.mutex.unlock();
+    PushRenderJob(RenderWorker::k_stop);
 
-    // Tell the render worker thread to quit and join it:
-    m_render_worker.running = false;
     m_render_worker.thread.join();
+    m_render_worker.running = false;
+  }
+
+  void PPU::SetRenderPool(RenderPool* render_pool) {
+    WaitForRenderWorker();
+
+    m_render_pool = render_pool;
+    m_band_vcount_lo = m_vcount + 1;
+    m_band_vcount_hi = m_vcount;
+  }
+
+  void PPU::WaitForRenderWorker() {
+    if(m_render_pool) {
+      SubmitRenderBand();
+      WaitForRenderBands();
+    } else {
+      WaitForRenderJobs(m_render_worker.head.load(std::memory_order_relaxed));
+    }
+  }
+
+  // Waits until the worker's tail has reached or passed the given index (which wraps around).
+  void PPU::WaitForRenderJobs(u32 tail) {
+    auto& worker = m_render_worker;
+
+    u32 current_tail = worker.tail.load(std::memory_order_acquire);
+
+    if((s32)(current_tail - tail) >= 0) {
+      return;
+    }
+
+    const auto time_start = std::chrono::steady_clock::now();
+
+    // Same as in the render worker: announce the wait first, then check again before blocking.
+    worker.emulator_waiting.store(true);
+
+    while((s32)((current_tail = worker.tail.load()) - tail) < 0) {
+      worker.tail.wait(current_tail);
+    }
+
+    worker.emulator_waiting.store(false, std::memory_order_relaxed);
+
+    m_stats.wait_count++;
+    m_stats.wait_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - time_start).count();
+  }
+
+  void PPU::PushRenderJob(int vcount) {
+    auto& worker = m_render_worker;
+
+    const u32 head = worker.head.load(std::memory_order_relaxed);
+
+    // The ring holds more than a frame of scanlines, so this only happens if the frame end did not wait for the worker.
+    if(head - worker.tail.load(std::memory_order_acquire) == RenderWorker::k_capacity) {
+      WaitForRenderJobs(head - RenderWorker::k_capacity + 1u);
+    }
+
+    worker.jobs[head % RenderWorker::k_capacity] = vcount;
+    worker.head.store(head + 1u);
+
+    if(worker.worker_sleeping.load()) {
+      worker.head.notify_one();
+      m_stats.worker_wakeups++;
+    }
   }
 
   void PPU::SubmitScanline(u16 vcount, bool capture_bg_and_3d) {
+    // Track whether the scanline is inside the vertical range of each window (including during V-blank).
+    for(int id = 0; id < 2; id++) {
+      if(m_mmio.dispcnt.enable[ENABLE_WIN0 + id]) {
+        if(vcount == m_mmio.winv[id].min) {
+          m_window_scanline_enable[id] = true;
+        }
+
+        if(vcount == m_mmio.winv[id].max) {
+          m_window_scanline_enable[id] = false;
+        }
+      }
+    }
+
+    if(!m_enable_rendering || vcount >= 192) {
+      return;
+    }
+
     m_mmio.capture_bg_and_3d = capture_bg_and_3d;
+    m_mmio.window_scanline_enable[0] = m_window_scanline_enable[0];
+    m_mmio.window_scanline_enable[1] = m_window_scanline_enable[1];
+
+    m_mmio_copy[vcount] = m_mmio;
+
+    if(vcount == 0) {
+      CopyDirtyMemory();
 
-    if(vcount < 192) {
-      m_mmio_copy[vcount] = m_mmio;
+      m_band_vcount_lo = 0;
     } else {
-      m_mmio_copy[vcount].dispcnt = m_mmio.dispcnt;
-      m_mmio_copy[vcount].winh[0] = m_mmio.winh[0];
-      m_mmio_copy[vcount].winh[1] = m_mmio.winh[1];
-      m_mmio_copy[vcount].winv[0] = m_mmio.winv[0];
-      m_mmio_copy[vcount].winv[1] = m_mmio.winv[1];
+      CopySampledMemory();
     }
 
-    if(vcount == 0) {
-      CopyVRAM(m_vram_bg, m_render_vram_bg, m_vram_bg_dirty);
-      CopyVRAM(m_vram_obj, m_render_vram_obj, m_vram_obj_dirty);
-      CopyVRAM(m_extpal_bg, m_render_extpal_bg, m_extpal_bg_dirty);
-      CopyVRAM(m_extpal_obj, m_render_extpal_obj, m_extpal_obj_dirty);
-      CopyVRAM(m_vram_lcdc, m_render_vram_lcdc, m_vram_lcdc_dirty);
-      CopyVRAM(m_pram, m_render_pram, m_pram_dirty);
-      CopyVRAM(m_oam, m_render_oam, m_oam_dirty);
-
-      m_vram_bg_dirty = {};
-      m_vram_obj_dirty = {};
-      m_extpal_bg_dirty = {};
-      m_extpal_obj_dirty = {};
-      m_vram_lcdc_dirty = {};
-      m_pram_dirty = {};
-      m_oam_dirty = {};
-
-      m_render_worker.vcount = 0;
-    }
-
-    m_render_worker.vcount_max = vcount;
-
-    std::lock_guard lock{m_render_worker.mutex};
-    m_render_worker.ready = true;
-    m_render_worker.cv.notify_one();
+    if(m_render_pool) {
+      m_band_vcount_hi = vcount;
+
+      if(vcount - m_band_vcount_lo + 1 == k_band_lines || vcount == 191) {
+        SubmitRenderBand();
+      }
+    } else {
+      PushRenderJob(vcount);
+    }
+
+    m_stats.scanlines_submitted++;
+  }
+
+  void PPU::SubmitRenderBand() {
+    if(m_band_vcount_lo > m_band_vcount_hi) {
+      return;
+    }
+
+    // Writes journaled during the previous bands must be applied before this band is rendered,
+    // but the previous bands must not see them.
+    if(m_write_journal.read_index.load(std::memory_order_relaxed) != m_write_journal.write_index.load(std::memory_order_relaxed)) {
+      WaitForRenderBands();
+      ApplyWriteJournal(k_total_lines);
+    }
+
+    m_bands_pending.fetch_add(1);
+    m_render_pool->Submit(*this, m_band_vcount_lo, m_band_vcount_hi);
+
+    m_band_vcount_lo = m_band_vcount_hi + 1;
+  }
+
+  void PPU::RenderBand(RenderContext& context, int vcount_lo, int vcount_hi) {
+    for(int vcount = vcount_lo; vcount <= vcount_hi; vcount++) {
+      RenderScanline(context, vcount, m_mmio_copy[vcount].capture_bg_and_3d);
+    }
+
+    if(m_bands_pending.fetch_sub(1) == 1) {
+      m_bands_pending.notify_all();
+    }
+  }
+
+  void PPU::WaitForRenderBands() {
+    int bands_pending = m_bands_pending.load();
+
+    if(bands_pending == 0) {
+      return;
+    }
+
+    const auto time_start = std::chrono::steady_clock::now();
+
+    do {
+      m_bands_pending.wait(bands_pending);
+    } while((bands_pending = m_bands_pending.load()) != 0);
+
+    m_stats.wait_count++;
+    m_stats.wait_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - time_start).count();
+  }
+
+  void PPU::ApplyWriteJournal(int vcount) {
+    // Called by the render worker or, while the render worker is idle, by the emulation thread.
+    auto& journal = m_write_journal;
+
+    size_t read_index = journal.read_index.load(std::memory_order_relaxed);
+    const size_t write_index = journal.write_index.load(std::memory_order_acquire);
+
+    // Apply the writes which happened before the scanline.
+    while(read_index != write_index) {
+      const auto& entry = journal.entries[read_index % WriteJournal::k_capacity];
+
+      if(entry.vcount >= vcount) {
+        break;
+      }
+
+      std::memcpy(entry.dst, &entry.value, entry.size);
+      OnRenderCopyWrite(entry.dst, entry.size);
+      read_index++;
+    }
+
+    journal.read_index.store(read_index, std::memory_order_release);
+  }
+
+  void PPU::OnRenderCopyWrite(const u8* dst, size_t size) {
+    // Invalidates what the render contexts derived from the rendering copies (decoded tile rows and sprite lists).
+    auto& versions = m_tile_versions;
+
+    if(size == 0u) {
+      return;
+    }
+
+    if(dst >= std::begin(m_render_vram_bg) && dst < std::end(m_render_vram_bg)) {
+      const size_t offset = dst - m_render_vram_bg;
+
+      for(size_t page = offset >> 10; page <= (offset + size - 1u) >> 10; page++) {
+        versions.vram_bg[page]++;
+      }
+    } else if(dst >= std::begin(m_render_pram) && dst < &m_render_pram[0x200]) {
+      // The first half of PRAM holds the background palettes, the second half holds the OBJ palettes.
+      const size_t offset = dst - m_render_pram;
+      const size_t offset_hi = std::min<size_t>(offset + size, 0x200u);
+
+      for(size_t palette = offset >> 5; palette <= (offset_hi - 1u) >> 5; palette++) {
+        versions.pram_bg[palette]++;
+      }
+      versions.pram_bg_all++;
+    } else if(dst >= std::begin(m_render_extpal_bg) && dst < std::end(m_render_extpal_bg)) {
+      const size_t offset = dst - m_render_extpal_bg;
+
+      for(size_t palette = offset >> 9; palette <= (offset + size - 1u) >> 9; palette++) {
+        versions.extpal_bg[palette]++;
+      }
+    } else if(dst >= std::begin(m_render_oam) && dst < std::end(m_render_oam)) {
+      m_oam_version++;
+    }
+  }
+
+  void PPU::CopyDirtyMemory() {
+    CopyDirtyPages(m_vram_bg, m_render_vram_bg, m_vram_bg_dirty);
+    CopyDirtyPages(m_vram_obj, m_render_vram_obj, m_vram_obj_dirty);
+    CopyDirtyPages(m_pram, m_render_pram, m_pram_dirty);
+    CopyDirtyPages(m_oam, m_render_oam, m_oam_dirty);
+
+    m_sample_vram_lcdc = false;
+    m_sample_extpal_bg = false;
+    m_sample_extpal_obj = false;
+
+    CopySampledMemory();
+  }
+
+  void PPU::CopySampledMemory() {
+    // LCDC VRAM and the extended palettes are only copied once a scanline may sample them.
+    // Scanlines before that did not read them, so the copy can be refreshed without waiting for the render worker.
+    const auto& dispcnt = m_mmio.dispcnt;
+
+    if(!m_sample_vram_lcdc && dispcnt.display_mode == 2) {
+      CopyDirtyPages(m_vram_lcdc, m_render_vram_lcdc, m_vram_lcdc_dirty);
+      m_sample_vram_lcdc = true;
+    }
+
+    if(!m_sample_extpal_bg && dispcnt.enable_extpal_bg) {
+      CopyDirtyPages(m_extpal_bg, m_render_extpal_bg, m_extpal_bg_dirty);
+      m_sample_extpal_bg = true;
+    }
+
+    if(!m_sample_extpal_obj && dispcnt.enable_extpal_obj) {
+      CopyDirtyPages(m_extpal_obj, m_render_extpal_obj, m_extpal_obj_dirty);
+      m_sample_extpal_obj = true;
+    }
+  }
+
+  void PPU::MarkAllMemoryDirty() {
+    m_vram_bg_dirty.AddAll();
+    m_vram_obj_dirty.AddAll();
+    m_extpal_bg_dirty.AddAll();
+    m_extpal_obj_dirty.AddAll();
+    m_vram_lcdc_dirty.AddAll();
+    m_pram_dirty.AddAll();
+    m_oam_dirty.AddAll();
+
+    // The copies must also be refreshed entirely when the next snapshot is loaded.
+    m_vram_bg_written.AddAll();
+    m_vram_obj_written.AddAll();
+    m_extpal_bg_written.AddAll();
+    m_extpal_obj_written.AddAll();
+    m_vram_lcdc_written.AddAll();
+    m_pram_written.AddAll();
+    m_oam_written.AddAll();
   }
 
   void PPU::RegisterMapUnmapCallbacks() {
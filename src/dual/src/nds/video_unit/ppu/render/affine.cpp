@@ -3,17 +3,20 @@
 
 namespace dual::nds {
 
+  // The render function is a template parameter rather than a std::function, so that it is inlined into the loop.
+  template<typename RenderFunc>
   void PPU::AffineRenderLoop(
+    RenderContext& context,
     u16 vcount,
     uint id,
     int  width,
     int  height,
-    const std::function<void(int, int, int)>& render_func
+    const RenderFunc& render_func
   ) {
     const auto& mmio = m_mmio_copy[vcount];
     const auto& bg = mmio.bgcnt[2 + id];
     const auto& mosaic = mmio.mosaic.bg;
-    u16* buffer = m_buffer_bg[2 + id];
+    u16* buffer = context.buffer_bg[2 + id];
 
     s32 ref_x = mmio.bgx[id].current;
     s32 ref_y = mmio.bgy[id].current;
@@ -58,18 +61,18 @@ namespace dual::nds {
     }
   }
 
-  void PPU::RenderLayerAffine(uint id, u16 vcount) {
+  void PPU::RenderLayerAffine(RenderContext& context, uint id, u16 vcount) {
     const auto& mmio = m_mmio_copy[vcount];
     const auto& bg = mmio.bgcnt[2 + id];
 
-    u16* buffer = m_buffer_bg[2 + id];
+    u16* buffer = context.buffer_bg[2 + id];
 
     int size = 128 << bg.size;
     int block_width = 16 << bg.size;
     u32 map_base  = mmio.dispcnt.map_block  * 65536 + bg.map_block  * 2048;
     u32 tile_base = mmio.dispcnt.tile_block * 65536 + bg.tile_block * 16384;
 
-    AffineRenderLoop(vcount, id, size, size, [&](int line_x, int x, int y) {
+    AffineRenderLoop(context, vcount, id, size, size, [&](int line_x, int x, int y) {
       auto tile_number = atom::read<u8>(m_render_vram_bg, map_base + (y >> 3) * block_width + (x >> 3));
       buffer[line_x] = DecodeTilePixel8BPP_BG(
         tile_base + tile_number * 64,
@@ -82,11 +85,11 @@ namespace dual::nds {
     });
   }
 
-  void PPU::RenderLayerExtended(uint id, u16 vcount) {
+  void PPU::RenderLayerExtended(RenderContext& context, uint id, u16 vcount) {
     const auto& mmio = m_mmio_copy[vcount];
     const auto& bg = mmio.bgcnt[2 + id];
 
-    u16* buffer = m_buffer_bg[2 + id];
+    u16* buffer = context.buffer_bg[2 + id];
 
     if(bg.full_palette) {
       int width;
@@ -101,7 +104,7 @@ namespace dual::nds {
 
       if(bg.tile_block & 1) {
         // Rotate/Scale direct color bitmap
-        AffineRenderLoop(vcount, id, width, height, [&](int line_x, int x, int y) {
+        AffineRenderLoop(context, vcount, id, width, height, [&](int line_x, int x, int y) {
           u16 color = atom::read<u16>(m_render_vram_bg, bg.map_block * 16384 + (y * width + x) * 2);
           if(color & 0x8000) {
             buffer[line_x] = color & 0x7FFF;
@@ -111,7 +114,7 @@ namespace dual::nds {
         });
       } else {
         // Rotate/Scale 256-color bitmap
-        AffineRenderLoop(vcount, id, width, height, [&](int line_x, int x, int y) {
+        AffineRenderLoop(context, vcount, id, width, height, [&](int line_x, int x, int y) {
           u8 index = atom::read<u8>(m_render_vram_bg, bg.map_block * 16384 + y * width + x);
           if(index == 0) {
             buffer[line_x] = k_color_transparent;
@@ -123,12 +126,14 @@ namespace dual::nds {
 
     } else {
       // Rotate/Scale with 16-bit background map entries (Text + Affine mixup)
+      // Unlike text backgrounds, tiles are decoded per pixel: affine sampling rarely stays within a tile row long enough
+      // for a lookup in the decoded tile row cache to be cheaper than decoding the pixel.
       int size = 128 << bg.size;
       int block_width = 16 << bg.size;
       u32 map_base  = mmio.dispcnt.map_block  * 65536 + bg.map_block  * 2048;
       u32 tile_base = mmio.dispcnt.tile_block * 65536 + bg.tile_block * 16384;
 
-      AffineRenderLoop(vcount, id, size, size, [&](int line_x, int x, int y) {
+      AffineRenderLoop(context, vcount, id, size, size, [&](int line_x, int x, int y) {
         u16 encoder = atom::read<u16>(m_render_vram_bg, map_base + ((y >> 3) * block_width + (x >> 3)) * 2);
         int number  = encoder & 0x3FF;
         int palette = encoder >> 12;
@@ -138,24 +143,24 @@ namespace dual::nds {
         if(encoder & (1 << 10)) tile_x = 7 - tile_x;
         if(encoder & (1 << 11)) tile_y = 7 - tile_y;
 
-        buffer[line_x] = DecodeTilePixel8BPP_BG(tile_base + number * 64, true, palette, 2 + id, tile_x, tile_y);
+        buffer[line_x] = DecodeTilePixel8BPP_BG(tile_base + number * 64, mmio.dispcnt.enable_extpal_bg, palette, 2 + id, tile_x, tile_y);
       });
     }
   }
 
-  void PPU::RenderLayerLarge(u16 vcount) {
+  void PPU::RenderLayerLarge(RenderContext& context, u16 vcount) {
     const auto& mmio = m_mmio_copy[vcount];
     const auto& bg = mmio.bgcnt[2];
 
     int width = 512 << (bg.size & 1);
     int height = 1024 >> (bg.size & 1);
 
-    AffineRenderLoop(vcount, 0, width, height, [&](int line_x, int x, int y) {
+    AffineRenderLoop(context, vcount, 0, width, height, [&](int line_x, int x, int y) {
       u8 index = atom::read<u8>(m_render_vram_bg, y * width + x);
       if(index == 0) {
-        m_buffer_bg[2][line_x] = k_color_transparent;
+        context.buffer_bg[2][line_x] = k_color_transparent;
       } else {
-        m_buffer_bg[2][line_x] = ReadPalette(0, index);
+        context.buffer_bg[2][line_x] = ReadPalette(0, index);
       }
     });
   }
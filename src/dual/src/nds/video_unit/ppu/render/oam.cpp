@@ -1,9 +1,167 @@
 
+#include <algorithm>
 #include <dual/nds/video_unit/ppu/ppu.hpp>
 
 namespace dual::nds {
 
-  void PPU::RenderLayerOAM(u16 vcount) {
+  void PPU::RenderLayerOAM(RenderContext& context, u16 vcount) {
+    const auto& mmio = m_mmio_copy[vcount];
+    const auto& sprites = UpdateSpriteList(context);
+
+    context.line_contains_alpha_obj = false;
+
+    for(auto& point : context.buffer_obj) {
+      point.priority = 4;
+      point.color = k_color_transparent;
+      point.flags = 0;
+    }
+
+    const auto plot = [&](int global_x, u16 pixel, int mode, int prio) {
+      auto& point = context.buffer_obj[global_x];
+
+      if(pixel != k_color_transparent) {
+        if(mode == OBJ_WINDOW) {
+          point.flags |= OBJ_PIXEL_WINDOW;
+        } else if(prio < point.priority) {
+          point.priority = prio;
+          point.color = pixel;
+          point.flags = (point.flags & OBJ_PIXEL_WINDOW) | (mode == OBJ_SEMI ? OBJ_PIXEL_ALPHA : 0);
+          if(mode == OBJ_SEMI) {
+            context.line_contains_alpha_obj = true;
+          }
+        }
+      }
+    };
+
+    const int line_count = sprites.line_count[vcount];
+
+    for(int j = 0; j < line_count; j++) {
+      const int i = sprites.line_sprites[vcount][j];
+
+      s32 x = sprites.x[i];
+      s32 y = sprites.y[i];
+      int width  = sprites.width[i];
+      int height = sprites.height[i];
+      int half_width = sprites.half_width[i];
+      int mode  = sprites.mode[i];
+      int prio  = sprites.priority[i];
+      int flags = sprites.flags[i];
+
+      s16 local_y = (s16)(vcount - y);
+
+      if(!(flags & (SPRITE_AFFINE | SPRITE_MOSAIC))) {
+        // Regular sprites sample a single row of the sprite, so walk it directly.
+        int tex_y = local_y + height / 2;
+
+        if(flags & SPRITE_FLIP_V) tex_y = height - tex_y - 1;
+
+        const int left = x - half_width;
+        const int global_x_min = std::max(left, 0);
+        const int global_x_max = std::min(left + width, 256);
+
+        const auto walk_row = [&](auto&& fetch) {
+          for(int global_x = global_x_min; global_x < global_x_max; global_x++) {
+            int tex_x = global_x - left;
+
+            if(flags & SPRITE_FLIP_H) tex_x = width - tex_x - 1;
+
+            plot(global_x, fetch(tex_x), mode, prio);
+          }
+        };
+
+        const int number  = sprites.number[i];
+        const int palette = sprites.palette[i];
+        const int tile_y  = tex_y % 8;
+        const int block_y = tex_y / 8;
+
+        if(mode == OBJ_BITMAP) {
+          u32 row_address;
+
+          if(mmio.dispcnt.bitmap_obj_mapping == DisplayControl::Mapping::OneDimensional) {
+            row_address = number * (64 << mmio.dispcnt.bitmap_obj_boundary) + tex_y * width;
+          } else {
+            auto dimension = mmio.dispcnt.bitmap_obj_dimension;
+            auto mask = (16 << dimension) - 1;
+
+            row_address = (number & ~mask) * 64 + (number & mask) * 8 + tex_y * (128 << dimension);
+          }
+
+          walk_row([&](int tex_x) {
+            u16 pixel = atom::read<u16>(m_render_vram_obj, (row_address + tex_x) * 2);
+
+            return (pixel & 0x8000) ? pixel : k_color_transparent;
+          });
+        } else if(flags & SPRITE_256) {
+          int row_tile_num;
+
+          if(mmio.dispcnt.tile_obj_mapping == DisplayControl::Mapping::OneDimensional) {
+            row_tile_num = (number << mmio.dispcnt.tile_obj_boundary) + block_y * (width / 4);
+          } else {
+            row_tile_num = (number & ~1) + block_y * 32;
+          }
+
+          const bool enable_extpal = mmio.dispcnt.enable_extpal_obj;
+
+          walk_row([&](int tex_x) {
+            return DecodeTilePixel8BPP_OBJ((row_tile_num + (tex_x / 8) * 2) * 32, enable_extpal, palette, tex_x % 8, tile_y);
+          });
+        } else {
+          int row_tile_num;
+
+          if(mmio.dispcnt.tile_obj_mapping == DisplayControl::Mapping::OneDimensional) {
+            row_tile_num = (number << mmio.dispcnt.tile_obj_boundary) + block_y * (width / 8);
+          } else {
+            row_tile_num = number + block_y * 32;
+          }
+
+          walk_row([&](int tex_x) {
+            return DecodeTilePixel4BPP_OBJ((row_tile_num + tex_x / 8) * 32, palette, tex_x % 8, tile_y);
+          });
+        }
+        continue;
+      }
+
+      const s16* transform = sprites.transform[i];
+
+      int mosaic = flags & SPRITE_MOSAIC;
+      int mosaic_x = 0;
+
+      if(mosaic) {
+        mosaic_x = (x - half_width) % mmio.mosaic.obj.size_x;
+        local_y = (s16)(local_y - mmio.mosaic.obj.counter_y);
+      }
+
+      // Render OBJ scanline.
+      for(int local_x = -half_width; local_x <= half_width; local_x++) {
+        int _local_x = local_x - mosaic_x;
+        int global_x = local_x + x;
+
+        if(mosaic && (++mosaic_x == mmio.mosaic.obj.size_x)) {
+          mosaic_x = 0;
+        }
+
+        if(global_x < 0 || global_x >= 256) {
+          continue;
+        }
+
+        int tex_x = ((transform[0] * _local_x + transform[1] * local_y) >> 8) + (width / 2);
+        int tex_y = ((transform[2] * _local_x + transform[3] * local_y) >> 8) + (height / 2);
+
+        // Check if transformed coordinates are inside bounds.
+        if(tex_x >= width || tex_y >= height ||
+          tex_x < 0 || tex_y < 0) {
+          continue;
+        }
+
+        if(flags & SPRITE_FLIP_H) tex_x = width  - tex_x - 1;
+        if(flags & SPRITE_FLIP_V) tex_y = height - tex_y - 1;
+
+        plot(global_x, FetchSpritePixel(mmio, sprites, i, tex_x, tex_y), mode, prio);
+      }
+    }
+  }
+
+  const PPU::SpriteList& PPU::UpdateSpriteList(RenderContext& context) {
     static constexpr int k_obj_size[4][4][2] = {
       { { 8 , 8  }, { 16, 16 }, { 32, 32 }, { 64, 64 } }, // Square
       { { 16, 8  }, { 32, 8  }, { 32, 16 }, { 64, 32 } }, // Horizontal
@@ -11,21 +169,17 @@ namespace dual::nds {
       { { 8 , 8  }, { 8 , 8  }, { 8 , 8  }, { 8 , 8  } }  // Prohibited
     };
 
-    const auto& mmio = m_mmio_copy[vcount];
+    auto& sprites = context.sprite_list[m_id];
 
-    s16 transform[4];
+    if(sprites.oam_version == m_oam_version) {
+      return sprites;
+    }
 
-    int tile_num;
-    u16 pixel;
+    sprites.oam_version = m_oam_version;
 
-    m_line_contains_alpha_obj = false;
+    std::fill(std::begin(sprites.line_count), std::end(sprites.line_count), 0);
 
-    for(auto& point : m_buffer_obj) {
-      point.priority = 4;
-      point.color = k_color_transparent;
-      point.alpha = 0;
-      point.window = 0;
-    }
+    int i = 0;
 
     for(s32 offset = 0; offset <= 127 * 8; offset += 8) {
       // Check if OBJ is disabled (affine=0, attr0bit9=1)
@@ -37,16 +191,10 @@ namespace dual::nds {
       const u16 attr1 = atom::read<u16>(m_render_oam, offset + 2);
       const u16 attr2 = atom::read<u16>(m_render_oam, offset + 4);
 
-      int width;
-      int height;
-
       s32 x = attr1 & 0x1FF;
       s32 y = attr0 & 0x0FF;
-      int shape  =  attr0 >> 14;
-      int size   =  attr1 >> 14;
-      int prio   = (attr2 >> 10) & 3;
-      int mode   = (attr0 >> 10) & 3;
-      int mosaic = (attr0 >> 12) & 1;
+      int shape = attr0 >> 14;
+      int size  = attr1 >> 14;
 
       if(x >= 256) x -= 512;
       if(y >= 192) y -= 256;
@@ -55,8 +203,8 @@ namespace dual::nds {
       int attr0b9 = (attr0 >> 9) & 1;
 
       // Decode OBJ width and height.
-      width  = k_obj_size[shape][size][0];
-      height = k_obj_size[shape][size][1];
+      int width  = k_obj_size[shape][size][0];
+      int height = k_obj_size[shape][size][1];
 
       int half_width  = width / 2;
       int half_height = height / 2;
@@ -65,6 +213,8 @@ namespace dual::nds {
       x += half_width;
       y += half_height;
 
+      s16* transform = sprites.transform[i];
+
       // Load transform matrix.
       if(affine) {
         int group = ((attr1 >> 9) & 0x1F) << 5;
@@ -93,107 +243,89 @@ namespace dual::nds {
         transform[3] = 0x100;
       }
 
-      // Bail out if scanline is outside OBJ's view rectangle.
-      if(vcount < (y - half_height) || vcount >= (y + half_height)) {
-        continue;
-      }
+      sprites.x[i] = (s16)x;
+      sprites.y[i] = (s16)y;
+      sprites.width[i]  = (u8)width;
+      sprites.height[i] = (u8)height;
+      sprites.half_width[i]  = (u8)half_width;
+      sprites.half_height[i] = (u8)half_height;
+      sprites.mode[i] = (u8)((attr0 >> 10) & 3);
+      sprites.priority[i] = (u8)((attr2 >> 10) & 3);
+      sprites.palette[i] = (u8)((attr2 >> 12) + 16);
+      sprites.number[i] = attr2 & 0x3FF;
 
-      s16 local_y = (s16)(vcount - y);
-      int number  =  attr2 & 0x3FF;
-      int palette = (attr2 >> 12) + 16;
-      int flip_h  = !affine && (attr1 & (1 << 12));
-      int flip_v  = !affine && (attr1 & (1 << 13));
-      int is_256  = (attr0 >> 13) & 1;
+      u8 flags = 0;
 
-      int mosaic_x = 0;
+      if(affine) flags |= SPRITE_AFFINE;
+      if(!affine && (attr1 & (1 << 12))) flags |= SPRITE_FLIP_H;
+      if(!affine && (attr1 & (1 << 13))) flags |= SPRITE_FLIP_V;
+      if(attr0 & (1 << 13)) flags |= SPRITE_256;
+      if(attr0 & (1 << 12)) flags |= SPRITE_MOSAIC;
 
-      if(mosaic) {
-        mosaic_x = (x - half_width) % mmio.mosaic.obj.size_x;
-        local_y = (s16)(local_y - mmio.mosaic.obj.counter_y);
-      }
+      sprites.flags[i] = flags;
 
-      // Render OBJ scanline.
-      for(int local_x = -half_width; local_x <= half_width; local_x++) {
-        int _local_x = local_x - mosaic_x;
-        int global_x = local_x + x;
+      // Add the OBJ to the buckets of the scanlines which intersect its view rectangle.
+      const int line_max = std::min(y + half_height, 192);
 
-        if(mosaic && (++mosaic_x == mmio.mosaic.obj.size_x)) {
-          mosaic_x = 0;
-        }
-
-        if(global_x < 0 || global_x >= 256) {
-          continue;
-        }
+      for(int line = std::max(y - half_height, 0); line < line_max; line++) {
+        sprites.line_sprites[line][sprites.line_count[line]++] = (u8)i;
+      }
 
-        int tex_x = ((transform[0] * _local_x + transform[1] * local_y) >> 8) + (width / 2);
-        int tex_y = ((transform[2] * _local_x + transform[3] * local_y) >> 8) + (height / 2);
+      i++;
+    }
 
-        // Check if transformed coordinates are inside bounds.
-        if(tex_x >= width || tex_y >= height ||
-          tex_x < 0 || tex_y < 0) {
-          continue;
-        }
+    return sprites;
+  }
 
-        if(flip_h) tex_x = width  - tex_x - 1;
-        if(flip_v) tex_y = height - tex_y - 1;
+  u16 PPU::FetchSpritePixel(const MMIO& mmio, const SpriteList& sprites, int i, int tex_x, int tex_y) {
+    const int width  = sprites.width[i];
+    const int number = sprites.number[i];
 
-        int tile_x  = tex_x % 8;
-        int tile_y  = tex_y % 8;
-        int block_x = tex_x / 8;
-        int block_y = tex_y / 8;
+    int tile_x  = tex_x % 8;
+    int tile_y  = tex_y % 8;
+    int block_x = tex_x / 8;
+    int block_y = tex_y / 8;
 
-        if(mode == OBJ_BITMAP) {
-          // @todo: Attr 2, Bit 12-15 is used as Alpha-OAM value (instead of as palette setting).
-          if(mmio.dispcnt.bitmap_obj_mapping == DisplayControl::Mapping::OneDimensional) {
-            pixel = atom::read<u16>(m_render_vram_obj, (number * (64 << mmio.dispcnt.bitmap_obj_boundary) + tex_y * width + tex_x) * 2);
-          } else {
-            auto dimension = mmio.dispcnt.bitmap_obj_dimension;
-            auto mask = (16 << dimension) - 1;
+    int tile_num;
+    u16 pixel;
 
-            pixel = atom::read<u16>(m_render_vram_obj, ((number & ~mask) * 64 + (number & mask) * 8 + tex_y * (128 << dimension) + tex_x) * 2);
-          }
+    if(sprites.mode[i] == OBJ_BITMAP) {
+      // @todo: Attr 2, Bit 12-15 is used as Alpha-OAM value (instead of as palette setting).
+      if(mmio.dispcnt.bitmap_obj_mapping == DisplayControl::Mapping::OneDimensional) {
+        pixel = atom::read<u16>(m_render_vram_obj, (number * (64 << mmio.dispcnt.bitmap_obj_boundary) + tex_y * width + tex_x) * 2);
+      } else {
+        auto dimension = mmio.dispcnt.bitmap_obj_dimension;
+        auto mask = (16 << dimension) - 1;
 
-          if((pixel & 0x8000) == 0) {
-            pixel = k_color_transparent;
-          }
-        } else if(is_256) {
-          if(mmio.dispcnt.tile_obj_mapping == DisplayControl::Mapping::OneDimensional) {
-            tile_num = (number << mmio.dispcnt.tile_obj_boundary) + block_y * (width / 4);
-          } else {
-            tile_num = (number & ~1) + block_y * 32;
-          }
+        pixel = atom::read<u16>(m_render_vram_obj, ((number & ~mask) * 64 + (number & mask) * 8 + tex_y * (128 << dimension) + tex_x) * 2);
+      }
 
-          tile_num += block_x * 2;
+      if((pixel & 0x8000) == 0) {
+        pixel = k_color_transparent;
+      }
+    } else if(sprites.flags[i] & SPRITE_256) {
+      if(mmio.dispcnt.tile_obj_mapping == DisplayControl::Mapping::OneDimensional) {
+        tile_num = (number << mmio.dispcnt.tile_obj_boundary) + block_y * (width / 4);
+      } else {
+        tile_num = (number & ~1) + block_y * 32;
+      }
 
-          pixel = DecodeTilePixel8BPP_OBJ(tile_num * 32, palette, tile_x, tile_y);
-        } else {
-          if(mmio.dispcnt.tile_obj_mapping == DisplayControl::Mapping::OneDimensional) {
-            tile_num = (number << mmio.dispcnt.tile_obj_boundary) + block_y * (width / 8);
-          } else {
-            tile_num = number + block_y * 32;
-          }
+      tile_num += block_x * 2;
 
-          tile_num += block_x;
+      pixel = DecodeTilePixel8BPP_OBJ(tile_num * 32, mmio.dispcnt.enable_extpal_obj, sprites.palette[i], tile_x, tile_y);
+    } else {
+      if(mmio.dispcnt.tile_obj_mapping == DisplayControl::Mapping::OneDimensional) {
+        tile_num = (number << mmio.dispcnt.tile_obj_boundary) + block_y * (width / 8);
+      } else {
+        tile_num = number + block_y * 32;
+      }
 
-          pixel = DecodeTilePixel4BPP_OBJ(tile_num * 32, palette, tile_x, tile_y);
-        }
+      tile_num += block_x;
 
-        auto& point = m_buffer_obj[global_x];
-
-        if(pixel != k_color_transparent) {
-          if(mode == OBJ_WINDOW) {
-            point.window = 1;
-          } else if(prio < point.priority) {
-            point.priority = prio;
-            point.color = pixel;
-            point.alpha = (mode == OBJ_SEMI) ? 1 : 0;
-            if(point.alpha) {
-              m_line_contains_alpha_obj = true;
-            }
-          }
-        }
-      }
+      pixel = DecodeTilePixel4BPP_OBJ(tile_num * 32, sprites.palette[i], tile_x, tile_y);
     }
+
+    return pixel;
   }
 
 } // namespace dual::nds
@@ -3,7 +3,7 @@
 
 namespace dual::nds {
 
-  void PPU::RenderLayerText(uint id, u16 vcount) {
+  void PPU::RenderLayerText(RenderContext& context, uint id, u16 vcount) {
     const auto& mmio = m_mmio_copy[vcount];
     const auto& bgcnt = mmio.bgcnt[id];
     const auto& mosaic = mmio.mosaic.bg;
@@ -27,10 +27,10 @@ namespace dual::nds {
     int screen_x = (grid_x / 32) % 2;
     int screen_y = (grid_y / 32) % 2;
 
-    u16 tile[8];
+    const u16* tile = nullptr;
     u32 base = mmio.dispcnt.map_block * 65536 + bgcnt.map_block * 2048 + (grid_y % 32) * 64;
 
-    u16* buffer = m_buffer_bg[id];
+    u16* buffer = context.buffer_bg[id];
     s32  last_encoder = -1;
     u16  encoder;
 
@@ -64,7 +64,6 @@ namespace dual::nds {
       do {
         encoder = atom::read<u16>(m_render_vram_bg, base + grid_x++ * 2);
 
-        // @todo: speed tile decoding itself up.
         if(encoder != last_encoder) {
           int number  = encoder & 0x3FF;
           int palette = encoder >> 12;
@@ -72,18 +71,14 @@ namespace dual::nds {
           bool flip_y = encoder & (1 << 11);
           int _tile_y = flip_y ? (tile_y ^ 7) : tile_y;
 
-          if(!bgcnt.full_palette) {
-            DecodeTileLine4BPP(tile, tile_base, palette, number, _tile_y, flip_x);
-          } else {
-            DecodeTileLine8BPP(tile, tile_base, palette, expal_slot, number, _tile_y, flip_x);
-          }
+          tile = FetchTileLine(context, tile_base, bgcnt.full_palette, mmio.dispcnt.enable_extpal_bg, palette, expal_slot, number, _tile_y, flip_x);
 
           last_encoder = encoder;
         }
 
         if(draw_x >= 0 && draw_x <= 248) {
-          for(u16 pixel : tile) {
-            buffer[draw_x++] = pixel;
+          for(int x = 0; x < 8; x++) {
+            buffer[draw_x++] = tile[x];
           }
         } else {
           int x = 0;
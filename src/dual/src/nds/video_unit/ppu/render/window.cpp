@@ -3,33 +3,23 @@
 
 namespace dual::nds {
 
-  void PPU::RenderWindow(uint id, u8 vcount) {
-    auto& mmio = m_mmio_copy[vcount];
-    auto& winv = mmio.winv[id];
-    auto& winh = mmio.winh[id];
+  void PPU::RenderWindow(RenderContext& context, uint id, u8 vcount) {
+    const auto& mmio = m_mmio_copy[vcount];
+    const auto& winh = mmio.winh[id];
 
-    if(vcount == winv.min) {
-      m_window_scanline_enable[id] = true;
-    }
-
-    if(vcount == winv.max) {
-      m_window_scanline_enable[id] = false;
-    }
-
-    if(m_window_scanline_enable[id] && winh.changed) {
+    // The vertical range is tracked by SubmitScanline(), since it depends on the previous scanlines.
+    if(mmio.window_scanline_enable[id]) {
       // @todo: X1=00h is treated as 0 (left-most), X2=00h is treated as 100h (right-most).
       // However, the window is not displayed if X1=X2=00h
       if(winh.min <= winh.max) {
         for(int x = 0; x < 256; x++) {
-          m_buffer_win[id][x] = x >= winh.min && x < winh.max;
+          context.buffer_win[id][x] = x >= winh.min && x < winh.max;
         }
       } else {
         for(int x = 0; x < 256; x++) {
-          m_buffer_win[id][x] = x >= winh.min || x < winh.max;
+          context.buffer_win[id][x] = x >= winh.min || x < winh.max;
         }
       }
-
-      winh.changed = false;
     }
   }
 
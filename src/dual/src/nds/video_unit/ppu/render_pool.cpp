@@ -0,0 +1,57 @@
+
+#include <dual/nds/video_unit/ppu/ppu.hpp>
+#include <dual/nds/video_unit/ppu/render_pool.hpp>
+#include <memory>
+
+namespace dual::nds {
+
+  RenderPool::RenderPool(int thread_count) {
+    for(int i = 0; i < thread_count; i++) {
+      m_threads.emplace_back([this]() {
+        ThreadMain();
+      });
+    }
+  }
+
+  RenderPool::~RenderPool() {
+    m_mutex.lock();
+    m_quit = true;
+    m_cv.notify_all();
+    m_mutex.unlock();
+
+    for(auto& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  void RenderPool::Submit(PPU& ppu, int vcount_lo, int vcount_hi) {
+    m_mutex.lock();
+    m_bands[m_head++ % k_capacity] = {&ppu, vcount_lo, vcount_hi};
+    m_mutex.unlock();
+
+    m_cv.notify_one();
+  }
+
+  void RenderPool::ThreadMain() {
+    const auto context = std::make_unique<PPU::RenderContext>();
+
+    while(true) {
+      Band band;
+
+      {
+        std::unique_lock lock{m_mutex};
+        m_cv.wait(lock, [this]() {return m_head != m_tail || m_quit;});
+
+        // Bands which have been queued already are still rendered when the pool is destroyed.
+        if(m_head == m_tail) {
+          return;
+        }
+
+        band = m_bands[m_tail++ % k_capacity];
+      }
+
+      band.ppu->RenderBand(*context, band.vcount_lo, band.vcount_hi);
+    }
+  }
+
+} // namespace dual::nds
@@ -18,6 +18,9 @@ namespace dual::nds {
       , m_dma7{dma7} {
     m_irq[(int)CPU::ARM9] = &irq9;
     m_irq[(int)CPU::ARM7] = &irq7;
+
+    m_event_class_hdraw = scheduler.Register<&VideoUnit::BeginHDraw>(this);
+    m_event_class_hblank = scheduler.Register<&VideoUnit::BeginHBlank>(this);
   }
 
   void VideoUnit::Reset() {
@@ -31,6 +34,50 @@ namespace dual::nds {
     BeginHDraw(0);
   }
 
+  void VideoUnit::SaveState(StateWriter& state) {
+    for(const auto& dispstat : m_dispstat) state.Write(dispstat.half);
+    state.Write(m_vcount);
+
+    m_gpu.SaveState(state);
+    for(auto& ppu : m_ppu) ppu.SaveState(state);
+  }
+
+  void VideoUnit::LoadState(StateReader& state) {
+    for(auto& dispstat : m_dispstat) state.Read(dispstat.half);
+    state.Read(m_vcount);
+
+    m_gpu.LoadState(state);
+    for(auto& ppu : m_ppu) ppu.LoadState(state);
+  }
+
+  void VideoUnit::SaveSnapshot(StateWriter& state) {
+    for(const auto& dispstat : m_dispstat) state.Write(dispstat.half);
+    state.Write(m_vcount);
+
+    m_gpu.SaveState(state);
+    for(auto& ppu : m_ppu) ppu.SaveSnapshot(state);
+  }
+
+  void VideoUnit::LoadSnapshot(StateReader& state) {
+    for(auto& dispstat : m_dispstat) state.Read(dispstat.half);
+    state.Read(m_vcount);
+
+    m_gpu.LoadState(state);
+    for(auto& ppu : m_ppu) ppu.LoadSnapshot(state);
+  }
+
+  void VideoUnit::SetRenderThreadCount(int thread_count) {
+    for(auto& ppu : m_ppu) ppu.SetRenderPool(nullptr);
+
+    m_render_pool.reset();
+
+    if(thread_count > 0) {
+      m_render_pool = std::make_unique<RenderPool>(thread_count);
+
+      for(auto& ppu : m_ppu) ppu.SetRenderPool(m_render_pool.get());
+    }
+  }
+
   void VideoUnit::UpdateVerticalCounterMatchFlag(CPU cpu) {
     auto& dispstat = m_dispstat[(int)cpu];
 
@@ -47,11 +94,9 @@ namespace dual::nds {
     if(++m_vcount == k_total_lines) {
       for(auto& ppu : m_ppu) ppu.WaitForRenderWorker();
 
-      for(auto& ppu : m_ppu) ppu.SwapBuffers();
+      m_rendering_frame = m_enable_rendering;
 
-      if(m_present_callback) [[likely]] {
-        m_present_callback(m_ppu[0].GetFrameBuffer(), m_ppu[1].GetFrameBuffer());
-      }
+      for(auto& ppu : m_ppu) ppu.SetEnableRendering(m_rendering_frame);
 
       m_vcount = 0u;
     }
@@ -69,6 +114,17 @@ namespace dual::nds {
       m_ppu[0].OnBlankScanlineBegin(m_vcount);
       m_ppu[1].OnBlankScanlineBegin(m_vcount);
 
+      if(m_vcount == k_drawing_lines && m_rendering_frame) {
+        // Present the frame as soon as its last scanline has been rendered.
+        for(auto& ppu : m_ppu) ppu.WaitForRenderWorker();
+
+        if(m_present_callback) [[likely]] {
+          m_present_callback(m_ppu[0].GetFrameBuffer(), m_ppu[1].GetFrameBuffer());
+        }
+
+        for(auto& ppu : m_ppu) ppu.SwapBuffers();
+      }
+
       if(m_vcount == k_drawing_lines) {
         for(auto cpu : {CPU::ARM9, CPU::ARM7}) {
           auto& dispstat = m_dispstat[(int)cpu];
@@ -93,7 +149,7 @@ namespace dual::nds {
     m_dispstat[(int)CPU::ARM9].hblank_flag = false;
     m_dispstat[(int)CPU::ARM7].hblank_flag = false;
 
-    m_scheduler.Add(1606 - late, this, &VideoUnit::BeginHBlank);
+    m_scheduler.Add(1606 - late, m_event_class_hblank);
   }
 
   void VideoUnit::BeginHBlank(int late) {
@@ -113,7 +169,7 @@ namespace dual::nds {
       m_dma9.Request(arm9::DMA::StartTime::HBlank);
     }
 
-    m_scheduler.Add(524 - late, this, &VideoUnit::BeginHDraw);
+    m_scheduler.Add(524 - late, m_event_class_hdraw);
   }
 
   u16 VideoUnit::Read_DISPSTAT(CPU cpu) {
@@ -18,6 +18,41 @@ namespace dual::nds {
     for(auto bank : {0, 1, 2, 3, 4, 5, 6, 7, 8}) Write_VRAMCNT((Bank)bank, 0u);
   }
 
+  void VRAM::SaveState(StateWriter& state) const {
+    state.Write(bank_a);
+    state.Write(bank_b);
+    state.Write(bank_c);
+    state.Write(bank_d);
+    state.Write(bank_e);
+    state.Write(bank_f);
+    state.Write(bank_g);
+    state.Write(bank_h);
+    state.Write(bank_i);
+
+    for(const auto& vramcnt : m_vramcnt) state.Write(vramcnt.byte);
+  }
+
+  void VRAM::LoadState(StateReader& state) {
+    state.Read(bank_a);
+    state.Read(bank_b);
+    state.Read(bank_c);
+    state.Read(bank_d);
+    state.Read(bank_e);
+    state.Read(bank_f);
+    state.Read(bank_g);
+    state.Read(bank_h);
+    state.Read(bank_i);
+
+    // Only remap the banks whose mapping has changed.
+    for(int bank = 0; bank < 9; bank++) {
+      const u8 vramcnt = state.Read<u8>();
+
+      if(vramcnt != m_vramcnt[bank].byte) {
+        Write_VRAMCNT((Bank)bank, vramcnt);
+      }
+    }
+  }
+
   u8 VRAM::Read_VRAMSTAT() {
     const auto& vramcnt_c = m_vramcnt[(int)Bank::C];
     const auto& vramcnt_d = m_vramcnt[(int)Bank::D];
@@ -0,0 +1,378 @@
+#include <array>
+#include <atom/logger/logger.hpp>
+#include <atom/panic.hpp>
+#include <chrono>
+#include <cstring>
+#include <dual/common/scheduler.hpp>
+#include <dual/nds/header.hpp>
+#include <dual/nds/nds.hpp>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "benchmark.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Number of system cycles per video frame
+static constexpr int k_cycles_per_frame = 560190;
+
+/**
+ * The ARM9 runs an ARM loop from main memory and the ARM7 runs a Thumb loop from its WRAM.
+ * Both loops mix data processing, shifts and memory accesses and store to memory,
+ * so that they are neither compiled to data processing only nor skipped as idle loops.
+ */
+static const u32 k_arm9_program[] {
+  0xE3A03621, //   mov r3, #0x02100000
+  0xE2800001, // loop:
+              //   add r0, r0, #1
+  0xE0211000, //   eor r1, r1, r0
+  0xE5932000, //   ldr r2, [r3]
+  0xE0822001, //   add r2, r2, r1
+  0xE5832000, //   str r2, [r3]
+  0xE1A011E1, //   mov r1, r1, ror #3
+  0xEAFFFFF8  //   b loop
+};
+
+static const u16 k_arm7_program[] {
+  0x0001, 0xE28F, //   add r0, pc, #1
+  0xFF10, 0xE12F, //   bx r0
+  0x2307,         //   mov r3, #7
+  0x05DB,         //   lsl r3, r3, #23
+  0x2480,         //   mov r4, #0x80
+  0x0224,         //   lsl r4, r4, #8
+  0x191B,         //   add r3, r3, r4 (r3 = 0x03808000)
+  0x3001,         // loop:
+                  //   add r0, #1
+  0x4041,         //   eor r1, r0
+  0x681A,         //   ldr r2, [r3]
+  0x1852,         //   add r2, r2, r1
+  0x601A,         //   str r2, [r3]
+  0x41C1,         //   ror r1, r0
+  0xE7F8          //   b loop
+};
+
+static std::shared_ptr<dual::nds::ROM> CreateBenchmarkROM() {
+  static constexpr u32 k_arm9_offset = 0x200u;
+  static constexpr u32 k_arm7_offset = 0x240u;
+
+  static constexpr u32 k_arm7_size = (sizeof(k_arm7_program) + 3u) & ~3u;
+
+  const size_t size = k_arm7_offset + k_arm7_size;
+
+  dual::nds::Header header{};
+
+  std::memcpy(header.game_title, "BENCHMARK", 9);
+  std::memcpy(header.game_code, "BNCH", 4);
+
+  header.arm9 = {k_arm9_offset, 0x02000000u, 0x02000000u, sizeof(k_arm9_program)};
+  header.arm7 = {k_arm7_offset, 0x03800000u, 0x03800000u, k_arm7_size};
+
+  // MemoryROM takes ownership of the buffer.
+  u8* buffer = new u8[size]{};
+
+  std::memcpy(buffer, &header, sizeof(header));
+  std::memcpy(&buffer[k_arm9_offset], k_arm9_program, sizeof(k_arm9_program));
+  std::memcpy(&buffer[k_arm7_offset], k_arm7_program, sizeof(k_arm7_program));
+
+  return std::make_shared<dual::nds::MemoryROM>(buffer, size);
+}
+
+/**
+ * Measures the cost of executing instructions through the interpreter handlers for each CPU backend.
+ * Build with and without DUAL_ARM_STATIC_DISPATCH to compare the handler dispatch methods.
+ */
+static void RunDispatchBenchmark(int frames) {
+  static constexpr std::pair<dual::arm::CPU::Backend, const char*> k_backends[] {
+    {dual::arm::CPU::Backend::Interpreter, "interpreter"},
+    {dual::arm::CPU::Backend::CachedInterpreter, "cached"},
+    {dual::arm::CPU::Backend::JIT, "jit"}
+  };
+
+#ifdef DUAL_ARM_STATIC_DISPATCH
+  fmt::print("handler dispatch: static function pointers\n");
+#else
+  fmt::print("handler dispatch: pointers to member functions\n");
+#endif
+
+  for(const auto& [backend, name] : k_backends) {
+    auto nds = std::make_unique<dual::nds::NDS>(backend);
+
+    nds->LoadROM(CreateBenchmarkROM());
+    nds->DirectBoot();
+
+    const auto time_start = Clock::now();
+
+    for(int frame = 0; frame < frames; frame++) {
+      nds->Step(k_cycles_per_frame);
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - time_start).count();
+    const dual::nds::NDS::Stats stats = nds->GetStats();
+    const u64 instructions = stats.arm9_instructions + stats.arm7_instructions;
+
+    fmt::print(
+      "{:<12} {:8.2f} MIPS, {:6.2f} ns per instruction\n",
+      name, (double)instructions / seconds / 1e6, seconds * 1e9 / (double)instructions
+    );
+  }
+}
+
+/**
+ * The event queue the scheduler has been replaced with, kept as a reference for the scheduler benchmark:
+ * a binary heap of at most 64 events, each of which stores its callback in a std::function.
+ */
+class ReferenceScheduler {
+  public:
+    ReferenceScheduler() {
+      for(int i = 0; i < k_event_limit; i++) {
+        m_heap[i] = &m_pool[i];
+        m_heap[i]->handle = i;
+      }
+
+      Add(std::numeric_limits<u64>::max(), [](int) {
+        ATOM_PANIC("reached end of the event queue.");
+      });
+    }
+
+    struct Event {
+      std::function<void(int)> callback;
+      int handle{};
+      u64 timestamp{};
+    };
+
+    u64 GetTimestampNow() const {
+      return m_timestamp_now;
+    }
+
+    int GetRemainingCycleCount() const {
+      return int(m_heap[0]->timestamp - GetTimestampNow());
+    }
+
+    void AddCycles(int cycles) {
+      m_timestamp_now += cycles;
+      Step();
+    }
+
+    auto Add(u64 delay, std::function<void(int)> callback) -> Event* {
+      int n = m_heap_size++;
+      int p = Parent(n);
+
+      if(m_heap_size > k_event_limit) {
+        ATOM_PANIC("exceeded maximum number of scheduler events.");
+      }
+
+      auto event = m_heap[n];
+      event->timestamp = GetTimestampNow() + delay;
+      event->callback = callback;
+
+      while(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp) {
+        Swap(n, p);
+        n = p;
+        p = Parent(n);
+      }
+
+      return event;
+    }
+
+    void Cancel(Event* event) {
+      Remove(event->handle);
+    }
+
+  private:
+    static constexpr int k_event_limit = 64;
+
+    static int Parent(int n) {
+      return (n - 1) >> 1;
+    }
+
+    void Step() {
+      const u64 now = GetTimestampNow();
+
+      while(m_heap_size > 0 && m_heap[0]->timestamp <= now) {
+        auto event = m_heap[0];
+
+        event->callback(int(now - event->timestamp));
+
+        Remove(event->handle);
+      }
+    }
+
+    void Remove(int n) {
+      Swap(n, --m_heap_size);
+
+      int p = Parent(n);
+
+      if(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp) {
+        do {
+          Swap(n, p);
+          n = p;
+          p = Parent(n);
+        } while(n != 0 && m_heap[p]->timestamp > m_heap[n]->timestamp);
+      } else {
+        Heapify(n);
+      }
+    }
+
+    void Swap(int i, int j) {
+      std::swap(m_heap[i], m_heap[j]);
+      m_heap[i]->handle = i;
+      m_heap[j]->handle = j;
+    }
+
+    void Heapify(int n) {
+      const int l = n * 2 + 1;
+      const int r = n * 2 + 2;
+
+      if(l < m_heap_size && m_heap[l]->timestamp < m_heap[n]->timestamp) {
+        Swap(l, n);
+        Heapify(l);
+      }
+
+      if(r < m_heap_size && m_heap[r]->timestamp < m_heap[n]->timestamp) {
+        Swap(r, n);
+        Heapify(r);
+      }
+    }
+
+    u64 m_timestamp_now = 0u;
+    int m_heap_size = 0;
+    Event* m_heap[k_event_limit]{};
+    Event  m_pool[k_event_limit]{};
+};
+
+// Periodic events with different periods, similar to the APU channels, timers and video events.
+static constexpr int k_periodic_event_count = 24;
+
+static int GetEventPeriod(int id) {
+  return 64 + id * 37;
+}
+
+struct ReferenceSchedulerBenchmark {
+  ReferenceScheduler scheduler{};
+  u64 events_fired = 0u;
+
+  ReferenceSchedulerBenchmark() {
+    for(int id = 0; id < k_periodic_event_count; id++) {
+      Schedule(id, 0);
+    }
+  }
+
+  void Schedule(int id, int cycles_late) {
+    scheduler.Add(GetEventPeriod(id) - cycles_late, [this, id](int cycles_late) {
+      events_fired++;
+      Schedule(id, cycles_late);
+    });
+  }
+
+  void AddAndCancel(u64 delay) {
+    scheduler.Cancel(scheduler.Add(delay, [this](int) { events_fired++; }));
+  }
+};
+
+struct EventClassSchedulerBenchmark {
+  dual::Scheduler scheduler{};
+  dual::Scheduler::EventClass event_class{};
+  u64 events_fired = 0u;
+
+  EventClassSchedulerBenchmark() {
+    event_class = scheduler.Register<&EventClassSchedulerBenchmark::OnEvent>(this);
+
+    for(int id = 0; id < k_periodic_event_count; id++) {
+      scheduler.Add(GetEventPeriod(id), event_class, id);
+    }
+  }
+
+  void OnEvent(int id, int cycles_late) {
+    events_fired++;
+    scheduler.Add(GetEventPeriod(id) - cycles_late, event_class, id);
+  }
+
+  void AddAndCancel(u64 delay) {
+    scheduler.Cancel(scheduler.Add(delay, event_class, k_periodic_event_count));
+  }
+};
+
+// Queues the periodic events again with Scheduler::Reschedule() instead of adding a new event.
+struct InPlaceSchedulerBenchmark {
+  dual::Scheduler scheduler{};
+  dual::Scheduler::EventClass event_class{};
+  std::array<dual::Scheduler::Event*, k_periodic_event_count> events{};
+  u64 events_fired = 0u;
+
+  InPlaceSchedulerBenchmark() {
+    event_class = scheduler.Register<&InPlaceSchedulerBenchmark::OnEvent>(this);
+
+    for(int id = 0; id < k_periodic_event_count; id++) {
+      events[id] = scheduler.Add(GetEventPeriod(id), event_class, id);
+    }
+  }
+
+  void OnEvent(int id, int cycles_late) {
+    events_fired++;
+    scheduler.Reschedule(events[id], GetEventPeriod(id) - cycles_late);
+  }
+};
+
+// Returns the time in nanoseconds per fired event, which includes rescheduling it.
+template<typename Benchmark>
+static double MeasurePeriodicEvents(Benchmark& benchmark, int frames) {
+  const u64 timestamp_end = benchmark.scheduler.GetTimestampNow() + (u64)frames * k_cycles_per_frame;
+  const u64 events_fired_start = benchmark.events_fired;
+  const auto time_start = Clock::now();
+
+  while(benchmark.scheduler.GetTimestampNow() < timestamp_end) {
+    benchmark.scheduler.AddCycles(benchmark.scheduler.GetRemainingCycleCount());
+  }
+
+  const double seconds = std::chrono::duration<double>(Clock::now() - time_start).count();
+
+  return seconds * 1e9 / (double)(benchmark.events_fired - events_fired_start);
+}
+
+// Returns the time in nanoseconds to schedule and cancel an event while the periodic events are pending.
+template<typename Benchmark>
+static double MeasureAddCancel(Benchmark& benchmark, int frames) {
+  const int iterations = frames * 10000;
+  const auto time_start = Clock::now();
+
+  for(int i = 0; i < iterations; i++) {
+    benchmark.AddAndCancel((u64)(i & 1023));
+  }
+
+  const double seconds = std::chrono::duration<double>(Clock::now() - time_start).count();
+
+  return seconds * 1e9 / (double)iterations;
+}
+
+// Compares the scheduler to the event queue it replaced, under a load of periodic events.
+static void RunSchedulerBenchmark(int frames) {
+  auto reference = std::make_unique<ReferenceSchedulerBenchmark>();
+  auto scheduler = std::make_unique<EventClassSchedulerBenchmark>();
+  auto in_place = std::make_unique<InPlaceSchedulerBenchmark>();
+
+  fmt::print("{} periodic events, {} emulated frames\n", k_periodic_event_count, frames);
+  fmt::print(
+    "fire and reschedule: {:6.2f} ns (std::function heap), {:6.2f} ns (event classes), {:6.2f} ns (in-place)\n",
+    MeasurePeriodicEvents(*reference, frames), MeasurePeriodicEvents(*scheduler, frames), MeasurePeriodicEvents(*in_place, frames)
+  );
+  fmt::print(
+    "add and cancel:      {:6.2f} ns (std::function heap), {:6.2f} ns (event classes)\n",
+    MeasureAddCancel(*reference, frames), MeasureAddCancel(*scheduler, frames)
+  );
+}
+
+bool RunBenchmark(std::string_view name, int frames) {
+  if(name == "dispatch") {
+    RunDispatchBenchmark(frames);
+    return true;
+  }
+
+  if(name == "scheduler") {
+    RunSchedulerBenchmark(frames);
+    return true;
+  }
+
+  return false;
+}
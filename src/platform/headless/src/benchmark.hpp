@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string_view>
+
+/**
+ * Micro benchmarks which run on synthetic input, so that they neither need a ROM nor the boot ROMs.
+ * Returns false if there is no benchmark with the given name.
+ */
+bool RunBenchmark(std::string_view name, int frames);
@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <array>
+#include <atom/logger/logger.hpp>
+#include <atom/panic.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <dual/nds/movie.hpp>
+#include <dual/nds/nds.hpp>
+#include <dual/nds/rewind.hpp>
+#include <dual/nds/run_ahead.hpp>
+#include <fstream>
+#include <string_view>
+#include <vector>
+
+#include "benchmark.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+// Number of system cycles per video frame
+static constexpr int k_cycles_per_frame = 560190;
+static constexpr int k_default_frame_count = 600;
+
+struct Options {
+  const char* rom_path = nullptr;
+  const char* boot9_path = "boot9.bin";
+  const char* boot7_path = "boot7.bin";
+  const char* load_state_path = nullptr;
+  const char* save_state_path = nullptr;
+  const char* record_movie_path = nullptr;
+  const char* play_movie_path = nullptr;
+  const char* benchmark = nullptr;
+  dual::arm::CPU::Backend cpu_backend = dual::arm::CPU::Backend::Interpreter;
+  int frames = 0;
+  int rewind_interval = 0;
+  int run_ahead_frames = 0;
+  int ppu_threads = 0;
+  double seconds = 0.0;
+  bool arm7_thread = false;
+  bool verify_movie = false;
+  bool verify_simd = false;
+};
+
+static void PrintUsage(const char* program) {
+  fmt::print(
+    "usage: {} [options] <rom.nds>\n"
+    "       {} [--frames <n>] --bench <name>\n"
+    "  --frames <n>       run for n frames (default: {} unless --seconds is given)\n"
+    "  --seconds <s>      run for s seconds of wall time\n"
+    "  --cpu <backend>    interpreter, cached or jit (default: interpreter)\n"
+    "  --boot9 <path>     ARM9 boot ROM (default: boot9.bin)\n"
+    "  --boot7 <path>     ARM7 boot ROM (default: boot7.bin)\n"
+    "  --arm7-thread      run the ARM7 on a separate thread (experimental, not deterministic)\n"
+    "  --ppu-threads <n>  render the 2D scanlines in bands on a pool of n threads\n"
+    "  --load-state <path> load a save state before running\n"
+    "  --save-state <path> write a save state after running\n"
+    "  --rewind <n>       take a rewind snapshot every n frames and step back through all of them at the end\n"
+    "  --run-ahead <n>    run n frames ahead of each emulated frame\n"
+    "  --record-movie <path> record the input into a movie\n"
+    "  --play-movie <path> play back a movie (runs until its end unless --frames or --seconds is given)\n"
+    "  --verify           compare the hash of each frame to the movie that is being played back\n"
+    "  --verify-simd      compose and convert each scanline with both the SIMD and the scalar code and compare them\n"
+    "  --bench <name>     run a micro benchmark without a ROM:\n"
+    "                       dispatch: interpreter handler dispatch of each CPU backend\n"
+    "                       scheduler: event queue throughput compared to the previous std::function heap\n",
+    program, program, k_default_frame_count
+  );
+}
+
+static bool ParseArguments(int argc, char** argv, Options& options) {
+  for(int i = 1; i < argc; i++) {
+    const std::string_view argument = argv[i];
+
+    if(argument == "--arm7-thread") {
+      options.arm7_thread = true;
+      continue;
+    }
+
+    if(argument == "--verify") {
+      options.verify_movie = true;
+      continue;
+    }
+
+    if(argument == "--verify-simd") {
+      options.verify_simd = true;
+      continue;
+    }
+
+    if(!argument.starts_with("--")) {
+      if(options.rom_path) {
+        return false;
+      }
+      options.rom_path = argv[i];
+      continue;
+    }
+
+    if(i + 1 == argc) {
+      return false;
+    }
+
+    const char* value = argv[++i];
+
+    if(argument == "--frames") {
+      options.frames = std::atoi(value);
+    } else if(argument == "--seconds") {
+      options.seconds = std::atof(value);
+    } else if(argument == "--boot9") {
+      options.boot9_path = value;
+    } else if(argument == "--boot7") {
+      options.boot7_path = value;
+    } else if(argument == "--load-state") {
+      options.load_state_path = value;
+    } else if(argument == "--save-state") {
+      options.save_state_path = value;
+    } else if(argument == "--rewind") {
+      options.rewind_interval = std::atoi(value);
+    } else if(argument == "--record-movie") {
+      options.record_movie_path = value;
+    } else if(argument == "--play-movie") {
+      options.play_movie_path = value;
+    } else if(argument == "--run-ahead") {
+      options.run_ahead_frames = std::atoi(value);
+    } else if(argument == "--ppu-threads") {
+      options.ppu_threads = std::atoi(value);
+    } else if(argument == "--bench") {
+      options.benchmark = value;
+    } else if(argument == "--cpu") {
+      const std::string_view backend = value;
+
+      if(backend == "interpreter") {
+        options.cpu_backend = dual::arm::CPU::Backend::Interpreter;
+      } else if(backend == "cached") {
+        options.cpu_backend = dual::arm::CPU::Backend::CachedInterpreter;
+      } else if(backend == "jit") {
+        options.cpu_backend = dual::arm::CPU::Backend::JIT;
+      } else {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  if(options.frames <= 0 && options.seconds <= 0.0 && !options.play_movie_path) {
+    options.frames = k_default_frame_count;
+  }
+
+  // Movies emulate whole frames on their own and thus cannot be combined with run-ahead.
+  const bool movie = options.record_movie_path || options.play_movie_path;
+
+  if((movie && options.run_ahead_frames > 0) || (options.record_movie_path && options.play_movie_path)) {
+    return false;
+  }
+
+  // Running the ARM7 on its own thread is not deterministic, which movies, rewind and run-ahead depend on.
+  if(options.arm7_thread && (movie || options.rewind_interval > 0 || options.run_ahead_frames > 0)) {
+    return false;
+  }
+
+  return (options.rom_path != nullptr) != (options.benchmark != nullptr);
+}
+
+static std::vector<u8> LoadFile(const char* path) {
+  std::ifstream file{path, std::ios::binary};
+
+  if(!file.good()) {
+    ATOM_PANIC("Failed to open file: '{}'", path);
+  }
+
+  file.seekg(0, std::ios::end);
+  const size_t size = file.tellg();
+  file.seekg(0);
+
+  std::vector<u8> data(size);
+  file.read((char*)data.data(), static_cast<std::streamsize>(size));
+
+  if(!file.good()) {
+    ATOM_PANIC("Failed to read file: '{}'", path);
+  }
+
+  return data;
+}
+
+static void LoadBootROM(dual::nds::NDS& nds, const char* path, bool arm9) {
+  const size_t maximum_size = arm9 ? 0x8000 : 0x4000;
+
+  const std::vector<u8> data = LoadFile(path);
+
+  if(data.size() > maximum_size) {
+    ATOM_PANIC("Boot ROM is too big, expected {} bytes but got {} bytes", maximum_size, data.size());
+  }
+
+  std::array<u8, 0x8000> boot_rom{};
+
+  std::copy(data.begin(), data.end(), boot_rom.begin());
+
+  if(arm9) {
+    nds.LoadBootROM9(boot_rom);
+  } else {
+    nds.LoadBootROM7(std::span<u8, 0x4000>{boot_rom.data(), 0x4000});
+  }
+}
+
+static void LoadROM(dual::nds::NDS& nds, const char* path) {
+  const std::vector<u8> data = LoadFile(path);
+
+  // MemoryROM takes ownership of the buffer.
+  u8* buffer = new u8[data.size()];
+  std::copy(data.begin(), data.end(), buffer);
+
+  nds.LoadROM(std::make_shared<dual::nds::MemoryROM>(buffer, data.size()));
+  nds.DirectBoot();
+}
+
+static void WriteFile(const char* path, const std::vector<u8>& data) {
+  std::ofstream file{path, std::ios::binary};
+
+  file.write((const char*)data.data(), static_cast<std::streamsize>(data.size()));
+
+  if(!file.good()) {
+    ATOM_PANIC("Failed to write file: '{}'", path);
+  }
+}
+
+static double GetPercentile(const std::vector<double>& sorted_values, double percentile) {
+  const size_t index = std::min(sorted_values.size() - 1u, (size_t)(percentile * (double)sorted_values.size()));
+
+  return sorted_values[index];
+}
+
+int main(int argc, char** argv) {
+  atom::get_logger().SetLogMask(0);
+
+  Options options{};
+
+  if(!ParseArguments(argc, argv, options)) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if(options.benchmark) {
+    if(!RunBenchmark(options.benchmark, options.frames)) {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  auto nds = std::make_unique<dual::nds::NDS>(options.cpu_backend);
+
+  // ARM7 boot ROM must be loaded before the ROM when firmware booting.
+  LoadBootROM(*nds, options.boot9_path, true);
+  LoadBootROM(*nds, options.boot7_path, false);
+  LoadROM(*nds, options.rom_path);
+
+  if(options.load_state_path) {
+    const std::vector<u8> state = LoadFile(options.load_state_path);
+
+    const auto time_load_start = Clock::now();
+
+    if(!nds->LoadState(state)) {
+      ATOM_PANIC("Failed to load save state: '{}'", options.load_state_path);
+    }
+
+    fmt::print("state load time:  {:.3f} ms\n", std::chrono::duration<double, std::milli>(Clock::now() - time_load_start).count());
+  }
+
+  if(options.arm7_thread && !nds->SetARM7ThreadEnable(true)) {
+    ATOM_PANIC("Failed to run the ARM7 on its own thread");
+  }
+
+  if(options.ppu_threads > 0) {
+    nds->GetVideoUnit().SetRenderThreadCount(options.ppu_threads);
+  }
+
+  if(options.verify_simd) {
+    nds->GetVideoUnit().GetPPU(0).SetSIMDVerifyEnable(true);
+    nds->GetVideoUnit().GetPPU(1).SetSIMDVerifyEnable(true);
+  }
+
+  std::unique_ptr<dual::nds::Rewind> rewind{};
+
+  if(options.rewind_interval > 0) {
+    rewind = std::make_unique<dual::nds::Rewind>(*nds, dual::nds::Rewind::Config{.frames_per_snapshot = options.rewind_interval});
+  }
+
+  std::unique_ptr<dual::nds::RunAhead> run_ahead{};
+
+  if(options.run_ahead_frames > 0) {
+    run_ahead = std::make_unique<dual::nds::RunAhead>(*nds, options.run_ahead_frames);
+  }
+
+  std::unique_ptr<dual::nds::Movie> movie{};
+
+  if(options.record_movie_path || options.play_movie_path) {
+    movie = std::make_unique<dual::nds::Movie>(*nds);
+
+    if(options.record_movie_path) {
+      movie->StartRecording();
+    } else if(!movie->StartPlayback(LoadFile(options.play_movie_path), options.verify_movie)) {
+      ATOM_PANIC("Failed to load movie: '{}'", options.play_movie_path);
+    }
+  }
+
+  std::vector<double> frame_times{};
+  std::vector<double> rewind_capture_times{};
+  std::vector<double> snapshot_save_times{};
+  std::vector<double> snapshot_load_times{};
+
+  const auto time_start = Clock::now();
+  auto time_frame_start = time_start;
+
+  while(true) {
+    if(movie) {
+      if(!movie->RunFrame()) {
+        break;
+      }
+    } else if(run_ahead) {
+      run_ahead->RunFrame();
+
+      snapshot_save_times.push_back(run_ahead->GetStats().last_save_time);
+      snapshot_load_times.push_back(run_ahead->GetStats().last_load_time);
+    } else {
+      nds->Step(k_cycles_per_frame);
+    }
+
+    if(rewind && rewind->Update()) {
+      rewind_capture_times.push_back(rewind->GetStats().last_capture_time);
+    }
+
+    const auto time_frame_end = Clock::now();
+
+    frame_times.push_back(std::chrono::duration<double, std::milli>(time_frame_end - time_frame_start).count());
+    time_frame_start = time_frame_end;
+
+    if(options.frames > 0 && (int)frame_times.size() >= options.frames) {
+      break;
+    }
+
+    if(options.seconds > 0.0 && std::chrono::duration<double>(time_frame_end - time_start).count() >= options.seconds) {
+      break;
+    }
+  }
+
+  const double seconds = std::chrono::duration<double>(time_frame_start - time_start).count();
+  const size_t frames = frame_times.size();
+  const dual::nds::NDS::Stats stats = nds->GetStats();
+
+  nds->SetARM7ThreadEnable(false);
+
+  if(options.record_movie_path) {
+    std::vector<u8> data{};
+
+    movie->Save(data);
+    WriteFile(options.record_movie_path, data);
+  }
+
+  if(options.save_state_path) {
+    std::vector<u8> state{};
+
+    const auto time_save_start = Clock::now();
+
+    nds->SaveState(state);
+
+    fmt::print("state save time:  {:.3f} ms ({} bytes)\n", std::chrono::duration<double, std::milli>(Clock::now() - time_save_start).count(), state.size());
+
+    WriteFile(options.save_state_path, state);
+  }
+
+  fmt::print("frames:           {}\n", frames);
+
+  // Nothing has been emulated, e.g. when playing back an empty movie.
+  if(frames > 0) {
+    std::sort(frame_times.begin(), frame_times.end());
+
+    fmt::print("wall time:        {:.3f} s\n", seconds);
+    fmt::print("emulated fps:     {:.2f}\n", (double)frames / seconds);
+    fmt::print("ARM9:             {:.2f} MIPS ({} idle loop cycles skipped)\n", (double)stats.arm9_instructions / seconds / 1e6, stats.arm9_idle_loop_cycles);
+    fmt::print("ARM7:             {:.2f} MIPS ({} idle loop cycles skipped)\n", (double)stats.arm7_instructions / seconds / 1e6, stats.arm7_idle_loop_cycles);
+    fmt::print("scheduler events: {} ({:.1f} per frame)\n", stats.scheduler_events, (double)stats.scheduler_events / (double)frames);
+    fmt::print("CPU syncs:        {} ({:.1f} per frame)\n", stats.cpu_sync_count, (double)stats.cpu_sync_count / (double)frames);
+    fmt::print(
+      "PPU handoffs:     {} scanlines, {:.1f} worker wake-ups per frame\n",
+      stats.ppu_scanlines_submitted, (double)stats.ppu_worker_wakeups / (double)frames
+    );
+    fmt::print(
+      "PPU waits:        {:.1f} per frame, {:.3f} ms per frame\n",
+      (double)stats.ppu_wait_count / (double)frames, (double)stats.ppu_wait_time_ns / 1e6 / (double)frames
+    );
+    fmt::print(
+      "frame time:       p50 {:.3f} ms, p90 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms\n",
+      GetPercentile(frame_times, 0.5),
+      GetPercentile(frame_times, 0.9),
+      GetPercentile(frame_times, 0.99),
+      frame_times.back()
+    );
+  }
+
+  if(movie) {
+    const dual::nds::Movie::Stats movie_stats = movie->GetStats();
+
+    if(options.record_movie_path) {
+      fmt::print("movie:            {} frames recorded\n", movie_stats.frame);
+    } else if(!options.verify_movie) {
+      fmt::print("movie:            {} of {} frames played back\n", movie_stats.frame, movie_stats.frame_count);
+    } else if(movie_stats.hash_mismatches == 0) {
+      fmt::print("movie:            {} of {} frames played back, all frames match\n", movie_stats.frame, movie_stats.frame_count);
+    } else {
+      fmt::print(
+        "movie:            {} of {} frames played back, {} frames differ (first at frame {})\n",
+        movie_stats.frame, movie_stats.frame_count, movie_stats.hash_mismatches, movie_stats.first_mismatch_frame
+      );
+    }
+  }
+
+  if(run_ahead && frames > 0) {
+    std::sort(snapshot_save_times.begin(), snapshot_save_times.end());
+    std::sort(snapshot_load_times.begin(), snapshot_load_times.end());
+
+    fmt::print("snapshot save:    p50 {:.3f} ms, max {:.3f} ms\n", GetPercentile(snapshot_save_times, 0.5), snapshot_save_times.back());
+    fmt::print("snapshot load:    p50 {:.3f} ms, max {:.3f} ms\n", GetPercentile(snapshot_load_times, 0.5), snapshot_load_times.back());
+  }
+
+  if(rewind) {
+    const dual::nds::Rewind::Stats rewind_stats = rewind->GetStats();
+
+    std::sort(rewind_capture_times.begin(), rewind_capture_times.end());
+
+    fmt::print("rewind snapshots: {} ({:.1f} KiB per snapshot)\n", rewind_stats.snapshot_count, (double)rewind_stats.memory_used / 1024.0 / std::max(1, rewind_stats.snapshot_count - 1));
+
+    if(!rewind_capture_times.empty()) {
+      fmt::print("rewind capture:   p50 {:.3f} ms, max {:.3f} ms\n", GetPercentile(rewind_capture_times, 0.5), rewind_capture_times.back());
+    }
+
+    std::vector<double> restore_times{};
+
+    while(true) {
+      const auto time_restore_start = Clock::now();
+
+      if(!rewind->StepBack()) {
+        break;
+      }
+
+      restore_times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - time_restore_start).count());
+    }
+
+    if(!restore_times.empty()) {
+      std::sort(restore_times.begin(), restore_times.end());
+
+      fmt::print("rewind restore:   p50 {:.3f} ms, max {:.3f} ms\n", GetPercentile(restore_times, 0.5), restore_times.back());
+    }
+  }
+
+  u64 simd_mismatches = 0u;
+
+  if(options.verify_simd) {
+    simd_mismatches = nds->GetVideoUnit().GetPPU(0).GetSIMDMismatchCount() + nds->GetVideoUnit().GetPPU(1).GetSIMDMismatchCount();
+
+    if(simd_mismatches == 0u) {
+      fmt::print("SIMD verify:      all scanlines match the scalar code\n");
+    } else {
+      fmt::print("SIMD verify:      {} scanlines differ from the scalar code\n", simd_mismatches);
+    }
+  }
+
+  // Allows bisecting regressions with scripts.
+  if((movie && movie->GetStats().hash_mismatches > 0) || simd_mismatches > 0u) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -124,6 +124,24 @@ void Application::MainLoop() {
       if(event.type == SDL_QUIT) {
         return;
       }
+
+      if(event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F1 && !event.key.repeat) {
+        m_run_ahead_frames = (m_run_ahead_frames + 1) % 3;
+        m_emu_thread.SetRunAhead(m_run_ahead_frames);
+        fmt::print("Run-ahead: {} frame(s)\n", m_run_ahead_frames);
+      }
+
+      if(event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F5 && !event.key.repeat) {
+        m_nds = m_emu_thread.Stop();
+        if(m_movie) {
+          SaveMovie();
+        } else {
+          m_movie = std::make_unique<dual::nds::Movie>(*m_nds);
+          m_movie->StartRecording();
+          fmt::print("Recording movie...\n");
+        }
+        m_emu_thread.Start(std::move(m_nds), m_movie.get());
+      }
     }
 
     const auto frame = m_emu_thread.AcquireFrame();
@@ -140,18 +158,86 @@ void Application::MainLoop() {
       m_emu_thread.ReleaseFrame();
     }
 
+    UpdateInput();
+
     m_emu_thread.SetFastForward(SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_SPACE]);
+    m_emu_thread.SetRewind(SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_R]);
 
     if(SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_F11]) {
       m_nds = m_emu_thread.Stop();
+      if(m_movie) SaveMovie();
       m_nds->Reset();
       m_emu_thread.Start(std::move(m_nds));
     }
 
     if(SDL_GetKeyboardState(nullptr)[SDL_SCANCODE_F12]) {
       m_nds = m_emu_thread.Stop();
+      if(m_movie) SaveMovie();
       m_nds->DirectBoot();
       m_emu_thread.Start(std::move(m_nds));
     }
   }
 }
+
+void Application::SaveMovie() {
+  const char* path = "movie.dsm";
+
+  std::vector<u8> data{};
+  m_movie->Save(data);
+
+  std::ofstream file{path, std::ios::binary};
+
+  file.write((const char*)data.data(), static_cast<std::streamsize>(data.size()));
+
+  if(!file.good()) {
+    ATOM_PANIC("Failed to write movie: '{}'", path);
+  }
+
+  fmt::print("Recorded {} frames to '{}'\n", m_movie->GetStats().frame, path);
+
+  m_movie.reset();
+}
+
+void Application::UpdateInput() {
+  using Key = dual::nds::Input::Key;
+
+  static constexpr std::pair<SDL_Scancode, Key> k_key_map[] {
+    {SDL_SCANCODE_A, Key::A},
+    {SDL_SCANCODE_S, Key::B},
+    {SDL_SCANCODE_BACKSPACE, Key::Select},
+    {SDL_SCANCODE_RETURN, Key::Start},
+    {SDL_SCANCODE_RIGHT, Key::Right},
+    {SDL_SCANCODE_LEFT, Key::Left},
+    {SDL_SCANCODE_UP, Key::Up},
+    {SDL_SCANCODE_DOWN, Key::Down},
+    {SDL_SCANCODE_F, Key::R},
+    {SDL_SCANCODE_D, Key::L},
+    {SDL_SCANCODE_W, Key::X},
+    {SDL_SCANCODE_Q, Key::Y}
+  };
+
+  const u8* key_state = SDL_GetKeyboardState(nullptr);
+
+  u16 pressed_keys = 0u;
+
+  for(const auto& [scancode, key] : k_key_map) {
+    if(key_state[scancode]) pressed_keys |= key;
+  }
+
+  m_emu_thread.SetKeyState(pressed_keys);
+
+  // The bottom screen is drawn at (0, 384) with twice the native resolution.
+  int mouse_x;
+  int mouse_y;
+
+  const bool mouse_down = SDL_GetMouseState(&mouse_x, &mouse_y) & SDL_BUTTON(SDL_BUTTON_LEFT);
+  const int touch_x = mouse_x / 2;
+  const int touch_y = (mouse_y - 384) / 2;
+  const bool pen_down = mouse_down && touch_x >= 0 && touch_x < 256 && mouse_y >= 384 && touch_y < 192;
+
+  if(pen_down) {
+    m_emu_thread.SetTouchState(true, (u8)touch_x, (u8)touch_y);
+  } else {
+    m_emu_thread.SetTouchState(false, 0u, 0u);
+  }
+}
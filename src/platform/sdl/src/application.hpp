@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <dual/nds/movie.hpp>
 #include <dual/nds/nds.hpp>
 #include <memory>
 
@@ -20,11 +21,15 @@ class Application {
     void LoadROM(const char* path);
     void LoadBootROM(const char* path, bool arm9);
     void MainLoop();
+    void SaveMovie();
+    void UpdateInput();
 
     SDL_Window* m_window;
     SDL_Renderer* m_renderer;
     SDL_Texture* m_textures[2];
 
     std::unique_ptr<dual::nds::NDS> m_nds{};
+    std::unique_ptr<dual::nds::Movie> m_movie{};
     EmulatorThread m_emu_thread{};
+    int m_run_ahead_frames = 0;
 };
\ No newline at end of file
@@ -10,16 +10,18 @@ EmulatorThread::~EmulatorThread() {
   Stop();
 }
 
-void EmulatorThread::Start(std::unique_ptr<dual::nds::NDS> nds) {
+void EmulatorThread::Start(std::unique_ptr<dual::nds::NDS> nds, dual::nds::Movie* movie) {
   if(m_running) {
     ATOM_PANIC("Starting an already running emulator thread is illegal.");
   }
   m_nds = std::move(nds);
+  m_movie = movie;
   m_frame_mailbox.available[0] = false;
   m_frame_mailbox.available[1] = false;
   m_nds->GetVideoUnit().SetPresentationCallback([this](const u32* fb_top, const u32* fb_bottom) {
     PresentCallback(fb_top, fb_bottom);
   });
+  m_rewind = std::make_unique<dual::nds::Rewind>(*m_nds, dual::nds::Rewind::Config{});
   m_running = true;
   m_thread = std::thread{&EmulatorThread::ThreadMain, this};
 }
@@ -30,6 +32,8 @@ std::unique_ptr<dual::nds::NDS> EmulatorThread::Stop() {
   }
   m_running = false;
   m_thread.join();
+  m_run_ahead.reset();
+  m_rewind.reset();
   return std::move(m_nds);
 }
 
@@ -40,7 +44,34 @@ bool EmulatorThread::GetFastForward() const {
 void EmulatorThread::SetFastForward(bool fast_forward) {
   if(fast_forward != m_fast_forward) {
     m_fast_forward = fast_forward;
-    m_nds->GetAPU().SetEnableOutput(!fast_forward);
+    m_nds->GetAPU().SetEnableOutput(!fast_forward && !m_rewinding);
+  }
+}
+
+void EmulatorThread::SetRewind(bool rewind) {
+  if(rewind != m_rewinding) {
+    m_rewinding = rewind;
+    m_nds->GetAPU().SetEnableOutput(!rewind && !m_fast_forward);
+  }
+}
+
+void EmulatorThread::SetRunAhead(int frames) {
+  m_run_ahead_frames = frames;
+}
+
+void EmulatorThread::SetKeyState(u16 pressed_keys) {
+  if(m_movie) {
+    m_movie->SetKeyState(pressed_keys);
+  } else {
+    m_nds->SetKeyState(pressed_keys);
+  }
+}
+
+void EmulatorThread::SetTouchState(bool pen_down, u8 x, u8 y) {
+  if(m_movie) {
+    m_movie->SetTouchState(pen_down, x, y);
+  } else {
+    m_nds->SetTouchState(pen_down, x, y);
   }
 }
 
@@ -60,6 +91,24 @@ void EmulatorThread::ThreadMain() {
   const uint half_buffer_size = full_buffer_size >> 1;
 
   while(m_running) {
+    // Recording a movie requires emulating whole frames and does not allow going back in time.
+    const int run_ahead_frames = m_movie ? 0 : (int)m_run_ahead_frames;
+
+    if(run_ahead_frames == 0) {
+      m_run_ahead.reset();
+    } else if(!m_run_ahead || m_run_ahead->GetFrameCount() != run_ahead_frames) {
+      m_run_ahead = std::make_unique<dual::nds::RunAhead>(*m_nds, run_ahead_frames);
+    }
+
+    if(m_rewinding && !m_movie) {
+      // Restore the previous snapshot and run a single frame from it, so that there is something to present.
+      if(m_rewind->StepBack()) {
+        m_nds->Step(k_cycles_per_frame);
+      }
+      std::this_thread::sleep_for(16ms);
+      continue;
+    }
+
     if(!m_fast_forward) {
       uint current_buffer_size = audio_driver->GetNumberOfQueuedSamples();
 
@@ -76,10 +125,29 @@ void EmulatorThread::ThreadMain() {
 
       // Run the emulator for as many cycles as is needed to fully fill the queue.
       const int cycles = (int)(full_buffer_size - current_buffer_size) * 1024;
-      m_nds->Step(cycles);
+
+      if(m_movie) {
+        // Movies work with whole frames, so round up to the next frame.
+        for(int i = 0; i < cycles; i += k_cycles_per_frame) {
+          m_movie->RunFrame();
+        }
+      } else if(m_run_ahead) {
+        // Run-ahead works with whole frames, so round up to the next frame.
+        for(int i = 0; i < cycles; i += k_cycles_per_frame) {
+          m_run_ahead->RunFrame();
+        }
+      } else {
+        m_nds->Step(cycles);
+      }
+    } else if(m_movie) {
+      m_movie->RunFrame();
+    } else if(m_run_ahead) {
+      m_run_ahead->RunFrame();
     } else {
       m_nds->Step(k_cycles_per_frame);
     }
+
+    m_rewind->Update();
   }
 }
 
@@ -2,7 +2,10 @@
 #pragma once
 
 #include <atomic>
+#include <dual/nds/movie.hpp>
 #include <dual/nds/nds.hpp>
+#include <dual/nds/rewind.hpp>
+#include <dual/nds/run_ahead.hpp>
 #include <optional>
 #include <thread>
 
@@ -15,12 +18,21 @@ class EmulatorThread {
       return m_running;
     }
 
-    void Start(std::unique_ptr<dual::nds::NDS> nds);
+    // If a movie is given, the input is fed through it and the emulator runs in whole frames.
+    void Start(std::unique_ptr<dual::nds::NDS> nds, dual::nds::Movie* movie = nullptr);
     std::unique_ptr<dual::nds::NDS> Stop();
 
     [[nodiscard]] bool GetFastForward() const;
     void SetFastForward(bool fast_forward);
 
+    void SetRewind(bool rewind);
+
+    // Number of frames to emulate ahead of the presented frame, zero disables run-ahead.
+    void SetRunAhead(int frames);
+
+    void SetKeyState(u16 pressed_keys);
+    void SetTouchState(bool pen_down, u8 x, u8 y);
+
     std::optional<std::pair<const u32*, const u32*>> AcquireFrame();
     void ReleaseFrame();
 
@@ -29,9 +41,14 @@ class EmulatorThread {
     void PresentCallback(const u32* fb_top, const u32* fb_bottom);
 
     std::unique_ptr<dual::nds::NDS> m_nds{};
+    std::unique_ptr<dual::nds::Rewind> m_rewind{};
+    std::unique_ptr<dual::nds::RunAhead> m_run_ahead{};
+    dual::nds::Movie* m_movie{};
     std::thread m_thread{};
     std::atomic_bool m_running{};
     std::atomic_bool m_fast_forward{};
+    std::atomic_bool m_rewinding{};
+    std::atomic_int m_run_ahead_frames{};
 
     struct FrameMailbox {
       u32 frames[2][2][256 * 192];